@@ -2,8 +2,34 @@
 
 #include "Compiler/SimpleTemplateCompiler.h"
 
-void FTokenArray::Serialize(FArchive& Ar)
+namespace SimpleTemplateRenderContext
 {
+	// Render contexts of the current thread, one per level of nested renders
+	static thread_local TArray<TUniquePtr<FTemplateRenderContext>> Pool;
+	static thread_local int32 Depth = 0;
+}
+
+FScopedTemplateRenderContext::FScopedTemplateRenderContext()
+{
+	using namespace SimpleTemplateRenderContext;
+	if (Depth == Pool.Num())
+	{
+		TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Interpreter);
+		Pool.Add(MakeUnique<FTemplateRenderContext>());
+	}
+	RenderContext = Pool[Depth++].Get();
+}
+
+FScopedTemplateRenderContext::~FScopedTemplateRenderContext()
+{
+	RenderContext->Reset();
+	SimpleTemplateRenderContext::Depth--;
+}
+
+void FTokenArray::Serialize(FArchive& Ar, FTokenArena& InArena)
+{
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Tokens);
+
 	int32 NumTokens = Items.Num();
 	Ar << NumTokens;
 	if (Ar.IsLoading())
@@ -19,37 +45,73 @@ void FTokenArray::Serialize(FArchive& Ar)
 			switch (TokenType)
 			{
 			case ETokenType::Text:
-				token = new FTokenText();
+				token = InArena.New<FTokenText>();
 				break;
 			case ETokenType::Var:
-				token = new FTokenVar();
+				token = InArena.New<FTokenVar>();
 				break;
 			case ETokenType::If:
-				token = new FTokenIf();
+				token = InArena.New<FTokenIf>();
 				break;
 			case ETokenType::For:
-				token = new FTokenFor();
+				token = InArena.New<FTokenFor>();
 				break;
 			case ETokenType::EndIf:
-				token = new FTokenEndIf();
+				token = InArena.New<FTokenEndIf>();
 				break;
 			case ETokenType::EndFor:
-				token = new FTokenEndFor();
+				token = InArena.New<FTokenEndFor>();
 				break;
 			}
 
-			token->Serialize(Ar);
-			Items.Add(MakeShareable(token));
+			Ar << token->Line;
+			Ar << token->Column;
+			Ar << token->bIncluded;
+			token->Serialize(Ar, InArena);
+			Items.Add(token);
 		}
 	}
 	else
 	{
-		for (auto Token : Items)
+		for (FToken* Token : Items)
 		{
 			// Always add the type first
 			ETokenType serializedType = Token->GetType();
 			Ar << serializedType;
-			Token->Serialize(Ar);
+			Ar << Token->Line;
+			Ar << Token->Column;
+			Ar << Token->bIncluded;
+			Token->Serialize(Ar, InArena);
 		}
 	}
 }
+
+FTokenArena::~FTokenArena()
+{
+	for (int32 i = Tokens.Num() - 1; i >= 0; i--)
+	{
+		Tokens[i]->~FToken();
+	}
+	for (uint8* Chunk : Chunks)
+	{
+		FMemory::Free(Chunk);
+	}
+}
+
+void* FTokenArena::Allocate(SIZE_T Size, SIZE_T Alignment)
+{
+	uint8* Memory = Align(Cursor, Alignment);
+	if (Cursor == nullptr || Memory + Size > End)
+	{
+		// Chunks grow with the template, oversized requests get a chunk of their own size
+		const SIZE_T NewChunkSize = FMath::Max<SIZE_T>(ChunkSize, Size + Alignment);
+		uint8* Chunk = static_cast<uint8*>(FMemory::Malloc(NewChunkSize));
+		Chunks.Add(Chunk);
+		ChunkBytes += NewChunkSize;
+		End = Chunk + NewChunkSize;
+		ChunkSize = FMath::Min(ChunkSize * 2, TPL_ARENA_MAX_CHUNK);
+		Memory = Align(Chunk, Alignment);
+	}
+	Cursor = Memory + Size;
+	return Memory;
+}
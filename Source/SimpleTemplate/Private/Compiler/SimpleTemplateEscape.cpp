@@ -0,0 +1,171 @@
+// Copyright Playspace S.L. 2017
+
+#include "Compiler/SimpleTemplateEscape.h"
+#include "Serialization/Archive.h"
+
+namespace SimpleTemplateEscape
+{
+	// Only ASCII characters are ever escaped
+	static const int32 NumTableChars = 128;
+
+	/** Replacement of every special character of a mode, empty for clean characters */
+	struct FEscapeTable
+	{
+		FString Replacements[NumTableChars];
+	};
+
+	static FEscapeTable BuildMarkupTable(bool bXml)
+	{
+		FEscapeTable Table;
+		Table.Replacements['&'] = TEXT("&amp;");
+		Table.Replacements['<'] = TEXT("&lt;");
+		Table.Replacements['>'] = TEXT("&gt;");
+		Table.Replacements['"'] = TEXT("&quot;");
+		Table.Replacements['\''] = bXml ? TEXT("&apos;") : TEXT("&#39;");
+		return Table;
+	}
+
+	static FEscapeTable BuildJsonTable()
+	{
+		FEscapeTable Table;
+		for (int32 Char = 0; Char < 0x20; Char++)
+		{
+			Table.Replacements[Char] = FString::Printf(TEXT("\\u%04x"), Char);
+		}
+		Table.Replacements['\b'] = TEXT("\\b");
+		Table.Replacements['\f'] = TEXT("\\f");
+		Table.Replacements['\n'] = TEXT("\\n");
+		Table.Replacements['\r'] = TEXT("\\r");
+		Table.Replacements['\t'] = TEXT("\\t");
+		Table.Replacements['"'] = TEXT("\\\"");
+		Table.Replacements['\\'] = TEXT("\\\\");
+		return Table;
+	}
+
+	static const FEscapeTable& GetTable(ETemplateEscape Escape)
+	{
+		static const FEscapeTable HtmlTable = BuildMarkupTable(false);
+		static const FEscapeTable XmlTable = BuildMarkupTable(true);
+		static const FEscapeTable JsonTable = BuildJsonTable();
+		switch (Escape)
+		{
+		case ETemplateEscape::Xml:
+			return XmlTable;
+		case ETemplateEscape::Json:
+			return JsonTable;
+		default:
+			return HtmlTable;
+		}
+	}
+
+	static FORCEINLINE void WriteRun(FArchive& WriteStream, const TCHAR* Begin, const TCHAR* End)
+	{
+		if (End > Begin)
+		{
+			WriteStream.Serialize(const_cast<TCHAR*>(Begin), (End - Begin) * sizeof(TCHAR));
+		}
+	}
+
+	static FORCEINLINE bool IsCsvSpecial(TCHAR Char)
+	{
+		return Char == TCHAR(',') || Char == TCHAR('"') || Char == TCHAR('\n') || Char == TCHAR('\r');
+	}
+
+	/** CSV fields are quoted as a whole, quotes inside are doubled */
+	static void WriteCsv(FArchive& WriteStream, const TCHAR* Chars, int32 Len)
+	{
+		const TCHAR* End = Chars + Len;
+		const TCHAR* It = Chars;
+		while (It < End && !IsCsvSpecial(*It))
+		{
+			++It;
+		}
+		if (It == End)
+		{
+			WriteRun(WriteStream, Chars, End);
+			return;
+		}
+
+		TCHAR Quote = TCHAR('"');
+		WriteStream.Serialize(&Quote, sizeof(TCHAR));
+		const TCHAR* Run = Chars;
+		for (; It < End; ++It)
+		{
+			if (*It == Quote)
+			{
+				// Write the run including the quote, the quote starts the next run and is written twice
+				WriteRun(WriteStream, Run, It + 1);
+				Run = It;
+			}
+		}
+		WriteRun(WriteStream, Run, End);
+		WriteStream.Serialize(&Quote, sizeof(TCHAR));
+	}
+}
+
+
+/* FTemplateEscape interface
+ *****************************************************************************/
+
+void FTemplateEscape::Write(FArchive& WriteStream, const TCHAR* Chars, int32 Len, ETemplateEscape Escape)
+{
+	using namespace SimpleTemplateEscape;
+
+	if (Escape == ETemplateEscape::None)
+	{
+		WriteRun(WriteStream, Chars, Chars + Len);
+		return;
+	}
+	if (Escape == ETemplateEscape::Csv)
+	{
+		WriteCsv(WriteStream, Chars, Len);
+		return;
+	}
+
+	const FString* Replacements = GetTable(Escape).Replacements;
+	const TCHAR* End = Chars + Len;
+	const TCHAR* Run = Chars;
+	for (const TCHAR* It = Chars; It < End; ++It)
+	{
+		const uint32 Char = (uint32)*It;
+		if (Char < (uint32)NumTableChars && Replacements[Char].Len() > 0)
+		{
+			WriteRun(WriteStream, Run, It);
+			const FString& Replacement = Replacements[Char];
+			WriteStream.Serialize(const_cast<TCHAR*>(*Replacement), Replacement.Len() * sizeof(TCHAR));
+			Run = It + 1;
+		}
+	}
+	WriteRun(WriteStream, Run, End);
+}
+
+bool FTemplateEscape::Parse(const FString& Name, ETemplateEscape& OutEscape)
+{
+	static const ETemplateEscape Modes[] = { ETemplateEscape::None, ETemplateEscape::Html, ETemplateEscape::Json, ETemplateEscape::Csv, ETemplateEscape::Xml };
+	for (ETemplateEscape Mode : Modes)
+	{
+		if (Name.Equals(ToString(Mode), ESearchCase::IgnoreCase))
+		{
+			OutEscape = Mode;
+			return true;
+		}
+	}
+	return false;
+}
+
+const TCHAR* FTemplateEscape::ToString(ETemplateEscape Escape)
+{
+	switch (Escape)
+	{
+	case ETemplateEscape::Html:
+		return TEXT("html");
+	case ETemplateEscape::Json:
+		return TEXT("json");
+	case ETemplateEscape::Csv:
+		return TEXT("csv");
+	case ETemplateEscape::Xml:
+		return TEXT("xml");
+	default:
+		return TEXT("raw");
+	}
+}
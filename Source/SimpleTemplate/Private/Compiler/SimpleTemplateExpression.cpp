@@ -0,0 +1,906 @@
+// Copyright Playspace S.L. 2017
+
+#include "Compiler/SimpleTemplateExpression.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+
+//
+// Parser
+//
+
+/** Tokens of the expression grammar */
+enum class EExpressionLexToken : uint8
+{
+	End,
+	Error,
+	Identifier,
+	String,
+	Number,
+	True,
+	False,
+	LeftParen,
+	RightParen,
+	And,
+	Or,
+	Not,
+	In,
+	Equal,
+	NotEqual,
+	EqualIgnoreCase,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual
+};
+
+/**
+ * Recursive descent parser that lowers an expression into postfix ops:
+ *
+ * or         := and ( ('or' | '||') and )*
+ * and        := not ( ('and' | '&&') not )*
+ * not        := ('not' | '!') not | comparison
+ * comparison := operand ( op operand )?
+ * operand    := '(' or ')' | key | "string" | number | true | false
+ */
+class FTemplateExpressionParser
+{
+public:
+	FTemplateExpressionParser(const FString& InSource, FTemplateExpression& InExpression)
+		: Source(InSource)
+		, Expression(InExpression)
+		, Position(0)
+		, Token(EExpressionLexToken::End)
+		, StackDepth(0)
+	{}
+
+	FString Parse()
+	{
+		Next();
+		if (Token == EExpressionLexToken::End)
+		{
+			return TEXT("Empty expression.");
+		}
+		if (ParseOr() && Token != EExpressionLexToken::End)
+		{
+			SetError(FString::Printf(TEXT("Unexpected '%s'."), *TokenText));
+		}
+		return Error;
+	}
+
+private:
+	bool ParseOr()
+	{
+		if (!ParseAnd())
+		{
+			return false;
+		}
+		while (Token == EExpressionLexToken::Or)
+		{
+			Next();
+			const int32 Jump = Emit(EExpressionOp::JumpIfTrueOrPop);
+			if (!ParseAnd())
+			{
+				return false;
+			}
+			Expression.Ops[Jump].Operand = Expression.Ops.Num();
+		}
+		return true;
+	}
+
+	bool ParseAnd()
+	{
+		if (!ParseNot())
+		{
+			return false;
+		}
+		while (Token == EExpressionLexToken::And)
+		{
+			Next();
+			const int32 Jump = Emit(EExpressionOp::JumpIfFalseOrPop);
+			if (!ParseNot())
+			{
+				return false;
+			}
+			Expression.Ops[Jump].Operand = Expression.Ops.Num();
+		}
+		return true;
+	}
+
+	bool ParseNot()
+	{
+		if (Token == EExpressionLexToken::Not)
+		{
+			Next();
+			if (!ParseNot())
+			{
+				return false;
+			}
+			Emit(EExpressionOp::Not);
+			return true;
+		}
+		return ParseComparison();
+	}
+
+	bool ParseComparison()
+	{
+		if (!ParseOperand(false))
+		{
+			return false;
+		}
+
+		EExpressionOp Op;
+		bool bLiteralFallback = false;
+		switch (Token)
+		{
+		case EExpressionLexToken::Equal:
+			Op = EExpressionOp::Equal;
+			bLiteralFallback = true;
+			break;
+		case EExpressionLexToken::NotEqual:
+			Op = EExpressionOp::NotEqual;
+			bLiteralFallback = true;
+			break;
+		case EExpressionLexToken::EqualIgnoreCase:
+			Op = EExpressionOp::EqualIgnoreCase;
+			bLiteralFallback = true;
+			break;
+		case EExpressionLexToken::Less:
+			Op = EExpressionOp::Less;
+			break;
+		case EExpressionLexToken::LessEqual:
+			Op = EExpressionOp::LessEqual;
+			break;
+		case EExpressionLexToken::Greater:
+			Op = EExpressionOp::Greater;
+			break;
+		case EExpressionLexToken::GreaterEqual:
+			Op = EExpressionOp::GreaterEqual;
+			break;
+		case EExpressionLexToken::In:
+			Op = EExpressionOp::In;
+			break;
+		case EExpressionLexToken::Not:
+			// Only valid as 'not in'
+			Next();
+			if (Token != EExpressionLexToken::In)
+			{
+				SetError(FString::Printf(TEXT("'in' expected after 'not'. '%s' found instead."), *TokenText));
+				return false;
+			}
+			Op = EExpressionOp::NotIn;
+			break;
+		default:
+			return true;
+		}
+		Next();
+
+		// Unquoted right hand values are treated as literals if the key does not exist
+		if (!ParseOperand(bLiteralFallback))
+		{
+			return false;
+		}
+		Emit(Op);
+		return true;
+	}
+
+	bool ParseOperand(bool bLiteralFallback)
+	{
+		switch (Token)
+		{
+		case EExpressionLexToken::LeftParen:
+			Next();
+			if (!ParseOr())
+			{
+				return false;
+			}
+			if (Token != EExpressionLexToken::RightParen)
+			{
+				SetError(FString::Printf(TEXT("')' expected. '%s' found instead."), *TokenText));
+				return false;
+			}
+			break;
+		case EExpressionLexToken::Identifier:
+			Emit(bLiteralFallback ? EExpressionOp::PushVarOrLiteral : EExpressionOp::PushVar, Expression.Strings.AddUnique(TokenText));
+			break;
+		case EExpressionLexToken::String:
+			Emit(EExpressionOp::PushString, Expression.Strings.AddUnique(TokenText));
+			break;
+		case EExpressionLexToken::Number:
+			Emit(EExpressionOp::PushNumber, Expression.Numbers.Add(FCString::Atod(*TokenText)));
+			break;
+		case EExpressionLexToken::True:
+			Emit(EExpressionOp::PushBool, 1);
+			break;
+		case EExpressionLexToken::False:
+			Emit(EExpressionOp::PushBool, 0);
+			break;
+		case EExpressionLexToken::Error:
+			return false;
+		case EExpressionLexToken::End:
+			SetError(TEXT("Unexpected end of expression."));
+			return false;
+		default:
+			SetError(FString::Printf(TEXT("Value expected. '%s' found instead."), *TokenText));
+			return false;
+		}
+		Next();
+		return true;
+	}
+
+	int32 Emit(EExpressionOp Op, int32 Operand = 0)
+	{
+		switch (Op)
+		{
+		case EExpressionOp::PushVar:
+		case EExpressionOp::PushVarOrLiteral:
+		case EExpressionOp::PushString:
+		case EExpressionOp::PushNumber:
+		case EExpressionOp::PushBool:
+			++StackDepth;
+			Expression.MaxStackDepth = FMath::Max(Expression.MaxStackDepth, StackDepth);
+			break;
+		case EExpressionOp::Not:
+			break;
+		default:
+			// Binary ops and jumps (when not taken) consume one value
+			--StackDepth;
+			break;
+		}
+		return Expression.Ops.Add(FExpressionOp(Op, Operand));
+	}
+
+	void SetError(const FString& InError)
+	{
+		if (Error.IsEmpty())
+		{
+			Error = InError;
+		}
+		Token = EExpressionLexToken::Error;
+	}
+
+	// Keys of the first 'if' tokens were anything up to a space, '-' and '/' are still common in them
+	bool IsIdentifierChar(TCHAR Char) const
+	{
+		return FChar::IsAlnum(Char) || Char == TCHAR('_') || Char == TCHAR('.') || Char == TCHAR('-') || Char == TCHAR('/');
+	}
+
+	void Next()
+	{
+		TokenText.Reset();
+
+		while (Position < Source.Len() && FChar::IsWhitespace(Source[Position]))
+		{
+			++Position;
+		}
+
+		if (Position >= Source.Len())
+		{
+			Token = EExpressionLexToken::End;
+			return;
+		}
+
+		const TCHAR Char = Source[Position];
+		const TCHAR NextChar = Position + 1 < Source.Len() ? Source[Position + 1] : TCHAR('\0');
+
+		// Strings
+		if (Char == TCHAR('"') || Char == TCHAR('\''))
+		{
+			int32 End = Position + 1;
+			while (End < Source.Len() && Source[End] != Char)
+			{
+				++End;
+			}
+			if (End >= Source.Len())
+			{
+				SetError(FString::Printf(TEXT("Unterminated string in '%s'."), *Source));
+				return;
+			}
+			TokenText = Source.Mid(Position + 1, End - Position - 1);
+			Position = End + 1;
+			Token = EExpressionLexToken::String;
+			return;
+		}
+
+		// Keys, keywords and numbers
+		if (IsIdentifierChar(Char))
+		{
+			int32 End = Position + 1;
+			while (End < Source.Len() && IsIdentifierChar(Source[End]))
+			{
+				++End;
+			}
+			TokenText = Source.Mid(Position, End - Position);
+			Position = End;
+
+			// Only digits and dots are a number, keys may start with a digit like '1st_place'
+			if (FChar::IsDigit(Char) || (Char == TCHAR('-') && FChar::IsDigit(NextChar)))
+			{
+				int32 NumDots = 0;
+				int32 i = 1;
+				for (; i < TokenText.Len() && (FChar::IsDigit(TokenText[i]) || TokenText[i] == TCHAR('.')); i++)
+				{
+					NumDots += TokenText[i] == TCHAR('.') ? 1 : 0;
+				}
+				if (i == TokenText.Len())
+				{
+					if (NumDots > 1)
+					{
+						SetError(FString::Printf(TEXT("Invalid number '%s' in '%s'."), *TokenText, *Source));
+						return;
+					}
+					Token = EExpressionLexToken::Number;
+					return;
+				}
+			}
+
+			if (TokenText.Equals(TEXT("and"), ESearchCase::CaseSensitive))
+			{
+				Token = EExpressionLexToken::And;
+			}
+			else if (TokenText.Equals(TEXT("or"), ESearchCase::CaseSensitive))
+			{
+				Token = EExpressionLexToken::Or;
+			}
+			else if (TokenText.Equals(TEXT("not"), ESearchCase::CaseSensitive))
+			{
+				Token = EExpressionLexToken::Not;
+			}
+			else if (TokenText.Equals(TEXT("in"), ESearchCase::CaseSensitive))
+			{
+				Token = EExpressionLexToken::In;
+			}
+			else if (TokenText.Equals(TEXT("true"), ESearchCase::CaseSensitive))
+			{
+				Token = EExpressionLexToken::True;
+			}
+			else if (TokenText.Equals(TEXT("false"), ESearchCase::CaseSensitive))
+			{
+				Token = EExpressionLexToken::False;
+			}
+			else
+			{
+				Token = EExpressionLexToken::Identifier;
+			}
+			return;
+		}
+
+		// Operators
+		int32 Length = 2;
+		if (Char == TCHAR('=') && NextChar == TCHAR('='))
+		{
+			Token = EExpressionLexToken::Equal;
+		}
+		else if (Char == TCHAR('!') && NextChar == TCHAR('='))
+		{
+			Token = EExpressionLexToken::NotEqual;
+		}
+		else if (Char == TCHAR('~') && NextChar == TCHAR('='))
+		{
+			Token = EExpressionLexToken::EqualIgnoreCase;
+		}
+		else if (Char == TCHAR('<') && NextChar == TCHAR('='))
+		{
+			Token = EExpressionLexToken::LessEqual;
+		}
+		else if (Char == TCHAR('>') && NextChar == TCHAR('='))
+		{
+			Token = EExpressionLexToken::GreaterEqual;
+		}
+		else if (Char == TCHAR('&') && NextChar == TCHAR('&'))
+		{
+			Token = EExpressionLexToken::And;
+		}
+		else if (Char == TCHAR('|') && NextChar == TCHAR('|'))
+		{
+			Token = EExpressionLexToken::Or;
+		}
+		else
+		{
+			Length = 1;
+			switch (Char)
+			{
+			case TCHAR('<'):
+				Token = EExpressionLexToken::Less;
+				break;
+			case TCHAR('>'):
+				Token = EExpressionLexToken::Greater;
+				break;
+			case TCHAR('!'):
+				Token = EExpressionLexToken::Not;
+				break;
+			case TCHAR('('):
+				Token = EExpressionLexToken::LeftParen;
+				break;
+			case TCHAR(')'):
+				Token = EExpressionLexToken::RightParen;
+				break;
+			default:
+				SetError(FString::Printf(TEXT("Unexpected character '%c' in '%s'."), Char, *Source));
+				return;
+			}
+		}
+		TokenText = Source.Mid(Position, Length);
+		Position += Length;
+	}
+
+private:
+	const FString& Source;
+	FTemplateExpression& Expression;
+	int32 Position;
+	EExpressionLexToken Token;
+	FString TokenText;
+	FString Error;
+	int32 StackDepth;
+};
+
+//
+// Evaluation
+//
+
+namespace SimpleTemplateExpression
+{
+	static bool IsMissing(const FExpressionValue& Value)
+	{
+		return Value.Kind == FExpressionValue::EKind::Missing
+			|| (Value.Kind == FExpressionValue::EKind::Json && (!Value.Json.IsValid() || Value.Json->IsNull()));
+	}
+
+	static bool IsTrue(const FExpressionValue& Value)
+	{
+		switch (Value.Kind)
+		{
+		case FExpressionValue::EKind::Bool:
+			return Value.bValue;
+		case FExpressionValue::EKind::Number:
+			return Value.Number != 0.0;
+		case FExpressionValue::EKind::String:
+			return !Value.String->IsEmpty();
+		case FExpressionValue::EKind::DataNumber:
+			// Like json numbers, it is TRUE because it exists
+			return true;
+		case FExpressionValue::EKind::Json:
+		{
+			// Bools are checked by value, all other types are TRUE if they exist
+			if (IsMissing(Value))
+			{
+				return false;
+			}
+			bool bValue = false;
+			return Value.Json->TryGetBool(bValue) ? bValue : true;
+		}
+		}
+		return false;
+	}
+
+	static bool TryGetBool(const FExpressionValue& Value, bool& OutValue)
+	{
+		if (Value.Kind == FExpressionValue::EKind::Bool)
+		{
+			OutValue = Value.bValue;
+			return true;
+		}
+		if (Value.Kind == FExpressionValue::EKind::Json && Value.Json->Type == EJson::Boolean)
+		{
+			return Value.Json->TryGetBool(OutValue);
+		}
+		return false;
+	}
+
+	static bool TryGetNumber(const FExpressionValue& Value, double& OutValue)
+	{
+		switch (Value.Kind)
+		{
+		case FExpressionValue::EKind::Number:
+		case FExpressionValue::EKind::DataNumber:
+			OutValue = Value.Number;
+			return true;
+		case FExpressionValue::EKind::String:
+			if (Value.String->IsNumeric())
+			{
+				OutValue = FCString::Atod(**Value.String);
+				return true;
+			}
+			return false;
+		case FExpressionValue::EKind::Json:
+			return Value.Json->Type != EJson::Boolean && Value.Json->TryGetNumber(OutValue);
+		}
+		return false;
+	}
+
+	/** The value as text, literals are not copied. Json strings and numbers are read into Scratch */
+	static const TCHAR* TryGetText(const FExpressionValue& Value, FString& Scratch)
+	{
+		switch (Value.Kind)
+		{
+		case FExpressionValue::EKind::String:
+			return **Value.String;
+		case FExpressionValue::EKind::Bool:
+			return Value.bValue ? TEXT("true") : TEXT("false");
+		case FExpressionValue::EKind::Number:
+			Scratch = FString::SanitizeFloat(Value.Number);
+			return *Scratch;
+		case FExpressionValue::EKind::DataNumber:
+			return FJsonValueNumber(Value.Number).TryGetString(Scratch) ? *Scratch : nullptr;
+		case FExpressionValue::EKind::Json:
+			switch (Value.Json->Type)
+			{
+			case EJson::Boolean:
+				return Value.Json->AsBool() ? TEXT("true") : TEXT("false");
+			case EJson::String:
+			case EJson::Number:
+				return Value.Json->TryGetString(Scratch) ? *Scratch : nullptr;
+			default:
+				return nullptr;
+			}
+		}
+		return nullptr;
+	}
+
+	static bool IsNumber(const FExpressionValue& Value)
+	{
+		return Value.Kind == FExpressionValue::EKind::Number || Value.Kind == FExpressionValue::EKind::DataNumber || (Value.Kind == FExpressionValue::EKind::Json && Value.Json->Type == EJson::Number);
+	}
+
+	static bool AreEqual(const FExpressionValue& Left, const FExpressionValue& Right, ESearchCase::Type SearchCase)
+	{
+		double LeftNumber, RightNumber;
+		const bool bLeftNumber = TryGetNumber(Left, LeftNumber);
+		const bool bRightNumber = TryGetNumber(Right, RightNumber);
+		if (bLeftNumber && bRightNumber)
+		{
+			return LeftNumber == RightNumber;
+		}
+
+		bool bLeft, bRight;
+		if (TryGetBool(Left, bLeft) && TryGetBool(Right, bRight))
+		{
+			return bLeft == bRight;
+		}
+
+		// The text of a number is numeric, it never equals text that is not a number
+		if ((IsNumber(Left) && !bRightNumber) || (IsNumber(Right) && !bLeftNumber))
+		{
+			return false;
+		}
+
+		FString LeftScratch, RightScratch;
+		const TCHAR* LeftText = TryGetText(Left, LeftScratch);
+		const TCHAR* RightText = TryGetText(Right, RightScratch);
+		if (LeftText == nullptr || RightText == nullptr)
+		{
+			return false;
+		}
+		return (SearchCase == ESearchCase::CaseSensitive ? FCString::Strcmp(LeftText, RightText) : FCString::Stricmp(LeftText, RightText)) == 0;
+	}
+
+	/** Returns <0, 0 or >0, false if the values can not be ordered */
+	static bool TryCompare(const FExpressionValue& Left, const FExpressionValue& Right, int32& OutResult)
+	{
+		double LeftNumber, RightNumber;
+		if (TryGetNumber(Left, LeftNumber) && TryGetNumber(Right, RightNumber))
+		{
+			OutResult = LeftNumber < RightNumber ? -1 : (LeftNumber > RightNumber ? 1 : 0);
+			return true;
+		}
+
+		FString LeftScratch, RightScratch;
+		const TCHAR* LeftText = TryGetText(Left, LeftScratch);
+		const TCHAR* RightText = TryGetText(Right, RightScratch);
+		if (LeftText != nullptr && RightText != nullptr)
+		{
+			OutResult = FCString::Strcmp(LeftText, RightText);
+			return true;
+		}
+		return false;
+	}
+
+	static bool IsIn(const FExpressionValue& Needle, const FExpressionValue& Haystack)
+	{
+		FString NeedleScratch;
+		if (Haystack.Kind == FExpressionValue::EKind::Json)
+		{
+			switch (Haystack.Json->Type)
+			{
+			case EJson::Array:
+			{
+				FExpressionValue Item;
+				Item.Kind = FExpressionValue::EKind::Json;
+				for (const TSharedPtr<FJsonValue>& Element : Haystack.Json->AsArray())
+				{
+					Item.Json = Element;
+					if (!IsMissing(Item) && AreEqual(Needle, Item, ESearchCase::CaseSensitive))
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+			case EJson::Object:
+			{
+				// Object keys are hashed as strings, a text needle is only copied if it is not one already
+				if (Needle.Kind == FExpressionValue::EKind::String)
+				{
+					return Haystack.Json->AsObject()->HasField(*Needle.String);
+				}
+				const TCHAR* Key = TryGetText(Needle, NeedleScratch);
+				return Key != nullptr && Haystack.Json->AsObject()->HasField(Key == *NeedleScratch ? NeedleScratch : FString(Key));
+			}
+			default:
+				break;
+			}
+		}
+
+		FString HaystackScratch;
+		const TCHAR* NeedleText = TryGetText(Needle, NeedleScratch);
+		const TCHAR* HaystackText = TryGetText(Haystack, HaystackScratch);
+		return NeedleText != nullptr && HaystackText != nullptr && FCString::Strstr(HaystackText, NeedleText) != nullptr;
+	}
+}
+
+//
+// FTemplateExpression
+//
+
+FString FTemplateExpression::Compile(const FString& Source)
+{
+	Ops.Reset();
+	Strings.Reset();
+	Numbers.Reset();
+	MaxStackDepth = 0;
+
+	FTemplateExpressionParser Parser(Source, *this);
+	const FString Error = Parser.Parse();
+	UpdateKeys();
+	return Error;
+}
+
+void FTemplateExpression::UpdateKeys()
+{
+	Keys.Reset(Strings.Num());
+	for (const FString& String : Strings)
+	{
+		Keys.Emplace(String);
+	}
+}
+
+bool FTemplateExpression::Evaluate(FTemplateCompilerContent& Context, const FExpressionOp* Ops, int32 NumOps, const FTemplateKey* Keys, const double* Numbers, int32 MaxStackDepth)
+{
+	using namespace SimpleTemplateExpression;
+
+	TArray<FExpressionValue, TInlineAllocator<TPL_EXPRESSION_INLINE_STACK>> Stack;
+	Stack.Reserve(MaxStackDepth);
+
+	int32 Index = 0;
+	while (Index < NumOps)
+	{
+		const FExpressionOp& Op = Ops[Index++];
+		switch (Op.Type)
+		{
+		case EExpressionOp::PushVar:
+		case EExpressionOp::PushVarOrLiteral:
+		{
+			FExpressionValue& Value = Stack[Stack.AddDefaulted()];
+			if (TTemplateCompilerHelper::GetNumberOrValue(Context, Keys[Op.Operand], Value.Number, Value.Json))
+			{
+				Value.Kind = FExpressionValue::EKind::DataNumber;
+			}
+			else if (Value.Json.IsValid())
+			{
+				Value.Kind = FExpressionValue::EKind::Json;
+			}
+			else if (Op.Type == EExpressionOp::PushVarOrLiteral)
+			{
+				Value.Kind = FExpressionValue::EKind::String;
+				Value.String = &Keys[Op.Operand].Key;
+			}
+			break;
+		}
+		case EExpressionOp::PushString:
+		{
+			FExpressionValue& Value = Stack[Stack.AddDefaulted()];
+			Value.Kind = FExpressionValue::EKind::String;
+			Value.String = &Keys[Op.Operand].Key;
+			break;
+		}
+		case EExpressionOp::PushNumber:
+		{
+			FExpressionValue& Value = Stack[Stack.AddDefaulted()];
+			Value.Kind = FExpressionValue::EKind::Number;
+			Value.Number = Numbers[Op.Operand];
+			break;
+		}
+		case EExpressionOp::PushBool:
+		{
+			FExpressionValue& Value = Stack[Stack.AddDefaulted()];
+			Value.Kind = FExpressionValue::EKind::Bool;
+			Value.bValue = Op.Operand != 0;
+			break;
+		}
+		case EExpressionOp::Not:
+		{
+			FExpressionValue& Value = Stack.Last();
+			Value.bValue = !IsTrue(Value);
+			Value.Kind = FExpressionValue::EKind::Bool;
+			Value.Json.Reset();
+			break;
+		}
+		case EExpressionOp::JumpIfFalseOrPop:
+			if (!IsTrue(Stack.Last()))
+			{
+				Index = Op.Operand;
+			}
+			else
+			{
+				Stack.Pop(false);
+			}
+			break;
+		case EExpressionOp::JumpIfTrueOrPop:
+			if (IsTrue(Stack.Last()))
+			{
+				Index = Op.Operand;
+			}
+			else
+			{
+				Stack.Pop(false);
+			}
+			break;
+		default:
+		{
+			// Binary comparison, comparing against a missing value is always false
+			const FExpressionValue& Right = Stack[Stack.Num() - 1];
+			const FExpressionValue& Left = Stack[Stack.Num() - 2];
+			bool bResult = false;
+			if (!IsMissing(Left) && !IsMissing(Right))
+			{
+				int32 Order = 0;
+				switch (Op.Type)
+				{
+				case EExpressionOp::Equal:
+					bResult = AreEqual(Left, Right, ESearchCase::CaseSensitive);
+					break;
+				case EExpressionOp::NotEqual:
+					bResult = !AreEqual(Left, Right, ESearchCase::CaseSensitive);
+					break;
+				case EExpressionOp::EqualIgnoreCase:
+					bResult = AreEqual(Left, Right, ESearchCase::IgnoreCase);
+					break;
+				case EExpressionOp::Less:
+					bResult = TryCompare(Left, Right, Order) && Order < 0;
+					break;
+				case EExpressionOp::LessEqual:
+					bResult = TryCompare(Left, Right, Order) && Order <= 0;
+					break;
+				case EExpressionOp::Greater:
+					bResult = TryCompare(Left, Right, Order) && Order > 0;
+					break;
+				case EExpressionOp::GreaterEqual:
+					bResult = TryCompare(Left, Right, Order) && Order >= 0;
+					break;
+				case EExpressionOp::In:
+					bResult = IsIn(Left, Right);
+					break;
+				case EExpressionOp::NotIn:
+					bResult = !IsIn(Left, Right);
+					break;
+				default:
+					break;
+				}
+			}
+			Stack.Pop(false);
+			FExpressionValue& Result = Stack.Last();
+			Result.Kind = FExpressionValue::EKind::Bool;
+			Result.bValue = bResult;
+			Result.Json.Reset();
+			break;
+		}
+		}
+	}
+
+	return Stack.Num() > 0 && IsTrue(Stack.Last());
+}
+
+bool FTemplateExpression::IsValid(const FExpressionOp* Ops, int32 NumOps, int32 NumStrings, int32 NumNumbers, int32 MaxStackDepth)
+{
+	if (NumOps < 0 || MaxStackDepth < 0 || MaxStackDepth > NumOps)
+	{
+		return false;
+	}
+
+	// Stack depth at each op reached by a jump, it has to match the depth falling through
+	TArray<int32, TInlineAllocator<TPL_EXPRESSION_INLINE_STACK>> JumpDepths;
+	JumpDepths.Init(INDEX_NONE, NumOps + 1);
+
+	int32 Depth = 0;
+	for (int32 i = 0; i <= NumOps; i++)
+	{
+		if (JumpDepths[i] != INDEX_NONE && JumpDepths[i] != Depth)
+		{
+			return false;
+		}
+		if (i == NumOps)
+		{
+			break;
+		}
+
+		const FExpressionOp& Op = Ops[i];
+		switch (Op.Type)
+		{
+		case EExpressionOp::PushVar:
+		case EExpressionOp::PushVarOrLiteral:
+		case EExpressionOp::PushString:
+			if (Op.Operand < 0 || Op.Operand >= NumStrings)
+			{
+				return false;
+			}
+			Depth++;
+			break;
+		case EExpressionOp::PushNumber:
+			if (Op.Operand < 0 || Op.Operand >= NumNumbers)
+			{
+				return false;
+			}
+			Depth++;
+			break;
+		case EExpressionOp::PushBool:
+			Depth++;
+			break;
+		case EExpressionOp::Not:
+			if (Depth < 1)
+			{
+				return false;
+			}
+			break;
+		case EExpressionOp::Equal:
+		case EExpressionOp::NotEqual:
+		case EExpressionOp::EqualIgnoreCase:
+		case EExpressionOp::Less:
+		case EExpressionOp::LessEqual:
+		case EExpressionOp::Greater:
+		case EExpressionOp::GreaterEqual:
+		case EExpressionOp::In:
+		case EExpressionOp::NotIn:
+			if (Depth < 2)
+			{
+				return false;
+			}
+			Depth--;
+			break;
+		case EExpressionOp::JumpIfFalseOrPop:
+		case EExpressionOp::JumpIfTrueOrPop:
+			if (Depth < 1 || Op.Operand <= i || Op.Operand > NumOps || (JumpDepths[Op.Operand] != INDEX_NONE && JumpDepths[Op.Operand] != Depth))
+			{
+				return false;
+			}
+			JumpDepths[Op.Operand] = Depth;
+			Depth--;
+			break;
+		default:
+			return false;
+		}
+
+		if (Depth > MaxStackDepth)
+		{
+			return false;
+		}
+	}
+	return NumOps == 0 || Depth == 1;
+}
+
+void FTemplateExpression::Serialize(FArchive& Ar)
+{
+	Ar << Ops;
+	Ar << Strings;
+	Ar << Numbers;
+	Ar << MaxStackDepth;
+	if (Ar.IsLoading())
+	{
+		if (!IsValid(Ops.GetData(), Ops.Num(), Strings.Num(), Numbers.Num(), MaxStackDepth))
+		{
+			Ar.SetError();
+			Ops.Reset();
+			Strings.Reset();
+			Numbers.Reset();
+			MaxStackDepth = 0;
+		}
+		UpdateKeys();
+	}
+}
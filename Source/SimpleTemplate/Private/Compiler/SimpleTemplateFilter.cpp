@@ -0,0 +1,242 @@
+// Copyright Playspace S.L. 2017
+
+#include "Compiler/SimpleTemplateFilter.h"
+#include "ISimpleTemplate.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/Archive.h"
+
+namespace SimpleTemplateFilter
+{
+	static void Upper(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		TCHAR* Chars = Value.GetChars();
+		for (int32 i = 0; i < Value.Len; i++)
+		{
+			Chars[i] = FChar::ToUpper(Chars[i]);
+		}
+	}
+
+	static void Lower(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		TCHAR* Chars = Value.GetChars();
+		for (int32 i = 0; i < Value.Len; i++)
+		{
+			Chars[i] = FChar::ToLower(Chars[i]);
+		}
+	}
+
+	static void Capitalize(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		if (Value.Len > 0)
+		{
+			TCHAR* Chars = Value.GetChars();
+			Chars[0] = FChar::ToUpper(Chars[0]);
+		}
+	}
+
+	static void Trim(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		const TCHAR* Chars = Value.GetChars();
+		int32 Begin = 0;
+		int32 End = Value.Len;
+		while (Begin < End && FChar::IsWhitespace(Chars[Begin]))
+		{
+			Begin++;
+		}
+		while (End > Begin && FChar::IsWhitespace(Chars[End - 1]))
+		{
+			End--;
+		}
+		Value.Start += Begin;
+		Value.Len = End - Begin;
+	}
+
+	static void Truncate(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		Value.Len = FMath::Clamp(Call.Number, 0, Value.Len);
+	}
+
+	static void Default(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		if (Value.Len == 0)
+		{
+			Value.Set(Call.Argument);
+		}
+	}
+
+	// Entries are never removed, calls keep pointing to them. Unknown names get an empty entry.
+	static TMap<FString, TUniquePtr<FTemplateFilterEntry>>& GetFilters()
+	{
+		static TMap<FString, TUniquePtr<FTemplateFilterEntry>> Filters = []()
+		{
+			TMap<FString, TUniquePtr<FTemplateFilterEntry>> Builtin;
+			Builtin.Add(TEXT("upper"), MakeUnique<FTemplateFilterEntry>(FTemplateFilterEntry{ &Upper, ETemplateFilterArgument::None }));
+			Builtin.Add(TEXT("lower"), MakeUnique<FTemplateFilterEntry>(FTemplateFilterEntry{ &Lower, ETemplateFilterArgument::None }));
+			Builtin.Add(TEXT("capitalize"), MakeUnique<FTemplateFilterEntry>(FTemplateFilterEntry{ &Capitalize, ETemplateFilterArgument::None }));
+			Builtin.Add(TEXT("trim"), MakeUnique<FTemplateFilterEntry>(FTemplateFilterEntry{ &Trim, ETemplateFilterArgument::None }));
+			Builtin.Add(TEXT("truncate"), MakeUnique<FTemplateFilterEntry>(FTemplateFilterEntry{ &Truncate, ETemplateFilterArgument::Number }));
+			Builtin.Add(TEXT("default"), MakeUnique<FTemplateFilterEntry>(FTemplateFilterEntry{ &Default, ETemplateFilterArgument::String }));
+			return Builtin;
+		}();
+		return Filters;
+	}
+
+	static FTemplateFilterEntry& FindOrAddEntry(const FString& Name)
+	{
+		TUniquePtr<FTemplateFilterEntry>& Entry = GetFilters().FindOrAdd(Name.ToLower());
+		if (!Entry.IsValid())
+		{
+			Entry = MakeUnique<FTemplateFilterEntry>(FTemplateFilterEntry{ nullptr, ETemplateFilterArgument::None });
+		}
+		return *Entry;
+	}
+
+	/** Split a chain on the '|' outside of quotes */
+	static void SplitChain(const FString& Chain, TArray<FString>& OutNames)
+	{
+		bool bInQuotes = false;
+		int32 Start = 0;
+		for (int32 i = 0; i < Chain.Len(); i++)
+		{
+			if (Chain[i] == TCHAR('"'))
+			{
+				bInQuotes = !bInQuotes;
+			}
+			else if (Chain[i] == TCHAR('|') && !bInQuotes)
+			{
+				OutNames.Add(Chain.Mid(Start, i - Start));
+				Start = i + 1;
+			}
+		}
+		OutNames.Add(Chain.Mid(Start));
+	}
+
+	static FCriticalSection FiltersLock;
+}
+
+
+/* FTemplateFilterCall interface
+ *****************************************************************************/
+
+FArchive& operator<<(FArchive& Ar, FTemplateFilterCall& Call)
+{
+	Ar << Call.Name;
+	Ar << Call.Argument;
+	if (Ar.IsLoading())
+	{
+		const FString Error = FTemplateFilters::Resolve(Call);
+		if (!Error.IsEmpty())
+		{
+			UE_LOG(LogSTE, Error, TEXT("%s! The filter is skipped"), *Error);
+		}
+	}
+	return Ar;
+}
+
+
+/* FTemplateFilters interface
+ *****************************************************************************/
+
+void FTemplateFilters::Register(const FString& Name, FTemplateFilterFunction Function, ETemplateFilterArgument Argument)
+{
+	using namespace SimpleTemplateFilter;
+	FScopeLock Lock(&FiltersLock);
+	FTemplateFilterEntry& Entry = FindOrAddEntry(Name);
+	Entry.Argument = Argument;
+	Entry.Function = Function;
+}
+
+FString FTemplateFilters::Resolve(FTemplateFilterCall& Call)
+{
+	using namespace SimpleTemplateFilter;
+
+	// Filters registered later are picked up through the entry, numbers are parsed for them up front
+	Call.Number = Call.Argument.IsNumeric() ? FCString::Atoi(*Call.Argument) : 0;
+
+	FTemplateFilterEntry Filter;
+	{
+		FScopeLock Lock(&FiltersLock);
+		const FTemplateFilterEntry& Entry = FindOrAddEntry(Call.Name);
+		Call.Entry = &Entry;
+		Filter = Entry;
+	}
+	if (Filter.Function == nullptr)
+	{
+		return FString::Printf(TEXT("Unknown filter '%s'"), *Call.Name);
+	}
+
+	switch (Filter.Argument)
+	{
+	case ETemplateFilterArgument::None:
+		if (!Call.Argument.IsEmpty())
+		{
+			Call.Entry = nullptr;
+			return FString::Printf(TEXT("Filter '%s' takes no argument"), *Call.Name);
+		}
+		break;
+	case ETemplateFilterArgument::Number:
+		if (!Call.Argument.IsNumeric())
+		{
+			Call.Entry = nullptr;
+			return FString::Printf(TEXT("Filter '%s' needs a number, e.g. '%s:10'"), *Call.Name, *Call.Name);
+		}
+		break;
+	default:
+		break;
+	}
+	return FString();
+}
+
+FString FTemplateFilters::Parse(const FString& Chain, TArray<FTemplateFilterCall>& OutFilters, ETemplateEscape& OutEscape)
+{
+	TArray<FString> Names;
+	SimpleTemplateFilter::SplitChain(Chain, Names);
+	for (int32 i = 0; i < Names.Num(); i++)
+	{
+		const FString Name = Names[i].TrimStartAndEnd();
+
+		// Escaping happens when writing, after all other filters
+		if (FTemplateEscape::Parse(Name, OutEscape))
+		{
+			if (i != Names.Num() - 1)
+			{
+				return FString::Printf(TEXT("Escape filter '%s' has to be the last filter"), *Name);
+			}
+			break;
+		}
+
+		FTemplateFilterCall& Call = OutFilters[OutFilters.AddDefaulted()];
+		if (!Name.Split(TEXT(":"), &Call.Name, &Call.Argument))
+		{
+			Call.Name = Name;
+		}
+		Call.Name.TrimEndInline();
+		Call.Argument = Call.Argument.TrimStartAndEnd().TrimQuotes();
+
+		const FString Error = Resolve(Call);
+		if (!Error.IsEmpty())
+		{
+			return Error;
+		}
+	}
+	return FString();
+}
+
+void FTemplateFilters::Write(FArchive& WriteStream, FString& Value, const FTemplateFilterCall* Filters, int32 NumFilters, ETemplateEscape Escape)
+{
+	if (NumFilters == 0)
+	{
+		FTemplateEscape::Write(WriteStream, Value, Escape);
+		return;
+	}
+
+	FTemplateFilterValue FilterValue(Value);
+	for (int32 i = 0; i < NumFilters; i++)
+	{
+		if (FTemplateFilterFunction Function = Filters[i].GetFunction())
+		{
+			Function(FilterValue, Filters[i]);
+		}
+	}
+	FTemplateEscape::Write(WriteStream, *FilterValue.Buffer + FilterValue.Start, FilterValue.Len, Escape);
+}
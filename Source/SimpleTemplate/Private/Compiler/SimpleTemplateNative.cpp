@@ -0,0 +1,94 @@
+// Copyright Playspace S.L. 2017
+
+#include "Compiler/SimpleTemplateNative.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/ScopeLock.h"
+
+namespace SimpleTemplateNative
+{
+	struct FNativeEntry
+	{
+		uint32 ProgramCrc;
+		FTemplateNativeFunction Function;
+	};
+
+	static TMap<FString, FNativeEntry>& GetEntries()
+	{
+		static TMap<FString, FNativeEntry> Entries;
+		return Entries;
+	}
+
+	static FCriticalSection& GetLock()
+	{
+		static FCriticalSection Lock;
+		return Lock;
+	}
+
+	static FThreadSafeCounter Generation;
+}
+
+
+/* FTemplateNativeRegistry interface
+ *****************************************************************************/
+
+void FTemplateNativeRegistry::Register(const FString& TemplatePath, uint32 ProgramCrc, FTemplateNativeFunction Function)
+{
+	using namespace SimpleTemplateNative;
+	FScopeLock Lock(&GetLock());
+	GetEntries().Add(TemplatePath, { ProgramCrc, Function });
+	Generation.Increment();
+}
+
+void FTemplateNativeRegistry::Unregister(const FString& TemplatePath)
+{
+	using namespace SimpleTemplateNative;
+	FScopeLock Lock(&GetLock());
+	GetEntries().Remove(TemplatePath);
+	Generation.Increment();
+}
+
+FTemplateNativeFunction FTemplateNativeRegistry::Find(const FString& TemplatePath, uint32 ProgramCrc)
+{
+	using namespace SimpleTemplateNative;
+	FScopeLock Lock(&GetLock());
+	const FNativeEntry* Entry = GetEntries().Find(TemplatePath);
+	if (Entry == nullptr)
+	{
+		return nullptr;
+	}
+	if (Entry->ProgramCrc != ProgramCrc)
+	{
+		UE_LOG(LogSTE, Warning, TEXT("Native code of template %s is outdated, it is interpreted instead. Run the SimpleTemplateTranspile commandlet again!"), *TemplatePath);
+		return nullptr;
+	}
+	return Entry->Function;
+}
+
+bool FTemplateNativeRegistry::HasFunctions()
+{
+	using namespace SimpleTemplateNative;
+	FScopeLock Lock(&GetLock());
+	return GetEntries().Num() > 0;
+}
+
+int32 FTemplateNativeRegistry::GetGeneration()
+{
+	return SimpleTemplateNative::Generation.GetValue();
+}
+
+TArray<FTemplateFilterCall> FTemplateNativeRegistry::MakeFilters(std::initializer_list<const TCHAR*> NamesAndArguments)
+{
+	TArray<FTemplateFilterCall> Filters;
+	for (auto It = NamesAndArguments.begin(); It != NamesAndArguments.end() && It + 1 != NamesAndArguments.end(); It += 2)
+	{
+		FTemplateFilterCall& Call = Filters[Filters.AddDefaulted()];
+		Call.Name = It[0];
+		Call.Argument = It[1];
+		const FString Error = FTemplateFilters::Resolve(Call);
+		if (!Error.IsEmpty())
+		{
+			UE_LOG(LogSTE, Error, TEXT("%s! The filter is skipped"), *Error);
+		}
+	}
+	return Filters;
+}
@@ -0,0 +1,162 @@
+// Copyright Playspace S.L. 2017
+
+#include "Compiler/SimpleTemplateProfiler.h"
+#include "HAL/PlatformTime.h"
+
+/* FTemplateProfileScope implementation
+ *****************************************************************************/
+
+void FTemplateProfileScope::Begin(const FToken* Token, FArchive& InWriteStream, ETemplateProfileEvent Event)
+{
+	WriteStream = &InWriteStream;
+	Profiler->Begin(Token, Event, InWriteStream.Tell());
+}
+
+void FTemplateProfileScope::End()
+{
+	Profiler->End(WriteStream->Tell());
+}
+
+
+/* FTemplateProfiler interface
+ *****************************************************************************/
+
+void FTemplateProfiler::Begin(const FToken* Token, ETemplateProfileEvent Event, int64 OutputPos)
+{
+	FFrame& Frame = Stack[Stack.AddUninitialized()];
+	Frame.Token = Token;
+	Frame.Event = Event;
+	Frame.StartOutput = OutputPos;
+	Frame.ChildCycles = 0;
+	Frame.StartCycles = FPlatformTime::Cycles64();
+}
+
+void FTemplateProfiler::End(int64 OutputPos)
+{
+	const uint64 EndCycles = FPlatformTime::Cycles64();
+	const FFrame Frame = Stack.Pop(false);
+	const uint64 Cycles = EndCycles - Frame.StartCycles;
+
+	FTokenStats& TokenStats = Stats.FindOrAdd(Frame.Token);
+	switch (Frame.Event)
+	{
+	case ETemplateProfileEvent::Token:
+		TokenStats.Calls++;
+		TokenStats.InclusiveCycles += Cycles;
+		TokenStats.ChildCycles += Frame.ChildCycles;
+		TokenStats.OutputBytes += OutputPos - Frame.StartOutput;
+
+		// Nested tokens are not part of the self time of their parent
+		for (int32 i = Stack.Num() - 1; i >= 0; i--)
+		{
+			if (Stack[i].Event == ETemplateProfileEvent::Token)
+			{
+				Stack[i].ChildCycles += Cycles;
+				break;
+			}
+		}
+		break;
+	case ETemplateProfileEvent::Condition:
+		TokenStats.ConditionCycles += Cycles;
+		break;
+	case ETemplateProfileEvent::Iteration:
+		TokenStats.Iterations++;
+		break;
+	}
+}
+
+void FTemplateProfiler::BuildReport(int32 NumRenders, FSimpleTemplateProfile& OutProfile) const
+{
+	const double MillisecondsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+
+	OutProfile.Renders = NumRenders;
+	OutProfile.TotalTime = 0.0f;
+	OutProfile.Tokens.Reset(Stats.Num());
+	for (const TPair<const FToken*, FTokenStats>& Pair : Stats)
+	{
+		const FTokenStats& TokenStats = Pair.Value;
+		FSimpleTemplateTokenProfile& TokenProfile = OutProfile.Tokens[OutProfile.Tokens.AddDefaulted()];
+		if (Pair.Key != nullptr)
+		{
+			TokenProfile.Line = Pair.Key->Line;
+			TokenProfile.Column = Pair.Key->Column;
+			TokenProfile.Token = Describe(Pair.Key);
+			TokenProfile.bIncluded = Pair.Key->bIncluded;
+		}
+		else
+		{
+			TokenProfile.Token = TEXT("<native>");
+		}
+		TokenProfile.Calls = TokenStats.Calls;
+		TokenProfile.Iterations = TokenStats.Iterations;
+		TokenProfile.InclusiveTime = TokenStats.InclusiveCycles * MillisecondsPerCycle;
+		TokenProfile.SelfTime = (TokenStats.InclusiveCycles - FMath::Min(TokenStats.ChildCycles, TokenStats.InclusiveCycles)) * MillisecondsPerCycle;
+		TokenProfile.ConditionTime = TokenStats.ConditionCycles * MillisecondsPerCycle;
+		TokenProfile.OutputBytes = (int32)FMath::Min<int64>(TokenStats.OutputBytes, MAX_int32);
+		OutProfile.TotalTime += TokenProfile.SelfTime;
+	}
+
+	for (FSimpleTemplateTokenProfile& TokenProfile : OutProfile.Tokens)
+	{
+		TokenProfile.Heat = OutProfile.TotalTime > 0.0f ? TokenProfile.SelfTime / OutProfile.TotalTime : 0.0f;
+	}
+	OutProfile.Tokens.Sort([](const FSimpleTemplateTokenProfile& A, const FSimpleTemplateTokenProfile& B)
+	{
+		return A.SelfTime > B.SelfTime;
+	});
+}
+
+void FTemplateProfiler::Reset()
+{
+	Stats.Reset();
+	Stack.Reset();
+}
+
+
+/* FTemplateProfiler implementation
+ *****************************************************************************/
+
+FString FTemplateProfiler::Describe(const FToken* Token)
+{
+	switch (Token->GetType())
+	{
+	case ETokenType::Text:
+		{
+			FString Text = static_cast<const FTokenText*>(Token)->Text.Left(24).ReplaceCharWithEscapedChar();
+			return FString::Printf(TEXT("\"%s\""), *Text);
+		}
+	case ETokenType::Var:
+		return FString::Printf(TEXT("{$%s}"), *static_cast<const FTokenVar*>(Token)->Key);
+	case ETokenType::For:
+	case ETokenType::If:
+		return FString::Printf(TEXT("{%% %s %%}"), *static_cast<const FTokenNested*>(Token)->Expression.TrimStartAndEnd());
+	default:
+		return FString();
+	}
+}
+
+
+/* FSimpleTemplateProfile interface
+ *****************************************************************************/
+
+FString FSimpleTemplateProfile::ToString(int32 MaxTokens) const
+{
+	FString Result = FString::Printf(TEXT("%d renders, %.3f ms in tokens\n"), Renders, TotalTime);
+	Result += TEXT("  Heat    Self ms   Incl ms  Cond ms    Calls    Iters     Bytes  Location  Token\n");
+	for (int32 i = 0; i < Tokens.Num() && i < MaxTokens; i++)
+	{
+		const FSimpleTemplateTokenProfile& Token = Tokens[i];
+		const FString Location = Token.Line != INDEX_NONE ? FString::Printf(TEXT("%d:%d"), Token.Line + 1, Token.Column + 1) : TEXT("?");
+		Result += FString::Printf(TEXT("%5.1f%% %9.3f %9.3f %8.3f %8d %8d %9d  %-8s  %s\n"),
+			Token.Heat * 100.0f,
+			Token.SelfTime,
+			Token.InclusiveTime,
+			Token.ConditionTime,
+			Token.Calls,
+			Token.Iterations,
+			Token.OutputBytes,
+			*Location,
+			*Token.Token);
+	}
+	return Result;
+}
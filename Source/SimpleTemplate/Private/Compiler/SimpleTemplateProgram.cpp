@@ -0,0 +1,632 @@
+// Copyright Playspace S.L. 2017
+
+#include "Compiler/SimpleTemplateProgram.h"
+
+namespace SimpleTemplateProgram
+{
+	static bool HasStringOperand(EExpressionOp Type)
+	{
+		return Type == EExpressionOp::PushVar || Type == EExpressionOp::PushVarOrLiteral || Type == EExpressionOp::PushString;
+	}
+
+	/** Collects the sections of a program while walking a token tree */
+	class FProgramWriter
+	{
+	public:
+		void Add(const FTokenArray& Tokens)
+		{
+			for (const FTokenPtr& Token : Tokens.Items)
+			{
+				switch (Token->GetType())
+				{
+				case ETokenType::Text:
+					AddInstruction(ETemplateInstruction::Text, AddString(static_cast<const FTokenText*>(Token)->Text));
+					break;
+				case ETokenType::Var:
+				{
+					const FTokenVar* VarToken = static_cast<const FTokenVar*>(Token);
+					const int32 Index = AddInstruction(ETemplateInstruction::Var, AddString(VarToken->Key), (int32)VarToken->Escape, Filters.Num());
+					for (const FTemplateFilterCall& Call : VarToken->Filters)
+					{
+						FTemplateProgramFilter& Filter = Filters[Filters.AddUninitialized()];
+						Filter.Name = AddString(Call.Name);
+						Filter.Argument = AddString(Call.Argument);
+					}
+					Instructions[Index].End = VarToken->Filters.Num();
+					break;
+				}
+				case ETokenType::For:
+				{
+					const FTokenFor* ForToken = static_cast<const FTokenFor*>(Token);
+					const int32 Index = AddInstruction(ETemplateInstruction::For, AddString(ForToken->List), AddString(ForToken->Value));
+					Add(ForToken->Children);
+					Instructions[Index].End = Instructions.Num();
+					break;
+				}
+				case ETokenType::If:
+				{
+					const FTokenIf* IfToken = static_cast<const FTokenIf*>(Token);
+					const FTemplateExpression& Condition = IfToken->Condition;
+					const int32 FirstOp = ExpressionOps.Num();
+
+					// Pool indices become global, jumps stay relative to the condition
+					for (FExpressionOp Op : Condition.GetOps())
+					{
+						if (HasStringOperand(Op.Type))
+						{
+							Op.Operand = AddString(Condition.GetStrings()[Op.Operand]);
+						}
+						else if (Op.Type == EExpressionOp::PushNumber)
+						{
+							Op.Operand = Numbers.Add(Condition.GetNumbers()[Op.Operand]);
+						}
+						ExpressionOps.Add(Op);
+					}
+
+					const int32 Index = AddInstruction(ETemplateInstruction::If, FirstOp, Condition.GetOps().Num(), Condition.GetMaxStackDepth());
+					Add(IfToken->Children);
+					Instructions[Index].End = Instructions.Num();
+					break;
+				}
+				default:
+					// End tokens are not part of the tree
+					break;
+				}
+			}
+		}
+
+		void Write(TArray<uint8>& OutStorage) const
+		{
+			int32 NumChars = 0;
+			for (const FString& String : Strings)
+			{
+				NumChars += String.Len();
+			}
+
+			FTemplateProgramHeader Header;
+			FMemory::Memzero(Header);
+			Header.Magic = TPL_PROGRAM_MAGIC;
+			Header.Version = TPL_VERSION;
+			Header.CharSize = sizeof(TCHAR);
+
+			int32 Size = sizeof(FTemplateProgramHeader);
+			Header.NumNumbers = Numbers.Num();
+			Header.NumbersOffset = Reserve(Size, Numbers.Num() * sizeof(double));
+			Header.NumExpressionOps = ExpressionOps.Num();
+			Header.ExpressionOpsOffset = Reserve(Size, ExpressionOps.Num() * sizeof(FExpressionOp));
+			Header.NumInstructions = Instructions.Num();
+			Header.InstructionsOffset = Reserve(Size, Instructions.Num() * sizeof(FTemplateInstruction));
+			Header.NumFilters = Filters.Num();
+			Header.FiltersOffset = Reserve(Size, Filters.Num() * sizeof(FTemplateProgramFilter));
+			Header.NumStrings = Strings.Num();
+			Header.StringsOffset = Reserve(Size, Strings.Num() * sizeof(FTemplateProgramString));
+			Header.CharsOffset = Reserve(Size, NumChars * sizeof(TCHAR));
+			Header.Size = Size;
+
+			// Zeroed so padding does not make cooked data non deterministic
+			OutStorage.Reset(Size);
+			OutStorage.AddZeroed(Size);
+			uint8* Data = OutStorage.GetData();
+
+			FMemory::Memcpy(Data, &Header, sizeof(Header));
+			FMemory::Memcpy(Data + Header.NumbersOffset, Numbers.GetData(), Numbers.Num() * sizeof(double));
+			for (int32 i = 0; i < ExpressionOps.Num(); i++)
+			{
+				FExpressionOp* Op = reinterpret_cast<FExpressionOp*>(Data + Header.ExpressionOpsOffset) + i;
+				Op->Type = ExpressionOps[i].Type;
+				Op->Operand = ExpressionOps[i].Operand;
+			}
+			for (int32 i = 0; i < Instructions.Num(); i++)
+			{
+				FTemplateInstruction* Instruction = reinterpret_cast<FTemplateInstruction*>(Data + Header.InstructionsOffset) + i;
+				*Instruction = Instructions[i];
+			}
+			FMemory::Memcpy(Data + Header.FiltersOffset, Filters.GetData(), Filters.Num() * sizeof(FTemplateProgramFilter));
+
+			FTemplateProgramString* StringTable = reinterpret_cast<FTemplateProgramString*>(Data + Header.StringsOffset);
+			TCHAR* Chars = reinterpret_cast<TCHAR*>(Data + Header.CharsOffset);
+			int32 CharOffset = 0;
+			for (int32 i = 0; i < Strings.Num(); i++)
+			{
+				StringTable[i].Offset = CharOffset;
+				StringTable[i].Len = Strings[i].Len();
+				FMemory::Memcpy(Chars + CharOffset, *Strings[i], Strings[i].Len() * sizeof(TCHAR));
+				CharOffset += Strings[i].Len();
+			}
+		}
+
+	private:
+		int32 AddString(const FString& String)
+		{
+			const int32* Found = StringIndices.Find(String);
+			if (Found != nullptr)
+			{
+				return *Found;
+			}
+			const int32 Index = Strings.Add(String);
+			StringIndices.Add(String, Index);
+			return Index;
+		}
+
+		int32 AddInstruction(ETemplateInstruction Type, int32 First, int32 Second = 0, int32 Third = 0)
+		{
+			FTemplateInstruction Instruction;
+			FMemory::Memzero(Instruction);
+			Instruction.Type = Type;
+			Instruction.First = First;
+			Instruction.Second = Second;
+			Instruction.Third = Third;
+			return Instructions.Add(Instruction);
+		}
+
+		static int32 Reserve(int32& Size, int32 SectionSize)
+		{
+			const int32 Offset = Align(Size, TPL_PROGRAM_ALIGNMENT);
+			Size = Offset + SectionSize;
+			return Offset;
+		}
+
+	private:
+		TArray<FString> Strings;
+		TMap<FString, int32> StringIndices;
+		TArray<FTemplateInstruction> Instructions;
+		TArray<FExpressionOp> ExpressionOps;
+		TArray<double> Numbers;
+		TArray<FTemplateProgramFilter> Filters;
+	};
+
+	static bool IsSectionValid(const FTemplateProgramHeader& Header, int32 Offset, int32 Num, int32 ElementSize)
+	{
+		return Num >= 0 && Offset >= (int32)sizeof(FTemplateProgramHeader) && IsAligned(Offset, TPL_PROGRAM_ALIGNMENT)
+			&& (int64)Offset + (int64)Num * ElementSize <= Header.Size;
+	}
+
+	/** Check that every string lies within the characters at the end of the program */
+	static bool AreStringsValid(const FTemplateProgramHeader& Header, const FTemplateProgramString* Strings)
+	{
+		const int64 NumChars = (Header.Size - Header.CharsOffset) / sizeof(TCHAR);
+		for (int32 i = 0; i < Header.NumStrings; i++)
+		{
+			if (Strings[i].Offset < 0 || Strings[i].Len < 0 || (int64)Strings[i].Offset + Strings[i].Len > NumChars)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Check that the names and arguments of the filters are strings of the program */
+	static bool AreFiltersValid(const FTemplateProgramHeader& Header, const FTemplateProgramFilter* Filters)
+	{
+		for (int32 i = 0; i < Header.NumFilters; i++)
+		{
+			if (Filters[i].Name < 0 || Filters[i].Name >= Header.NumStrings || Filters[i].Argument < 0 || Filters[i].Argument >= Header.NumStrings)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Check the indices of all instructions, bodies have to nest within the body they are part of */
+	static bool AreInstructionsValid(const FTemplateProgramHeader& Header, const FTemplateInstruction* Instructions, const FExpressionOp* ExpressionOps)
+	{
+		auto IsString = [&Header](int32 Index)
+		{
+			return Index >= 0 && Index < Header.NumStrings;
+		};
+
+		TArray<int32, TInlineAllocator<16>> BodyEnds;
+		BodyEnds.Add(Header.NumInstructions);
+		for (int32 i = 0; i < Header.NumInstructions; i++)
+		{
+			while (i >= BodyEnds.Last())
+			{
+				BodyEnds.Pop(false);
+			}
+
+			const FTemplateInstruction& Instruction = Instructions[i];
+			switch (Instruction.Type)
+			{
+			case ETemplateInstruction::Text:
+				if (!IsString(Instruction.First))
+				{
+					return false;
+				}
+				break;
+			case ETemplateInstruction::Var:
+				if (!IsString(Instruction.First) || Instruction.Second < 0 || Instruction.Second > (int32)ETemplateEscape::Xml
+					|| Instruction.Third < 0 || Instruction.End < 0 || (int64)Instruction.Third + Instruction.End > Header.NumFilters)
+				{
+					return false;
+				}
+				break;
+			case ETemplateInstruction::For:
+				if (!IsString(Instruction.First) || !IsString(Instruction.Second) || Instruction.End <= i || Instruction.End > BodyEnds.Last())
+				{
+					return false;
+				}
+				BodyEnds.Add(Instruction.End);
+				break;
+			case ETemplateInstruction::If:
+				if (Instruction.First < 0 || Instruction.Second < 0 || (int64)Instruction.First + Instruction.Second > Header.NumExpressionOps
+					|| Instruction.End <= i || Instruction.End > BodyEnds.Last()
+					|| !FTemplateExpression::IsValid(ExpressionOps + Instruction.First, Instruction.Second, Header.NumStrings, Header.NumNumbers, Instruction.Third))
+				{
+					return false;
+				}
+				BodyEnds.Add(Instruction.End);
+				break;
+			default:
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+/* FTemplateProgram interface
+ *****************************************************************************/
+
+void FTemplateProgram::Build(const FTokenArray& Tokens)
+{
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Tokens);
+	Reset();
+
+	SimpleTemplateProgram::FProgramWriter Writer;
+	Writer.Add(Tokens);
+	Writer.Write(Storage);
+
+	verify(Initialize());
+}
+
+void FTemplateProgram::Serialize(FArchive& Ar)
+{
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Tokens);
+	if (Ar.IsLoading())
+	{
+		Reset();
+
+		// A single bulk read, the program is used in place afterwards
+		int32 Size = 0;
+		Ar << Size;
+		// Sizes past the end of the archive come from broken data, do not allocate them
+		const int64 TotalSize = Ar.TotalSize();
+		if (Size < (int32)sizeof(FTemplateProgramHeader) || Ar.IsError() || (TotalSize >= 0 && Size > TotalSize - Ar.Tell()))
+		{
+			Ar.SetError();
+			return;
+		}
+		Storage.AddUninitialized(Size);
+		Ar.Serialize(Storage.GetData(), Size);
+
+		if (Ar.IsError() || !Initialize())
+		{
+			Reset();
+		}
+	}
+	else
+	{
+		int32 Size = GetSize();
+		Ar << Size;
+		if (Size > 0)
+		{
+			Ar.Serialize(const_cast<uint8*>(GetData()), Size);
+		}
+	}
+}
+
+bool FTemplateProgram::InitializeView(const void* InData, int32 InSize)
+{
+	Reset();
+	if (InData == nullptr || !IsAligned(InData, TPL_PROGRAM_ALIGNMENT) || InSize < (int32)sizeof(FTemplateProgramHeader))
+	{
+		return false;
+	}
+
+	ExternalData = static_cast<const uint8*>(InData);
+	ExternalSize = InSize;
+	if (!Initialize())
+	{
+		Reset();
+		return false;
+	}
+	return true;
+}
+
+void FTemplateProgram::Reset()
+{
+	Storage.Empty();
+	ExternalData = nullptr;
+	ExternalSize = 0;
+	Keys.Empty();
+	Filters.Empty();
+}
+
+uint32 FTemplateProgram::GetCrc() const
+{
+	return IsValid() ? FCrc::MemCrc32(GetData(), GetSize()) : 0;
+}
+
+SIZE_T FTemplateProgram::GetAllocatedSize() const
+{
+	SIZE_T Size = Storage.GetAllocatedSize() + Keys.GetAllocatedSize() + Filters.GetAllocatedSize();
+	for (const FTemplateKey& Key : Keys)
+	{
+		Size += Key.GetAllocatedSize();
+	}
+	for (const FTemplateFilterCall& Filter : Filters)
+	{
+		Size += Filter.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FTemplateProgram::Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream) const
+{
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Interpreter);
+	if (IsValid())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_Interpret);
+#if STATS
+		const int64 OutputBegin = WriteStream.Tell();
+#endif
+		TTemplateCompilerHelper::PushScope(Context);
+		Run(Context, WriteStream, 0, GetHeader().NumInstructions);
+		TTemplateCompilerHelper::PopScope(Context);
+		TPL_RENDER_OUTPUT_STAT(Context, OutputBegin, WriteStream.Tell());
+	}
+}
+
+void FTemplateProgram::ToTokens(FTokenArray& OutTokens) const
+{
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Tokens);
+	OutTokens.Reset();
+	if (IsValid())
+	{
+		ToTokens(OutTokens.Items, OutTokens.GetArena(), 0, GetHeader().NumInstructions);
+	}
+}
+
+/* FTemplateProgram implementation
+ *****************************************************************************/
+
+bool FTemplateProgram::Initialize()
+{
+	using namespace SimpleTemplateProgram;
+
+	const int32 AvailableSize = Storage.Num() > 0 ? Storage.Num() : ExternalSize;
+	const FTemplateProgramHeader& Header = GetHeader();
+	if (Header.Magic != TPL_PROGRAM_MAGIC)
+	{
+		UE_LOG(LogSTE, Error, TEXT("Template program is invalid, it does not start with the program magic!"));
+		return false;
+	}
+	if (Header.Version != TPL_VERSION)
+	{
+		UE_LOG(LogSTE, Error, TEXT("Template program was written by version %u, this build reads version %u!"), (uint32)Header.Version, (uint32)TPL_VERSION);
+		return false;
+	}
+	if (Header.CharSize != sizeof(TCHAR))
+	{
+		UE_LOG(LogSTE, Error, TEXT("Template program was written with %u byte characters, this build uses %u byte characters!"), (uint32)Header.CharSize, (uint32)sizeof(TCHAR));
+		return false;
+	}
+	if (Header.Size > AvailableSize)
+	{
+		UE_LOG(LogSTE, Error, TEXT("Template program needs %d bytes but only %d are available!"), Header.Size, AvailableSize);
+		return false;
+	}
+
+	if (!IsSectionValid(Header, Header.NumbersOffset, Header.NumNumbers, sizeof(double))
+		|| !IsSectionValid(Header, Header.ExpressionOpsOffset, Header.NumExpressionOps, sizeof(FExpressionOp))
+		|| !IsSectionValid(Header, Header.InstructionsOffset, Header.NumInstructions, sizeof(FTemplateInstruction))
+		|| !IsSectionValid(Header, Header.FiltersOffset, Header.NumFilters, sizeof(FTemplateProgramFilter))
+		|| !IsSectionValid(Header, Header.StringsOffset, Header.NumStrings, sizeof(FTemplateProgramString))
+		|| !IsSectionValid(Header, Header.CharsOffset, 0, sizeof(TCHAR)))
+	{
+		UE_LOG(LogSTE, Error, TEXT("Template program has invalid sections!"));
+		return false;
+	}
+
+	// Every index is checked once here, rendering trusts them
+	const FTemplateInstruction* Instructions = GetInstructions();
+	const FExpressionOp* ExpressionOps = GetSection<FExpressionOp>(Header.ExpressionOpsOffset);
+	if (!AreStringsValid(Header, GetSection<FTemplateProgramString>(Header.StringsOffset)) || !AreInstructionsValid(Header, Instructions, ExpressionOps)
+		|| !AreFiltersValid(Header, GetSection<FTemplateProgramFilter>(Header.FiltersOffset)))
+	{
+		UE_LOG(LogSTE, Error, TEXT("Template program has invalid instructions!"));
+		return false;
+	}
+
+	// Copy out and split the strings used for lookups, text stays in the pool
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Tokens);
+	Keys.SetNum(Header.NumStrings);
+	for (int32 i = 0; i < Header.NumInstructions; i++)
+	{
+		const FTemplateInstruction& Instruction = Instructions[i];
+		switch (Instruction.Type)
+		{
+		case ETemplateInstruction::Var:
+			Keys[Instruction.First].Set(GetString(Instruction.First));
+			break;
+		case ETemplateInstruction::For:
+			Keys[Instruction.First].Set(GetString(Instruction.First));
+			Keys[Instruction.Second].Set(GetString(Instruction.Second));
+			break;
+		default:
+			break;
+		}
+	}
+
+	for (int32 i = 0; i < Header.NumExpressionOps; i++)
+	{
+		if (HasStringOperand(ExpressionOps[i].Type) && ExpressionOps[i].Operand >= 0 && ExpressionOps[i].Operand < Header.NumStrings)
+		{
+			Keys[ExpressionOps[i].Operand].Set(GetString(ExpressionOps[i].Operand));
+		}
+	}
+
+	// Filters are resolved once, rendering calls their functions
+	const FTemplateProgramFilter* ProgramFilters = GetSection<FTemplateProgramFilter>(Header.FiltersOffset);
+	Filters.SetNum(Header.NumFilters);
+	for (int32 i = 0; i < Header.NumFilters; i++)
+	{
+		Filters[i].Name = GetString(ProgramFilters[i].Name);
+		Filters[i].Argument = GetString(ProgramFilters[i].Argument);
+		const FString Error = FTemplateFilters::Resolve(Filters[i]);
+		if (!Error.IsEmpty())
+		{
+			UE_LOG(LogSTE, Error, TEXT("%s! The filter is skipped"), *Error);
+		}
+	}
+	return true;
+}
+
+void FTemplateProgram::Run(FTemplateCompilerContent& Context, FArchive& WriteStream, int32 Begin, int32 End) const
+{
+	const FTemplateProgramHeader& Header = GetHeader();
+	const FTemplateInstruction* Instructions = GetInstructions();
+
+	int32 Index = Begin;
+	while (Index < End)
+	{
+		const FTemplateInstruction& Instruction = Instructions[Index];
+		TPL_RENDER_STAT(Context, Tokens);
+		switch (Instruction.Type)
+		{
+		case ETemplateInstruction::Text:
+			WriteString(WriteStream, Instruction.First);
+			Index++;
+			break;
+		case ETemplateInstruction::Var:
+			TTemplateCompilerHelper::WriteValue(Context, Keys[Instruction.First], WriteStream, Filters.GetData() + Instruction.Third, Instruction.End, (ETemplateEscape)Instruction.Second);
+			Index++;
+			break;
+		case ETemplateInstruction::For:
+		{
+			const FString& ItemKey = Keys[Instruction.Second].Key;
+			const int32 BodyBegin = Index + 1;
+			const int32 BodyEnd = Instruction.End;
+
+			FTemplateLoopState LoopState;
+			TTemplateCompilerHelper::PushScope(Context);
+			TTemplateCompilerHelper::IterateList(Context, Keys[Instruction.First], [this, &Context, &WriteStream, &ItemKey, &LoopState, BodyBegin, BodyEnd](int32 i, const TSharedPtr<FJsonValue>& JsonItem, ISimpleTemplateDataSource* SourceItem)
+			{
+				TTemplateCompilerHelper::SetLoopItem(Context, LoopState, ItemKey, i, JsonItem, SourceItem);
+				Run(Context, WriteStream, BodyBegin, BodyEnd);
+			});
+			TTemplateCompilerHelper::PopScope(Context);
+			Index = Instruction.End;
+			break;
+		}
+		case ETemplateInstruction::If:
+		{
+			const FExpressionOp* Ops = GetSection<FExpressionOp>(Header.ExpressionOpsOffset) + Instruction.First;
+			const double* Numbers = GetSection<double>(Header.NumbersOffset);
+
+			TTemplateCompilerHelper::PushScope(Context);
+			if (FTemplateExpression::Evaluate(Context, Ops, Instruction.Second, Keys.GetData(), Numbers, Instruction.Third))
+			{
+				Run(Context, WriteStream, Index + 1, Instruction.End);
+			}
+			TTemplateCompilerHelper::PopScope(Context);
+			Index = Instruction.End;
+			break;
+		}
+		default:
+			Index++;
+			break;
+		}
+	}
+}
+
+void FTemplateProgram::ToTokens(TArray<FToken*>& OutTokens, FTokenArena& Arena, int32 Begin, int32 End) const
+{
+	using namespace SimpleTemplateProgram;
+
+	const FTemplateProgramHeader& Header = GetHeader();
+	const FTemplateInstruction* Instructions = GetInstructions();
+
+	int32 Index = Begin;
+	while (Index < End)
+	{
+		const FTemplateInstruction& Instruction = Instructions[Index];
+		switch (Instruction.Type)
+		{
+		case ETemplateInstruction::Text:
+			OutTokens.Add(Arena.New<FTokenText>(GetString(Instruction.First)));
+			Index++;
+			break;
+		case ETemplateInstruction::Var:
+		{
+			FTokenVar* VarToken = Arena.New<FTokenVar>(Keys[Instruction.First].Key);
+			VarToken->Escape = (ETemplateEscape)Instruction.Second;
+			VarToken->Filters.Append(Filters.GetData() + Instruction.Third, Instruction.End);
+			OutTokens.Add(VarToken);
+			Index++;
+			break;
+		}
+		case ETemplateInstruction::For:
+		{
+			FTokenFor* ForToken = Arena.New<FTokenFor>(FString::Printf(TEXT("%s %s in %s"), *TPL_START_FOR_TOKEN, *Keys[Instruction.Second].Key, *Keys[Instruction.First].Key));
+			ForToken->SetKeys(Keys[Instruction.First].Key, Keys[Instruction.Second].Key);
+			ToTokens(ForToken->Children.Items, Arena, Index + 1, Instruction.End);
+			OutTokens.Add(ForToken);
+			Index = Instruction.End;
+			break;
+		}
+		case ETemplateInstruction::If:
+		{
+			// Pool indices go back to be local to the condition
+			const FExpressionOp* Ops = GetSection<FExpressionOp>(Header.ExpressionOpsOffset) + Instruction.First;
+			const double* Numbers = GetSection<double>(Header.NumbersOffset);
+			TArray<FExpressionOp> LocalOps;
+			TArray<FString> LocalStrings;
+			TArray<double> LocalNumbers;
+			for (int32 i = 0; i < Instruction.Second; i++)
+			{
+				FExpressionOp Op = Ops[i];
+				if (HasStringOperand(Op.Type))
+				{
+					Op.Operand = LocalStrings.AddUnique(Keys[Op.Operand].Key);
+				}
+				else if (Op.Type == EExpressionOp::PushNumber)
+				{
+					Op.Operand = LocalNumbers.Add(Numbers[Op.Operand]);
+				}
+				LocalOps.Add(Op);
+			}
+
+			FTokenIf* IfToken = Arena.New<FTokenIf>(TPL_START_IF_TOKEN);
+			IfToken->Condition.Initialize(MoveTemp(LocalOps), MoveTemp(LocalStrings), MoveTemp(LocalNumbers), Instruction.Third);
+			ToTokens(IfToken->Children.Items, Arena, Index + 1, Instruction.End);
+			OutTokens.Add(IfToken);
+			Index = Instruction.End;
+			break;
+		}
+		default:
+			Index++;
+			break;
+		}
+	}
+}
+
+void FTemplateProgram::WriteString(FArchive& WriteStream, int32 Index) const
+{
+	const FTemplateProgramHeader& Header = GetHeader();
+	const FTemplateProgramString& String = GetSection<FTemplateProgramString>(Header.StringsOffset)[Index];
+	const TCHAR* Chars = GetSection<TCHAR>(Header.CharsOffset) + String.Offset;
+	WriteStream.Serialize(const_cast<TCHAR*>(Chars), String.Len * sizeof(TCHAR));
+}
+
+FString FTemplateProgram::GetString(int32 Index) const
+{
+	const FTemplateProgramHeader& Header = GetHeader();
+	const FTemplateProgramString& String = GetSection<FTemplateProgramString>(Header.StringsOffset)[Index];
+	if (String.Len == 0)
+	{
+		return FString();
+	}
+	return FString(String.Len, GetSection<TCHAR>(Header.CharsOffset) + String.Offset);
+}
@@ -0,0 +1,370 @@
+// Copyright Playspace S.L. 2017
+
+#include "Compiler/SimpleTemplateRenderCache.h"
+
+namespace
+{
+	bool OverlapsAny(const TArray<FString>& Paths, const FString& Path)
+	{
+		return Paths.ContainsByPredicate([&Path](const FString& DataPath)
+		{
+			return FTemplateDataPaths::Overlaps(DataPath, Path);
+		});
+	}
+}
+
+bool FTemplateRenderCache::Interpret(const FTokenArray& Tokens, FTemplateCompilerContent& Context, const TArray<FString>& ChangedPaths, FString& OutString)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_Interpret);
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Interpreter);
+
+	// A new token tree means the template got recompiled, we keep the arena alive so tokens can be compared
+	bool bFullRender = Arena != Tokens.Arena || Segments.Num() != Tokens.Items.Num();
+	for (int32 i = 0; !bFullRender && i < Segments.Num(); i++)
+	{
+		bFullRender = Segments[i].Token != Tokens.Items[i];
+	}
+
+	if (bFullRender)
+	{
+		Arena = Tokens.Arena;
+		Segments.Reset();
+		Rendered.Reset();
+		TArray<const FTokenFor*> Loops;
+		BuildSegments(Tokens, Loops, Segments);
+	}
+
+	TArray<FChange> Changes;
+	TArray<const FChange*> ChangePtrs;
+	Changes.Reserve(ChangedPaths.Num());
+	for (const FString& ChangedPath : ChangedPaths)
+	{
+		Changes.Add(NormalizePath(ChangedPath));
+	}
+	for (const FChange& Change : Changes)
+	{
+		ChangePtrs.Add(&Change);
+	}
+
+	TTemplateCompilerHelper::PushScope(Context);
+	RenderSegments(Segments, Rendered, Context, bFullRender ? nullptr : &ChangePtrs);
+	TTemplateCompilerHelper::PopScope(Context);
+
+	// Splice the segments
+	OutString.Reset(GetOutputLen(Segments, Rendered));
+	AppendOutput(Segments, Rendered, OutString);
+	return true;
+}
+
+
+bool FTemplateRenderCache::Interpret(const FTemplateProgram& Program, FTemplateCompilerContent& Context, const TArray<FString>& ChangedPaths, FString& OutString)
+{
+	const uint32 Crc = Program.GetCrc();
+	if (!ProgramTokens.Arena.IsValid() || Crc != ProgramCrc)
+	{
+		// The arena marks the tokens as built, empty programs have none of their own
+		Program.ToTokens(ProgramTokens);
+		ProgramTokens.GetArena();
+		ProgramCrc = Crc;
+	}
+	return Interpret(ProgramTokens, Context, ChangedPaths, OutString);
+}
+
+
+int32 FTemplateRenderCache::FChange::FindIndex(const FString& List) const
+{
+	for (const TPair<FString, int32>& Index : Indices)
+	{
+		if (Index.Key.Equals(List, ESearchCase::CaseSensitive))
+		{
+			return Index.Value;
+		}
+	}
+	return INDEX_NONE;
+}
+
+
+FTemplateRenderCache::FChange FTemplateRenderCache::NormalizePath(const FString& Path)
+{
+	FChange Change;
+
+	// Fields are appended straight from the path, numeric ones become '[]'
+	Change.Path.Reserve(Path.Len());
+	const TCHAR* Chars = *Path;
+	int32 Start = 0;
+	while (Start <= Path.Len())
+	{
+		int32 End = Start;
+		bool bNumeric = true;
+		while (End < Path.Len() && Chars[End] != TCHAR('.'))
+		{
+			bNumeric &= FChar::IsDigit(Chars[End]);
+			End++;
+		}
+
+		if (End > Start)
+		{
+			if (bNumeric && !Change.Path.IsEmpty())
+			{
+				Change.Indices.Emplace(Change.Path, FCString::Atoi(Chars + Start));
+				Change.Path += TEXT("[]");
+			}
+			else
+			{
+				if (!Change.Path.IsEmpty())
+				{
+					Change.Path += TEXT(".");
+				}
+				Change.Path.AppendChars(Chars + Start, End - Start);
+			}
+		}
+		Start = End + 1;
+	}
+	return Change;
+}
+
+
+void FTemplateRenderCache::BuildSegments(const FTokenArray& Tokens, TArray<const FTokenFor*>& Loops, TArray<FSegment>& OutSegments)
+{
+	// Keys read through the variables of the loops we are in are mapped to their lists
+	FTemplateDataPaths Scope(true);
+	for (const FTokenFor* Loop : Loops)
+	{
+		Scope.PushLoop(Loop->Value, Loop->List);
+	}
+
+	OutSegments.SetNum(Tokens.Items.Num());
+	for (int32 i = 0; i < Tokens.Items.Num(); i++)
+	{
+		FSegment& Segment = OutSegments[i];
+		Segment.Token = Tokens.Items[i];
+
+		// Operands that may be text are kept, the token renders again if such a key shows up
+		FTemplateDataPaths Paths = Scope;
+		Segment.Token->CollectDataPaths(Paths);
+		Segment.DataPaths = MoveTemp(Paths.Paths);
+
+		if (Segment.Token->GetType() == ETokenType::If)
+		{
+			const FTokenIf* IfToken = static_cast<const FTokenIf*>(Segment.Token);
+			FTemplateDataPaths ConditionPaths = Scope;
+			IfToken->CollectConditionPaths(ConditionPaths);
+			Segment.ConditionPaths = MoveTemp(ConditionPaths.Paths);
+			BuildSegments(IfToken->Children, Loops, Segment.Children);
+		}
+		else if (Segment.Token->GetType() == ETokenType::For)
+		{
+			const FTokenFor* ForToken = static_cast<const FTokenFor*>(Segment.Token);
+			Segment.List = Scope.ResolveKey(ForToken->List);
+			Loops.Push(ForToken);
+			BuildSegments(ForToken->Children, Loops, Segment.Children);
+			Loops.Pop();
+		}
+	}
+}
+
+
+void FTemplateRenderCache::RenderSegments(const TArray<FSegment>& InSegments, TArray<FRendered>& InRendered, FTemplateCompilerContent& Context, const TArray<const FChange*>* Changes)
+{
+	// Branches and loop items that were not rendered before have no output yet
+	if (InRendered.Num() != InSegments.Num())
+	{
+		InRendered.Reset();
+		InRendered.SetNum(InSegments.Num());
+		Changes = nullptr;
+	}
+
+	TArray<const FChange*> SegmentChanges;
+	for (int32 i = 0; i < InSegments.Num(); i++)
+	{
+		const FSegment& Segment = InSegments[i];
+		if (Changes == nullptr)
+		{
+			RenderSegment(Segment, InRendered[i], Context, nullptr);
+			continue;
+		}
+
+		SegmentChanges.Reset();
+		for (const FChange* Change : *Changes)
+		{
+			if (OverlapsAny(Segment.DataPaths, Change->Path))
+			{
+				SegmentChanges.Add(Change);
+			}
+		}
+		if (SegmentChanges.Num() > 0)
+		{
+			RenderSegment(Segment, InRendered[i], Context, &SegmentChanges);
+		}
+	}
+}
+
+
+void FTemplateRenderCache::RenderSegment(const FSegment& Segment, FRendered& Render, FTemplateCompilerContent& Context, const TArray<const FChange*>* Changes)
+{
+	switch (Segment.Token->GetType())
+	{
+	case ETokenType::Text:
+		// Written from the token when splicing
+		break;
+
+	case ETokenType::If:
+	{
+		// The condition is only evaluated again if it reads a changed path, a branch that got
+		// taken now renders all of its children
+		const FTokenIf* IfToken = static_cast<const FTokenIf*>(Segment.Token);
+		TTemplateCompilerHelper::PushScope(Context);
+		if (Changes == nullptr || Changes->ContainsByPredicate([&Segment](const FChange* Change) { return OverlapsAny(Segment.ConditionPaths, Change->Path); }))
+		{
+			Render.bCondition = IfToken->Condition.Evaluate(Context);
+		}
+		if (Render.bCondition)
+		{
+			RenderSegments(Segment.Children, Render.Children, Context, Changes);
+		}
+		else
+		{
+			Render.Children.Reset();
+		}
+		TTemplateCompilerHelper::PopScope(Context);
+		break;
+	}
+
+	case ETokenType::For:
+	{
+		// Changes of items only render those items, changes of the list render all of them and
+		// other changes are data outside the list read by every item
+		const FTokenFor* ForToken = static_cast<const FTokenFor*>(Segment.Token);
+		bool bAllItems = Changes == nullptr;
+		TArray<const FChange*> BodyChanges;
+		TArray<TPair<int32, const FChange*>> ItemChanges;
+		for (int32 i = 0; !bAllItems && i < Changes->Num(); i++)
+		{
+			const FChange* Change = (*Changes)[i];
+			const int32 Index = Change->FindIndex(Segment.List);
+			if (Index != INDEX_NONE)
+			{
+				ItemChanges.Emplace(Index, Change);
+			}
+			else if (FTemplateDataPaths::Overlaps(Segment.List, Change->Path))
+			{
+				bAllItems = true;
+			}
+			else
+			{
+				BodyChanges.Add(Change);
+			}
+		}
+
+		int32 NumItems = 0;
+		FTemplateLoopState LoopState;
+		TArray<const FChange*> Scratch;
+		TTemplateCompilerHelper::PushScope(Context);
+		TTemplateCompilerHelper::IterateList(Context, ForToken->SplitList, [this, &Segment, &Render, &Context, ForToken, bAllItems, &BodyChanges, &ItemChanges, &Scratch, &NumItems, &LoopState](int32 Index, const TSharedPtr<FJsonValue>& JsonItem, ISimpleTemplateDataSource* SourceItem)
+		{
+			NumItems = Index + 1;
+			if (!Render.Items.IsValidIndex(Index))
+			{
+				Render.Items.SetNum(Index + 1);
+			}
+
+			Scratch = BodyChanges;
+			for (const TPair<int32, const FChange*>& ItemChange : ItemChanges)
+			{
+				if (ItemChange.Key == Index)
+				{
+					Scratch.Add(ItemChange.Value);
+				}
+			}
+
+			TArray<FRendered>& Item = Render.Items[Index];
+			if (bAllItems || Scratch.Num() > 0 || Item.Num() != Segment.Children.Num())
+			{
+				TTemplateCompilerHelper::SetLoopItem(Context, LoopState, ForToken->Value, Index, JsonItem, SourceItem);
+				RenderSegments(Segment.Children, Item, Context, bAllItems ? nullptr : &Scratch);
+			}
+		});
+		TTemplateCompilerHelper::PopScope(Context);
+		Render.Items.SetNum(NumItems);
+		break;
+	}
+
+	default:
+		Render.Output = RenderToString(Context, [&Segment, &Context](FArchive& WriteStream)
+		{
+			Segment.Token->Interpret(Context, WriteStream, Context.DynamicScope);
+		});
+		break;
+	}
+}
+
+
+FString FTemplateRenderCache::RenderToString(FTemplateCompilerContent& Context, TFunctionRef<void(FArchive& WriteStream)> Render)
+{
+	Buffer.Reset();
+	FMemoryWriter WriteStream(Buffer);
+	Render(WriteStream);
+	TPL_RENDER_OUTPUT_STAT(Context, 0, Buffer.Num());
+	return FString(Buffer.Num() / sizeof(TCHAR), reinterpret_cast<const TCHAR*>(Buffer.GetData()));
+}
+
+
+int32 FTemplateRenderCache::GetOutputLen(const TArray<FSegment>& InSegments, const TArray<FRendered>& InRendered)
+{
+	int32 Len = 0;
+	for (int32 i = 0; i < InSegments.Num(); i++)
+	{
+		const FSegment& Segment = InSegments[i];
+		const FRendered& Render = InRendered[i];
+		switch (Segment.Token->GetType())
+		{
+		case ETokenType::Text:
+			Len += static_cast<const FTokenText*>(Segment.Token)->Text.Len();
+			break;
+		case ETokenType::If:
+			Len += Render.bCondition ? GetOutputLen(Segment.Children, Render.Children) : 0;
+			break;
+		case ETokenType::For:
+			for (const TArray<FRendered>& Item : Render.Items)
+			{
+				Len += GetOutputLen(Segment.Children, Item);
+			}
+			break;
+		default:
+			Len += Render.Output.Len();
+			break;
+		}
+	}
+	return Len;
+}
+
+
+void FTemplateRenderCache::AppendOutput(const TArray<FSegment>& InSegments, const TArray<FRendered>& InRendered, FString& OutString)
+{
+	for (int32 i = 0; i < InSegments.Num(); i++)
+	{
+		const FSegment& Segment = InSegments[i];
+		const FRendered& Render = InRendered[i];
+		switch (Segment.Token->GetType())
+		{
+		case ETokenType::Text:
+			OutString += static_cast<const FTokenText*>(Segment.Token)->Text;
+			break;
+		case ETokenType::If:
+			if (Render.bCondition)
+			{
+				AppendOutput(Segment.Children, Render.Children, OutString);
+			}
+			break;
+		case ETokenType::For:
+			for (const TArray<FRendered>& Item : Render.Items)
+			{
+				AppendOutput(Segment.Children, Item, OutString);
+			}
+			break;
+		default:
+			OutString += Render.Output;
+			break;
+		}
+	}
+}
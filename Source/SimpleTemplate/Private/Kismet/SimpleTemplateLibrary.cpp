@@ -4,6 +4,7 @@
 #include "Serialization/JsonTypes.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
+#include "SimpleTemplatePropertyDataSource.h"
 
 USimpleTemplateData* USimpleTemplateLibrary::NewDataProvider(const FString& Data)
 {
@@ -12,6 +13,13 @@ USimpleTemplateData* USimpleTemplateLibrary::NewDataProvider(const FString& Data
 	return DataProvider;
 }
 
+USimpleTemplateObjectData* USimpleTemplateLibrary::NewObjectDataProvider(UObject* Object)
+{
+	USimpleTemplateObjectData* DataProvider = NewObject<USimpleTemplateObjectData>();
+	DataProvider->SetSourceObject(Object);
+	return DataProvider;
+}
+
 FString USimpleTemplateLibrary::Interpret_FromProvider(USimpleTemplate* SimpleTemplate, TScriptInterface<ISimpleTemplateDataProvider> DataProvider)
 {
 	return SimpleTemplate->Interpret(DataProvider);
@@ -28,15 +36,33 @@ FString USimpleTemplateLibrary::Interpret_FromJSONString(USimpleTemplate* Simple
 	return FString();
 }
 
+FString USimpleTemplateLibrary::Interpret_FromObject(USimpleTemplate* SimpleTemplate, UObject* Object)
+{
+	if (Object != nullptr)
+	{
+		FSimpleTemplatePropertyDataSource DataSource(Object);
+		return SimpleTemplate->Interpret(DataSource);
+	}
+	return FString();
+}
+
+FString USimpleTemplateLibrary::InterpretIncremental_FromProvider(USimpleTemplate* SimpleTemplate, TScriptInterface<ISimpleTemplateDataProvider> DataProvider, const TArray<FString>& ChangedPaths, FSimpleTemplateRenderState& RenderState)
+{
+	if (!RenderState.Cache.IsValid())
+	{
+		RenderState.Cache = MakeShareable(new FTemplateRenderCache());
+	}
+	return SimpleTemplate->InterpretIncremental(DataProvider, ChangedPaths, *RenderState.Cache);
+}
+
 FString USimpleTemplateLibrary::CompileAndInterpret_FromProvider(const FString& Template, TScriptInterface<ISimpleTemplateDataProvider> DataProvider)
 {
 	auto compiler = TTemplateCompilerFactory<TCHAR>::Create(Template);
 	if (compiler->Compile())
 	{
-		FTokenArray Tokens = compiler->GetTokenTree();
-		auto interpreter = TTemplateInterpreter::Create(Tokens);
+		TTemplateInterpreter Interpreter(compiler->GetTokenTree());
 		FString OutString;
-		if (interpreter->Interpret(OutString, DataProvider))
+		if (Interpreter.Interpret(OutString, DataProvider))
 		{
 			return OutString;
 		}
@@ -53,10 +79,9 @@ FString USimpleTemplateLibrary::CompileAndInterpret_FromString(const FString& Te
 		auto compiler = TTemplateCompilerFactory<TCHAR>::Create(Template);
 		if (compiler->Compile())
 		{
-			FTokenArray Tokens = compiler->GetTokenTree();
-			auto interpreter = TTemplateInterpreter::Create(Tokens);
+			TTemplateInterpreter Interpreter(compiler->GetTokenTree());
 			FString OutString;
-			if (interpreter->Interpret(OutString, JsonPtr))
+			if (Interpreter.Interpret(OutString, JsonPtr))
 			{
 				return OutString;
 			}
@@ -73,6 +98,7 @@ USimpleTemplate* USimpleTemplateLibrary::Compile(const FString& Template)
 	{
 		auto SimpleTemplate = NewObject<USimpleTemplate>();
 		SimpleTemplate->Tokens = compiler->GetTokenTree();
+		SimpleTemplate->UpdateDataPaths();
 		return SimpleTemplate;
 	}
 	return nullptr;
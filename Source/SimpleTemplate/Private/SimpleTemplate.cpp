@@ -1,6 +1,89 @@
 // Copyright Playspace S.L. 2017
 
 #include "SimpleTemplate.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/UObjectIterator.h"
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#include "Misc/SecureHash.h"
+
+// Change to invalidate the compiled templates in the derived data cache without changing TPL_VERSION
+#define SIMPLETEMPLATE_DERIVEDDATA_VER TEXT("4B1D2A6E8C0F4E7BA3D95F2C61E0B7A4")
+
+// The cache takes the name of the data for its logs since 4.26
+#if ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 26
+#define TPL_DDC_CONTEXT(Template) , Template->GetPathName()
+#else
+#define TPL_DDC_CONTEXT(Template)
+#endif
+#endif
+
+namespace SimpleTemplateFallback
+{
+	// Telemetry of outdated cooked templates, see USimpleTemplate::GetFallbackCompileCounts
+	static FThreadSafeCounter FallbackCompiles;
+	static FThreadSafeCounter FallbackCompileFailures;
+}
+
+static TAutoConsoleVariable<int32> CVarDeferredLoad(
+	TEXT("SimpleTemplate.DeferredLoad"),
+	0,
+	TEXT("Keep the compiled data of loaded templates serialized until they are rendered.\n")
+	TEXT("0: Load the compiled data with the template (default)\n")
+	TEXT("1: Load the compiled data on first render or PreloadAsync"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarNative(
+	TEXT("SimpleTemplate.Native"),
+	1,
+	TEXT("Render templates with their transpiled C++ function if there is one.\n")
+	TEXT("0: Always interpret\n")
+	TEXT("1: Use native functions (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFallbackCompile(
+	TEXT("SimpleTemplate.FallbackCompile"),
+	1,
+	TEXT("Compile templates cooked with another template version from their cooked source, see SimpleTemplate.CookSource.\n")
+	TEXT("0: Outdated templates render nothing\n")
+	TEXT("1: Compile them on first use or PreloadAsync (default)"),
+	ECVF_Default);
+
+#if WITH_EDITOR
+static TAutoConsoleVariable<int32> CVarCookSource(
+	TEXT("SimpleTemplate.CookSource"),
+	0,
+	TEXT("Keep the source of templates in cooked data, so a build with another template version can compile them.\n")
+	TEXT("0: Only cook the compiled data (default)\n")
+	TEXT("1: Cook the source and the source of included templates too"),
+	ECVF_Default);
+#endif
+
+static TAutoConsoleVariable<int32> CVarDerivedData(
+	TEXT("SimpleTemplate.DerivedDataCache"),
+	1,
+	TEXT("Fetch compiled templates from the derived data cache in the editor.\n")
+	TEXT("0: Always compile\n")
+	TEXT("1: Use the derived data cache (default)"),
+	ECVF_Default);
+
+#if WITH_EDITOR
+static TAutoConsoleVariable<int32> CVarIncrementalCompile(
+	TEXT("SimpleTemplate.IncrementalCompile"),
+	1,
+	TEXT("Background compiles while editing reuse the tokens of the last compile.\n")
+	TEXT("0: Tokenize the whole source\n")
+	TEXT("1: Only tokenize the edited part of the source again (default)"),
+	ECVF_Default);
+#endif
 
 void USimpleTemplate::Serialize(FArchive& Ar)
 {
@@ -9,64 +92,610 @@ void USimpleTemplate::Serialize(FArchive& Ar)
 	// Serialize token array
 	if (Ar.IsLoading())
 	{
+		bNativeResolved = false;
+
 		int64 EndOffset = 0;
 		Ar << EndOffset;
 
 		uint32 TemplateVersion;
 		Ar << TemplateVersion;
 
-		if (TemplateVersion != TPL_VERSION)
+		const bool bOutdated = TemplateVersion != TPL_VERSION;
+		if (bOutdated)
 		{
-			UE_LOG(LogSTE, Error, TEXT("Serialized template version is incompatible with your current version! Need to recompile!"));
 			Status = ETemplateStatus::TS_Dirty;
 
 			// Skip over the data
 			Ar.Seek(EndOffset);
 		}
+		else if (CVarDeferredLoad.GetValueOnAnyThread() != 0)
+		{
+			// Keep the data as it is, most templates are never rendered
+			FScopeLock Lock(&PendingDataLock);
+			Tokens.Reset();
+			ResetProgram();
+			PendingData.SetNumUninitialized(EndOffset - Ar.Tell());
+			Ar.Serialize(PendingData.GetData(), PendingData.Num());
+			PendingCustomVersions = Ar.GetCustomVersions();
+			PendingUE4Ver = Ar.UE4Ver();
+			PendingLicenseeUE4Ver = Ar.LicenseeUE4Ver();
+			bPendingByteSwapping = Ar.IsByteSwapping();
+			bHasPendingData = true;
+		}
+		else if (!SerializeCompiledData(Ar, true))
+		{
+			Ar.Seek(EndOffset);
+		}
+
+		// The cooked source follows the compiled data from version 8 on, it has to stay readable by any later version
+		FallbackSource.Reset();
+		bNeedsFallbackCompile = false;
+		if (TemplateVersion >= 8)
+		{
+			bool bHasFallbackSource = false;
+			Ar << bHasFallbackSource;
+			if (bHasFallbackSource)
+			{
+				FallbackSource = MakeUnique<FSimpleTemplateFallbackSource>();
+				Ar << *FallbackSource;
+			}
+		}
+
+		// Deferred data is checked once it is loaded
+		if (FallbackSource.IsValid() && CVarFallbackCompile.GetValueOnAnyThread() != 0 && (bHasPendingData || IsPossiblyDirty()))
+		{
+			bNeedsFallbackCompile = true;
+		}
 		else
 		{
-			Tokens.Serialize(Ar);
+			FallbackSource.Reset();
+			if (bOutdated)
+			{
+				UE_LOG(LogSTE, Error, TEXT("Serialized template version is incompatible with your current version! Need to recompile!"));
+			}
 		}
 	}
 	else if (Ar.IsSaving())
 	{
+#if WITH_EDITOR
+		// Fails the save of the package, the cooker reports it
+		if (Ar.IsCooking() && !CookError.IsEmpty())
+		{
+			UE_LOG(LogSTE, Error, TEXT("%s can not be cooked, %s"), *GetPathName(), *CookError);
+			Ar.SetError();
+		}
+#endif
+		EnsureLoaded();
+
 		int64 SkipOffset = Ar.Tell();
 		// We have to serialize the placeholder value to count the real end offset
 		Ar << SkipOffset;
 
 		// Write the template version first
 		Ar << TPL_VERSION;
-		Tokens.Serialize(Ar);
+
+		// Cooked templates store the flat program, it loads with a single read. The program is written
+		// in the byte order of the cooking machine so byte swapped targets keep the token tree.
+		bool bFlatProgram = Program.IsValid() || (Ar.IsCooking() && !Ar.IsByteSwapping());
+		Ar << bFlatProgram;
+		if (Program.IsValid())
+		{
+			Program.Serialize(Ar);
+		}
+		else if (bFlatProgram)
+		{
+			FTemplateProgram CookedProgram;
+			CookedProgram.Build(Tokens);
+			CookedProgram.Serialize(Ar);
+		}
+		else
+		{
+			Tokens.Serialize(Ar);
+		}
 
 		// Set back to inject the offset to the end of the serialization, this way we can skip the data alltogether
 		int64 EndOffset = Ar.Tell();
 		Ar.Seek(SkipOffset);
 		Ar << EndOffset;
 		Ar.Seek(EndOffset);
+
+		bool bHasFallbackSource = Ar.IsCooking() && FallbackSource.IsValid();
+		Ar << bHasFallbackSource;
+		if (bHasFallbackSource)
+		{
+			Ar << *FallbackSource;
+		}
 	}
 }
 
+bool USimpleTemplate::SerializeCompiledData(FArchive& Ar, bool bUpdateDataPaths)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_Deserialize);
+	TPL_SCOPE_TEMPLATE(this);
+
+	bool bFlatProgram = false;
+	Ar << bFlatProgram;
+
+	Tokens.Reset();
+	ResetProgram();
+	if (bFlatProgram)
+	{
+		// Cooked data, rendered in place from the program
+		Program.Serialize(Ar);
+		if (!Program.IsValid())
+		{
+			UE_LOG(LogSTE, Warning, TEXT("%s has a cooked program this build can not read, it needs to be compiled again"), *GetPathName());
+			Status = ETemplateStatus::TS_Dirty;
+			return false;
+		}
+	}
+	else
+	{
+		Tokens.Serialize(Ar);
+		if (bUpdateDataPaths && DataPaths.Num() == 0)
+		{
+			UpdateDataPaths();
+		}
+	}
+	return true;
+}
+
+void USimpleTemplate::EnsureLoaded()
+{
+	if (bHasPendingData)
+	{
+		FScopeLock Lock(&PendingDataLock);
+		if (bHasPendingData)
+		{
+			// Data paths are left alone, they might be read by other threads
+			if (!InitializeProgramView())
+			{
+				FMemoryReader Reader(PendingData, true);
+				Reader.SetUE4Ver(PendingUE4Ver);
+				Reader.SetLicenseeUE4Ver(PendingLicenseeUE4Ver);
+				Reader.SetCustomVersions(PendingCustomVersions);
+				Reader.SetByteSwapping(bPendingByteSwapping);
+				SerializeCompiledData(Reader, false);
+			}
+			PendingData.Empty();
+			PendingCustomVersions.Empty();
+			bHasPendingData = false;
+		}
+	}
+	CompileFallbackSource();
+
+	// Pairs with the flags cleared once the compiled data is published, threads that did not
+	// take the lock see the data written by the thread that loaded or compiled it
+	FPlatformMisc::MemoryBarrier();
+}
+
+bool USimpleTemplate::InitializeProgramView()
+{
+	// Programs cooked in the byte order of this machine are used where they were loaded to instead of being copied
+	if (bPendingByteSwapping)
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(PendingData, true);
+	bool bFlatProgram = false;
+	int32 Size = 0;
+	Reader << bFlatProgram;
+	Reader << Size;
+	const uint8* Data = PendingData.GetData() + Reader.Tell();
+	if (Reader.IsError() || !bFlatProgram || Size <= 0 || Reader.Tell() + Size > PendingData.Num() || !IsAligned(Data, TPL_PROGRAM_ALIGNMENT))
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_Deserialize);
+	Tokens.Reset();
+	ResetProgram();
+
+	// Moving the array keeps its allocation, the view stays valid
+	ProgramData = MoveTemp(PendingData);
+	if (!Program.InitializeView(Data, Size))
+	{
+		UE_LOG(LogSTE, Warning, TEXT("%s has a cooked program this build can not read, it needs to be compiled again"), *GetPathName());
+		ResetProgram();
+		Status = ETemplateStatus::TS_Dirty;
+	}
+	return true;
+}
+
+void USimpleTemplate::ResetProgram()
+{
+	Program.Reset();
+	ProgramData.Empty();
+}
+
+void USimpleTemplate::CompileFallbackSource()
+{
+	if (bNeedsFallbackCompile)
+	{
+		FScopeLock Lock(&PendingDataLock);
+		if (bNeedsFallbackCompile)
+		{
+			// Workers only see the path taken by PreloadAsync, without it the compile waits for the game thread
+			if (FallbackPath.IsEmpty())
+			{
+				if (!IsInGameThread())
+				{
+					return;
+				}
+				FallbackPath = GetPathName();
+				FallbackStatId = TPL_TEMPLATE_STAT_ID(this);
+			}
+
+			// Deferred data might have turned out to be valid
+			if (IsPossiblyDirty())
+			{
+				SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_FallbackCompile);
+				TPL_SCOPE_TEMPLATE_NAMED(FallbackStatId, FallbackPath);
+				const double StartTime = FPlatformTime::Seconds();
+
+				const FSimpleTemplateFallbackSource& Fallback = *FallbackSource;
+				auto compiler = TTemplateCompilerFactory<TCHAR>::Create(Fallback.Source);
+				compiler->SetDefaultEscape(Fallback.Escape);
+				compiler->SetStripBlocks(Fallback.bStripBlocks);
+				compiler->SetIncludeResolver([&Fallback](const FString& Name, const FString& IncludingPath, FString& OutPath, FString& OutSource)
+				{
+					OutPath = GetIncludePath(Name, FPackageName::GetLongPackagePath(IncludingPath));
+					const FString* Found = Fallback.Includes.Find(OutPath);
+					if (Found == nullptr)
+					{
+						return false;
+					}
+					OutSource = *Found;
+					return true;
+				}, FallbackPath);
+
+				// Built aside and published at once below
+				const bool bSuccess = compiler->Compile();
+				FTokenArray CompiledTokens;
+				TArray<FString> CompiledDataPaths;
+				if (bSuccess)
+				{
+					CompiledTokens = compiler->GetTokenTree();
+					CompiledDataPaths = CollectDataPaths(CompiledTokens);
+					SimpleTemplateFallback::FallbackCompiles.Increment();
+					INC_DWORD_STAT(STAT_SimpleTemplate_FallbackCompiles);
+					UE_LOG(LogSTE, Log, TEXT("%s was cooked with another template version, compiled it from its source in %.2f ms"), *FallbackPath, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+				}
+				else
+				{
+					SimpleTemplateFallback::FallbackCompileFailures.Increment();
+					INC_DWORD_STAT(STAT_SimpleTemplate_FallbackCompileFailures);
+					UE_LOG(LogSTE, Error, TEXT("%s was cooked with another template version and its source failed to compile (%d:%d): %s"),
+						*FallbackPath, compiler->GetLineNumber(), compiler->GetCharNumber(), *compiler->GetLastError());
+				}
+
+				if (bSuccess)
+				{
+					Tokens = MoveTemp(CompiledTokens);
+					ResetProgram();
+					DataPaths = MoveTemp(CompiledDataPaths);
+					bNativeResolved = false;
+				}
+				Status = bSuccess ? ETemplateStatus::TS_UpToDate : ETemplateStatus::TS_Error;
+			}
+			FallbackSource.Reset();
+
+			// Cleared last, threads checking it without the lock see the published data, see EnsureLoaded
+			bNeedsFallbackCompile = false;
+		}
+	}
+}
+
+void USimpleTemplate::GetFallbackCompileCounts(int32& OutCompiles, int32& OutFailures)
+{
+	OutCompiles = SimpleTemplateFallback::FallbackCompiles.GetValue();
+	OutFailures = SimpleTemplateFallback::FallbackCompileFailures.GetValue();
+}
+
+void USimpleTemplate::ResolveNative()
+{
+	// Modules with native code register and unregister their functions while we hold one
+	const int32 Generation = FTemplateNativeRegistry::GetGeneration();
+	if (!bNativeResolved || NativeGeneration.GetValue() != Generation)
+	{
+		FScopeLock Lock(&PendingDataLock);
+		if (!bNativeResolved || NativeGeneration.GetValue() != Generation)
+		{
+			NativeFunction = nullptr;
+			if (FTemplateNativeRegistry::HasFunctions())
+			{
+				// Native code is matched by the crc of the program, templates compiled in the editor build it once
+				uint32 ProgramCrc = Program.GetCrc();
+				if (!Program.IsValid())
+				{
+					FTemplateProgram TokensProgram;
+					TokensProgram.Build(Tokens);
+					ProgramCrc = TokensProgram.GetCrc();
+				}
+				NativeFunction = FTemplateNativeRegistry::Find(GetPathName(), ProgramCrc);
+			}
+			NativeGeneration.Set(Generation);
+			bNativeResolved = true;
+		}
+	}
+}
+
+void USimpleTemplate::PreloadAsync()
+{
+	if ((bHasPendingData || bNeedsFallbackCompile) && (!PendingLoad.IsValid() || PendingLoad.IsReady()))
+	{
+		// The worker must not touch the object to name it
+		if (bNeedsFallbackCompile)
+		{
+			FScopeLock Lock(&PendingDataLock);
+			FallbackPath = GetPathName();
+			FallbackStatId = TPL_TEMPLATE_STAT_ID(this);
+		}
+		PendingLoad = Async<void>(EAsyncExecution::ThreadPool, [this]()
+		{
+			EnsureLoaded();
+		});
+	}
+}
+
+void USimpleTemplate::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+#if WITH_EDITOR
+	// Compiled by BeginCacheForCookedPlatformData, nothing is loaded while the package is saved
+	if (TargetPlatform != nullptr && CookError.IsEmpty() && !IsUpToDate())
+	{
+		CookError = TEXT("it is not compiled");
+	}
+#endif
+}
+
+#if WITH_EDITOR
+void USimpleTemplate::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+	Super::BeginCacheForCookedPlatformData(TargetPlatform);
+
+	// Cooking a template that is not compiled would ship a template rendering nothing
+	CookError.Reset();
+	FallbackSource.Reset();
+	if ((!IsUpToDate() || !AreIncludesUpToDate()) && !CompileSource(false))
+	{
+		CookError = FString::Printf(TEXT("it failed to compile: %s"), LastErrors.Num() > 0 ? *LastErrors[0] : TEXT(""));
+		return;
+	}
+
+	// The source is only written to cooked data, see Serialize
+	if (CVarCookSource.GetValueOnGameThread() != 0)
+	{
+		FallbackSource = MakeUnique<FSimpleTemplateFallbackSource>();
+		FallbackSource->Source = Template.ToString();
+		FallbackSource->Escape = Escape;
+		FallbackSource->bStripBlocks = bStripBlockWhitespace;
+
+		// Nested includes are listed too, by the path they resolved to from the template including them
+		for (const FSimpleTemplateInclude& Include : Includes)
+		{
+			USimpleTemplate* Included = Cast<USimpleTemplate>(Include.Template.TryLoad());
+			if (Included == nullptr)
+			{
+				CookError = FString::Printf(TEXT("the included template %s is missing"), *Include.Template.ToString());
+				FallbackSource.Reset();
+				return;
+			}
+			FallbackSource->Includes.Add(Include.Template.ToString(), Included->Template.ToString());
+		}
+	}
+}
+
+void USimpleTemplate::ClearAllCachedCookedPlatformData()
+{
+	Super::ClearAllCachedCookedPlatformData();
+
+	CookError.Reset();
+	FallbackSource.Reset();
+}
+#endif
+
+void USimpleTemplate::PostLoad()
+{
+	Super::PostLoad();
+
+	// Outdated cooked data is compiled from its source on a worker, the first render only waits if it is not done yet
+	if (bNeedsFallbackCompile && FPlatformProcess::SupportsMultithreading())
+	{
+		PreloadAsync();
+	}
+
+#if WITH_EDITOR
+	// An included template was changed while we were not loaded. Loading it from here would load
+	// packages in the middle of our load, so it is checked on the game thread once loading is done.
+	if (GIsEditor && IsUpToDate() && Includes.Num() > 0)
+	{
+		TWeakObjectPtr<USimpleTemplate> WeakThis(this);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis]()
+		{
+			USimpleTemplate* This = WeakThis.Get();
+			if (This != nullptr && This->IsUpToDate() && !This->AreIncludesUpToDate())
+			{
+				UE_LOG(LogSTE, Warning, TEXT("%s includes a template that changed! Need to recompile!"), *This->GetPathName());
+				This->Status = ETemplateStatus::TS_Dirty;
+			}
+		});
+	}
+#endif
+}
+
+void USimpleTemplate::BeginDestroy()
+{
+	// Wait for the preload, it uses us
+	if (PendingLoad.IsValid())
+	{
+		PendingLoad.Wait();
+		PendingLoad.Reset();
+	}
+	Super::BeginDestroy();
+}
+
+void USimpleTemplate::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// Compiled data, only one of these is usually loaded. A fallback compile on a worker replaces it.
+	FScopeLock Lock(&PendingDataLock);
+	SIZE_T Size = Tokens.GetAllocatedSize() + Program.GetAllocatedSize() + ProgramData.GetAllocatedSize() + PendingData.GetAllocatedSize();
+	if (FallbackSource.IsValid())
+	{
+		Size += FallbackSource->Source.GetAllocatedSize() + FallbackSource->Includes.GetAllocatedSize();
+	}
+
+	Size += DataPaths.GetAllocatedSize();
+	for (const FString& Path : DataPaths)
+	{
+		Size += Path.GetAllocatedSize();
+	}
+
+#if WITH_EDITORONLY_DATA
+	// Source text
+	Size += Template.ToString().GetAllocatedSize();
+	Size += LastErrors.GetAllocatedSize();
+	for (const FString& Error : LastErrors)
+	{
+		Size += Error.GetAllocatedSize();
+	}
+#endif
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Size);
+}
+
+void USimpleTemplate::UpdateDataPaths()
+{
+	DataPaths = CollectDataPaths(Tokens);
+}
+
+TArray<FString> USimpleTemplate::CollectDataPaths(const FTokenArray& InTokens)
+{
+	FTemplateDataPaths Paths;
+	InTokens.CollectDataPaths(Paths);
+	Paths.Paths.Sort();
+	return MoveTemp(Paths.Paths);
+}
+
 FString USimpleTemplate::Interpret(TSharedPtr<FJsonObject> Data)
 {
+	FScopedTemplateRenderContext RenderContext;
+	return Interpret(*RenderContext, Data);
+}
+
+FString USimpleTemplate::Interpret(TScriptInterface<ISimpleTemplateDataProvider> DataProvider)
+{
+	if (DataProvider == nullptr)
+	{
+		return FString();
+	}
+	TSharedPtr<ISimpleTemplateDataSource> DataSource = DataProvider->GetDataSource();
+	return DataSource.IsValid() ? Interpret(*DataSource) : Interpret(DataProvider->GetData());
+}
+
+FString USimpleTemplate::Interpret(ISimpleTemplateDataSource& DataSource)
+{
+	FScopedTemplateRenderContext RenderContext;
+	return Interpret(*RenderContext, DataSource);
+}
+
+FString USimpleTemplate::Interpret(FTemplateRenderContext& RenderContext, TSharedPtr<FJsonObject> Data)
+{
+	RenderContext.Begin(Data);
+	return Interpret(RenderContext);
+}
+
+FString USimpleTemplate::Interpret(FTemplateRenderContext& RenderContext, ISimpleTemplateDataSource& DataSource)
+{
+	RenderContext.Begin(DataSource);
+	return Interpret(RenderContext);
+}
+
+FString USimpleTemplate::Interpret(FTemplateRenderContext& RenderContext)
+{
+	TPL_SCOPE_TEMPLATE(this);
+	EnsureLoaded();
 	if (IsUpToDate())
 	{
-		auto interpreter = TTemplateInterpreter::Create(Tokens);
+		ResolveNative();
+		if (NativeFunction != nullptr && CVarNative.GetValueOnAnyThread() != 0)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_Interpret);
+			TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Interpreter);
+			FTemplateCompilerContent& Context = RenderContext.GetContext();
+			FArchive& WriteStream = RenderContext.GetWriteStream();
+#if STATS
+			const int64 OutputBegin = WriteStream.Tell();
+#endif
+			{
+				// Native code has no tokens, the profile shows it as a whole
+				FTemplateProfileScope ProfileScope(Context, nullptr, WriteStream);
+				TTemplateCompilerHelper::PushScope(Context);
+				NativeFunction(Context, WriteStream);
+				TTemplateCompilerHelper::PopScope(Context);
+			}
+			TPL_RENDER_OUTPUT_STAT(Context, OutputBegin, WriteStream.Tell());
+			return RenderContext.Finish();
+		}
+
+		// Cooked templates run the flat program
+		if (Program.IsValid())
+		{
+			Program.Interpret(RenderContext.GetContext(), RenderContext.GetWriteStream());
+			return RenderContext.Finish();
+		}
+
+		TTemplateInterpreter Interpreter(Tokens);
 		FString OutString;
-		if (interpreter->Interpret(OutString, Data))
+		if (Interpreter.Interpret(OutString, RenderContext))
 		{
 			return OutString;
 		}
 	}
+	RenderContext.Reset();
 	return FString();
 }
 
-FString USimpleTemplate::Interpret(TScriptInterface<ISimpleTemplateDataProvider> DataProvider)
+FString USimpleTemplate::InterpretIncremental(TScriptInterface<ISimpleTemplateDataProvider> DataProvider, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache)
 {
+	if (DataProvider == nullptr)
+	{
+		return FString();
+	}
+	TSharedPtr<ISimpleTemplateDataSource> DataSource = DataProvider->GetDataSource();
+	return DataSource.IsValid() ? InterpretIncremental(*DataSource, ChangedPaths, Cache) : InterpretIncremental(DataProvider->GetData(), ChangedPaths, Cache);
+}
+
+FString USimpleTemplate::InterpretIncremental(TSharedPtr<FJsonObject> Data, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache)
+{
+	FScopedTemplateRenderContext RenderContext;
+	return InterpretIncremental(RenderContext->Begin(Data), ChangedPaths, Cache);
+}
+
+FString USimpleTemplate::InterpretIncremental(ISimpleTemplateDataSource& DataSource, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache)
+{
+	FScopedTemplateRenderContext RenderContext;
+	return InterpretIncremental(RenderContext->Begin(DataSource), ChangedPaths, Cache);
+}
+
+FString USimpleTemplate::InterpretIncremental(FTemplateCompilerContent& Context, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache)
+{
+	TPL_SCOPE_TEMPLATE(this);
+	EnsureLoaded();
 	if (IsUpToDate())
 	{
-		auto interpreter = TTemplateInterpreter::Create(Tokens);
+		// The cache works on tokens, the ones of cooked templates are rebuilt into the cache so
+		// the template is not modified while other threads render it
 		FString OutString;
-		if (interpreter->Interpret(OutString, DataProvider))
+		const bool bRendered = Tokens.Items.Num() == 0 && Program.IsValid()
+			? Cache.Interpret(Program, Context, ChangedPaths, OutString)
+			: Cache.Interpret(Tokens, Context, ChangedPaths, OutString);
+		if (bRendered)
 		{
 			return OutString;
 		}
@@ -74,12 +703,66 @@ FString USimpleTemplate::Interpret(TScriptInterface<ISimpleTemplateDataProvider>
 	return FString();
 }
 
+#if WITH_EDITOR
+FSimpleTemplateProfile USimpleTemplate::Profile(TScriptInterface<ISimpleTemplateDataProvider> DataProvider, int32 NumRenders)
+{
+	FSimpleTemplateProfile Report;
+	EnsureLoaded();
+	if (DataProvider == nullptr || !IsUpToDate())
+	{
+		return Report;
+	}
+
+	// The profiler works on tokens, cooked templates are profiled on a copy rebuilt from the program
+	FTokenArray ProgramTokens;
+	const FTokenArray* ProfiledTokens = &Tokens;
+	if (Tokens.Items.Num() == 0 && Program.IsValid())
+	{
+		Program.ToTokens(ProgramTokens);
+		ProfiledTokens = &ProgramTokens;
+	}
+
+	TSharedPtr<ISimpleTemplateDataSource> DataSource = DataProvider->GetDataSource();
+	TSharedPtr<FJsonObject> Data = DataSource.IsValid() ? nullptr : DataProvider->GetData();
+
+	FTemplateProfiler Profiler;
+	TTemplateInterpreter Interpreter(*ProfiledTokens);
+	NumRenders = FMath::Max(1, NumRenders);
+	for (int32 i = 0; i < NumRenders; i++)
+	{
+		FScopedTemplateRenderContext RenderContext;
+		FTemplateCompilerContent& Context = DataSource.IsValid() ? RenderContext->Begin(*DataSource) : RenderContext->Begin(Data);
+		Context.Profiler = &Profiler;
+
+		FString Output;
+		Interpreter.Interpret(Output, *RenderContext);
+	}
+	Profiler.BuildReport(NumRenders, Report);
+	return Report;
+}
+#endif
+
+FString USimpleTemplate::GetIncludePath(const FString& Name, const FString& PackagePath)
+{
+	FString Path = Name;
+	if (!FPackageName::IsValidLongPackageName(Path) && !FPackageName::IsValidObjectPath(Path))
+	{
+		Path = PackagePath / Name;
+	}
+	if (!Path.Contains(TEXT(".")))
+	{
+		Path += TEXT(".") + FPackageName::GetShortName(Path);
+	}
+	return Path;
+}
+
 #if WITH_EDITOR
 
 void USimpleTemplate::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	const FName PropertyName = (PropertyChangedEvent.Property ? PropertyChangedEvent.Property->GetFName() : NAME_None);
-	if (PropertyName == GET_MEMBER_NAME_CHECKED(USimpleTemplate, Template))
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(USimpleTemplate, Template) || PropertyName == GET_MEMBER_NAME_CHECKED(USimpleTemplate, Escape)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(USimpleTemplate, bStripBlockWhitespace))
 	{
 		Status = ETemplateStatus::TS_Dirty;
 	}
@@ -87,26 +770,499 @@ void USimpleTemplate::PostEditChangeProperty(FPropertyChangedEvent& PropertyChan
 }
 
 bool USimpleTemplate::Compile()
+{
+	// Background compiles still running are outdated now
+	CancelAsyncCompile();
+
+	const bool bSuccess = CompileSource(true);
+	if (bSuccess)
+	{
+		RecompileDependents();
+	}
+	return bSuccess;
+}
+
+bool USimpleTemplate::CompileSource(bool bNotify)
+{
+	TPL_SCOPE_TEMPLATE(this);
+	const bool bUseDerivedData = CVarDerivedData.GetValueOnGameThread() != 0;
+	const FString Key = bUseDerivedData ? GetDerivedDataKey(Template.ToString()) : FString();
+
+	TArray<uint8> Data;
+	if (bUseDerivedData && GetDerivedDataCacheRef().GetSynchronous(*Key, Data TPL_DDC_CONTEXT(this)) && ApplyDerivedData(Data, bNotify))
+	{
+		return true;
+	}
+
+	auto compiler = CreateCompiler();
+	const bool bSuccess = compiler->Compile();
+	FinishCompile(*compiler, bSuccess, bNotify);
+	if (bSuccess && bUseDerivedData)
+	{
+		PutDerivedData(Key);
+	}
+	return bSuccess;
+}
+
+int32 USimpleTemplate::CompileAll(const TArray<USimpleTemplate*>& Templates, TArray<double>* OutSeconds)
+{
+	check(IsInGameThread());
+
+	struct FCompileJob
+	{
+		USimpleTemplate* Template;
+		FString Source;
+		FString Path;
+		FString Name;
+		TStatId StatId;
+		ETemplateEscape Escape;
+		bool bStripBlocks;
+		FString Key;
+		uint32 Handle;
+		TSharedPtr<TTemplateTokenizer<TCHAR>> Compiler;
+		bool bSuccess;
+		bool bCached;
+		bool bMissedInclude;
+		double Seconds;
+	};
+
+	// Everything touching objects happens here, the workers only see strings
+	TArray<FCompileJob> Jobs;
+	TMap<FString, const FString*> Sources;
+	Jobs.SetNum(Templates.Num());
+	for (int32 i = 0; i < Templates.Num(); i++)
+	{
+		FCompileJob& Job = Jobs[i];
+		Job.Template = Templates[i];
+		Job.Template->EnsureLoaded();
+		Job.Source = Job.Template->Template.ToString();
+		Job.Path = Job.Template->GetPathName();
+		Job.Name = Job.Template->GetName();
+		Job.StatId = TPL_TEMPLATE_STAT_ID(Job.Template);
+		Job.Escape = Job.Template->Escape;
+		Job.bStripBlocks = Job.Template->bStripBlockWhitespace;
+		Job.Handle = 0;
+		Job.bSuccess = false;
+		Job.bCached = false;
+		Job.bMissedInclude = false;
+		Job.Seconds = 0.0;
+	}
+	for (const FCompileJob& Job : Jobs)
+	{
+		Sources.Add(Job.Path, &Job.Source);
+	}
+
+	// All the requests are in flight together, a shared cache answers them in parallel
+	if (CVarDerivedData.GetValueOnGameThread() != 0)
+	{
+		FDerivedDataCacheInterface& DerivedDataCache = GetDerivedDataCacheRef();
+		for (FCompileJob& Job : Jobs)
+		{
+			Job.Key = Job.Template->GetDerivedDataKey(Job.Source);
+			Job.Handle = DerivedDataCache.GetAsynchronous(*Job.Key TPL_DDC_CONTEXT(Job.Template));
+		}
+		for (FCompileJob& Job : Jobs)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			DerivedDataCache.WaitAsynchronousCompletion(Job.Handle);
+			TArray<uint8> Data;
+			if (DerivedDataCache.GetAsynchronousResults(Job.Handle, Data) && Job.Template->ApplyDerivedData(Data, true))
+			{
+				Job.bSuccess = true;
+				Job.bCached = true;
+			}
+			Job.Seconds = FPlatformTime::Seconds() - StartTime;
+		}
+	}
+
+	ParallelFor(Jobs.Num(), [&Jobs, &Sources](int32 Index)
+	{
+		FCompileJob& Job = Jobs[Index];
+		if (Job.bCached)
+		{
+			return;
+		}
+		TPL_SCOPE_TEMPLATE_NAMED(Job.StatId, Job.Name);
+		const double StartTime = FPlatformTime::Seconds();
+		Job.Compiler = CreateCompiler(Job.Source, Job.Path, Job.Escape, Job.bStripBlocks, [&Job, &Sources](const FString& Name, const FString& IncludingPath, FString& OutPath, FString& OutSource)
+		{
+			OutPath = GetIncludePath(Name, FPackageName::GetLongPackagePath(IncludingPath));
+			const FString* const* Found = Sources.Find(OutPath);
+			if (Found == nullptr)
+			{
+				Job.bMissedInclude = true;
+				return false;
+			}
+			OutSource = **Found;
+			return true;
+		});
+		Job.bSuccess = Job.Compiler->Compile();
+		Job.Seconds += FPlatformTime::Seconds() - StartTime;
+	});
+
+	int32 NumErrors = 0;
+	TSet<USimpleTemplate*> Compiled;
+	for (FCompileJob& Job : Jobs)
+	{
+		if (Job.bCached)
+		{
+			// Already applied
+		}
+		else if (!Job.bSuccess && Job.bMissedInclude)
+		{
+			// Includes outside of the batch have to be loaded
+			const double StartTime = FPlatformTime::Seconds();
+			Job.bSuccess = Job.Template->CompileSource(true);
+			Job.Seconds += FPlatformTime::Seconds() - StartTime;
+		}
+		else
+		{
+			Job.Template->FinishCompile(*Job.Compiler, Job.bSuccess, true);
+			if (Job.bSuccess && !Job.Key.IsEmpty())
+			{
+				Job.Template->PutDerivedData(Job.Key);
+			}
+		}
+		Job.Compiler.Reset();
+		Compiled.Add(Job.Template);
+		NumErrors += Job.bSuccess ? 0 : 1;
+	}
+
+	// Loaded templates outside of the batch might include the compiled ones
+	for (const FCompileJob& Job : Jobs)
+	{
+		if (Job.bSuccess)
+		{
+			Job.Template->RecompileDependents(Compiled);
+		}
+	}
+
+	if (OutSeconds != nullptr)
+	{
+		OutSeconds->SetNum(Jobs.Num());
+		for (int32 i = 0; i < Jobs.Num(); i++)
+		{
+			(*OutSeconds)[i] = Jobs[i].Seconds;
+		}
+	}
+	return NumErrors;
+}
+
+void USimpleTemplate::CompileAsync(TFunction<void(bool bSuccess)> OnCompiled)
+{
+	check(IsInGameThread());
+
+	struct FAsyncCompileJob
+	{
+		FString Source;
+		TMap<FString, FString> Sources;
+		TSharedPtr<TTemplateTokenizer<TCHAR>> Compiler;
+		int32 Serial;
+		bool bSuccess;
+		bool bMissedInclude;
+	};
+
+	// Objects are only touched here, the worker reads the sources of the known includes
+	TSharedRef<FAsyncCompileJob, ESPMode::ThreadSafe> Job = MakeShared<FAsyncCompileJob, ESPMode::ThreadSafe>();
+	Job->Source = Template.ToString();
+	TSet<FString> IncludePaths;
+	for (const FSimpleTemplateInclude& Include : Includes)
+	{
+		IncludePaths.Add(Include.Template.ToString());
+	}
+	if (TokenizerState.IsValid())
+	{
+		for (const FTemplateTokenizerInclude& Include : TokenizerState->Includes)
+		{
+			IncludePaths.Add(Include.Path);
+		}
+	}
+	for (const FString& IncludePath : IncludePaths)
+	{
+		if (USimpleTemplate* Included = Cast<USimpleTemplate>(FSoftObjectPath(IncludePath).TryLoad()))
+		{
+			Job->Sources.Add(IncludePath, Included->Template.ToString());
+		}
+	}
+	Job->Serial = ++AsyncCompileSerial;
+	Job->bSuccess = false;
+	Job->bMissedInclude = false;
+
+	FAsyncCompileJob& JobRef = *Job;
+	Job->Compiler = CreateCompiler(Job->Source, GetPathName(), [&JobRef](const FString& Name, const FString& IncludingPath, FString& OutPath, FString& OutSource)
+	{
+		OutPath = GetIncludePath(Name, FPackageName::GetLongPackagePath(IncludingPath));
+		const FString* Found = JobRef.Sources.Find(OutPath);
+		if (Found == nullptr)
+		{
+			JobRef.bMissedInclude = true;
+			return false;
+		}
+		OutSource = *Found;
+		return true;
+	});
+
+	// The tokens of the last compile are reused if the templates it inlined still resolve to the same sources
+	if (TokenizerState.IsValid() && CVarIncrementalCompile.GetValueOnGameThread() != 0)
+	{
+		Job->Compiler->SetPrevious(TokenizerState);
+	}
+
+	TWeakObjectPtr<USimpleTemplate> WeakThis(this);
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Job, WeakThis, OnCompiled]()
+	{
+		Job->bSuccess = Job->Compiler->Compile();
+
+		AsyncTask(ENamedThreads::GameThread, [Job, WeakThis, OnCompiled]()
+		{
+			// Stale, a newer compile is running or the source was edited since. The compiler is released
+			// here as it can reference the tokens of the last compile.
+			USimpleTemplate* This = WeakThis.Get();
+			if (This == nullptr || Job->Serial != This->AsyncCompileSerial || Job->Source != This->Template.ToString())
+			{
+				Job->Compiler.Reset();
+				return;
+			}
+
+			bool bSuccess = Job->bSuccess;
+			if (!bSuccess && Job->bMissedInclude)
+			{
+				// A template included for the first time has to be loaded
+				bSuccess = This->Compile();
+			}
+			else
+			{
+				This->FinishCompile(*Job->Compiler, bSuccess, true);
+				if (bSuccess)
+				{
+					This->RecompileDependents();
+				}
+			}
+			Job->Compiler.Reset();
+
+			if (OnCompiled)
+			{
+				OnCompiled(bSuccess);
+			}
+		});
+	});
+}
+
+TSharedRef<TTemplateTokenizer<TCHAR>> USimpleTemplate::CreateCompiler(const FString& Source, const FString& Path, ETemplateEscape InEscape, bool bStripBlocks, TTemplateTokenizer<TCHAR>::FIncludeResolver IncludeResolver)
+{
+	auto compiler = TTemplateCompilerFactory<TCHAR>::Create(Source);
+	compiler->SetDefaultEscape(InEscape);
+	compiler->SetStripBlocks(bStripBlocks);
+	compiler->SetIncludeResolver(MoveTemp(IncludeResolver), Path);
+	return compiler;
+}
+
+TSharedRef<TTemplateTokenizer<TCHAR>> USimpleTemplate::CreateCompiler(const FString& Source, const FString& Path, TTemplateTokenizer<TCHAR>::FIncludeResolver IncludeResolver) const
+{
+	return CreateCompiler(Source, Path, Escape, bStripBlockWhitespace, MoveTemp(IncludeResolver));
+}
+
+TSharedRef<TTemplateTokenizer<TCHAR>> USimpleTemplate::CreateCompiler() const
+{
+	return CreateCompiler(Template.ToString(), GetPathName(), [](const FString& Name, const FString& IncludingPath, FString& OutPath, FString& OutSource)
+	{
+		USimpleTemplate* Included = FindInclude(Name, IncludingPath);
+		if (Included == nullptr)
+		{
+			return false;
+		}
+		OutPath = Included->GetPathName();
+		OutSource = Included->Template.ToString();
+		return true;
+	});
+}
+
+void USimpleTemplate::FinishCompile(TTemplateTokenizer<TCHAR>& Compiler, bool bSuccess, bool bNotify)
 {
 	LineNumber = 0;
 	CharacterNumber = 0;
 	LastErrors.Empty();
-	auto compiler = TTemplateCompilerFactory<TCHAR>::Create(Template.ToString());
-	if (compiler->Compile())
+	if (bSuccess)
 	{
-		Tokens = compiler->GetTokenTree();
+		SetCompiledTokens(Compiler.GetTokenTree());
+		TokenizerState = Compiler.GetState();
+
+		Includes.Reset();
+		for (const FString& Path : Compiler.GetIncludes())
+		{
+			if (USimpleTemplate* Included = LoadObject<USimpleTemplate>(nullptr, *Path, nullptr, LOAD_NoWarn | LOAD_Quiet))
+			{
+				FSimpleTemplateInclude& Include = Includes[Includes.AddDefaulted()];
+				Include.Template = FSoftObjectPath(Included);
+				Include.SourceHash = FCrc::StrCrc32(*Included->Template.ToString());
+			}
+		}
 		Status = ETemplateStatus::TS_UpToDate;
+	}
+	else
+	{
+		LineNumber = Compiler.GetLineNumber();
+		CharacterNumber = Compiler.GetCharNumber();
+		LastErrors.Add(Compiler.GetLastError());
+		Status = ETemplateStatus::TS_Error;
+	}
+
+	if (bNotify)
+	{
 		PostEditChange();
 		MarkPackageDirty();
-		return true;
 	}
-	LineNumber = compiler->GetLineNumber();
-	CharacterNumber = compiler->GetCharNumber();
-	LastErrors.Add(compiler->GetLastError());
-	Status = ETemplateStatus::TS_Error;
-	PostEditChange();
-	MarkPackageDirty();
-	return false;
 }
 
-#endif
\ No newline at end of file
+void USimpleTemplate::SetCompiledTokens(const FTokenArray& InTokens)
+{
+	EnsureLoaded();
+	Tokens = InTokens;
+	ResetProgram();
+	UpdateDataPaths();
+	bNativeResolved = false;
+}
+
+FString USimpleTemplate::GetDerivedDataKey(const FString& Source) const
+{
+	// Relative includes resolve next to the template, so the folder is part of the key
+	const FString PackagePath = FPackageName::GetLongPackagePath(GetOutermost()->GetName());
+	const FString Options = FString::Printf(TEXT("%s|%d|%d|"), *PackagePath, (int32)Escape, bStripBlockWhitespace ? 1 : 0);
+
+	// Hashed as utf8 so platforms with a different TCHAR share the entries
+	FSHA1 Sha;
+	FTCHARToUTF8 OptionsUtf8(*Options);
+	FTCHARToUTF8 SourceUtf8(*Source);
+	Sha.Update((const uint8*)OptionsUtf8.Get(), OptionsUtf8.Length());
+	Sha.Update((const uint8*)SourceUtf8.Get(), SourceUtf8.Length());
+	Sha.Final();
+	uint32 Hash[5];
+	Sha.GetHash((uint8*)Hash);
+
+	const FString Version = FString::Printf(TEXT("%s_%u"), SIMPLETEMPLATE_DERIVEDDATA_VER, TPL_VERSION);
+	return FDerivedDataCacheInterface::BuildCacheKey(TEXT("SIMPLETEMPLATE"), *Version, *BytesToHex((const uint8*)Hash, sizeof(Hash)));
+}
+
+bool USimpleTemplate::ApplyDerivedData(const TArray<uint8>& Data, bool bNotify)
+{
+	FMemoryReader Reader(Data);
+
+	// The includes are not part of the key, the entry is only valid while they are unchanged
+	int32 NumIncludes = 0;
+	Reader << NumIncludes;
+	TArray<FSimpleTemplateInclude> CachedIncludes;
+	for (int32 i = 0; i < NumIncludes && !Reader.IsError(); i++)
+	{
+		FString Path;
+		uint32 SourceHash = 0;
+		Reader << Path;
+		Reader << SourceHash;
+		USimpleTemplate* Included = LoadObject<USimpleTemplate>(nullptr, *Path, nullptr, LOAD_NoWarn | LOAD_Quiet);
+		if (Included == nullptr || FCrc::StrCrc32(*Included->Template.ToString()) != SourceHash)
+		{
+			return false;
+		}
+		FSimpleTemplateInclude& Include = CachedIncludes[CachedIncludes.AddDefaulted()];
+		Include.Template = FSoftObjectPath(Included);
+		Include.SourceHash = SourceHash;
+	}
+
+	FTokenArray CachedTokens;
+	CachedTokens.Serialize(Reader);
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	LineNumber = 0;
+	CharacterNumber = 0;
+	LastErrors.Empty();
+	SetCompiledTokens(CachedTokens);
+	TokenizerState.Reset();
+	Includes = MoveTemp(CachedIncludes);
+	Status = ETemplateStatus::TS_UpToDate;
+
+	if (bNotify)
+	{
+		PostEditChange();
+		MarkPackageDirty();
+	}
+	return true;
+}
+
+void USimpleTemplate::PutDerivedData(const FString& Key) const
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	int32 NumIncludes = Includes.Num();
+	Writer << NumIncludes;
+	for (const FSimpleTemplateInclude& Include : Includes)
+	{
+		FString Path = Include.Template.ToString();
+		uint32 SourceHash = Include.SourceHash;
+		Writer << Path;
+		Writer << SourceHash;
+	}
+
+	FTokenArray CachedTokens = Tokens;
+	CachedTokens.Serialize(Writer);
+	GetDerivedDataCacheRef().Put(*Key, Data TPL_DDC_CONTEXT(this));
+}
+
+USimpleTemplate* USimpleTemplate::FindInclude(const FString& Name, const FString& IncludingPath)
+{
+	const FString Path = GetIncludePath(Name, FPackageName::GetLongPackagePath(IncludingPath));
+	return LoadObject<USimpleTemplate>(nullptr, *Path, nullptr, LOAD_NoWarn | LOAD_Quiet);
+}
+
+bool USimpleTemplate::AreIncludesUpToDate() const
+{
+	for (const FSimpleTemplateInclude& Include : Includes)
+	{
+		const USimpleTemplate* Included = Cast<USimpleTemplate>(Include.Template.TryLoad());
+		if (Included == nullptr || FCrc::StrCrc32(*Included->Template.ToString()) != Include.SourceHash)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void USimpleTemplate::RecompileDependents()
+{
+	TSet<USimpleTemplate*> Visited;
+	Visited.Add(this);
+	RecompileDependents(Visited);
+}
+
+void USimpleTemplate::RecompileDependents(TSet<USimpleTemplate*>& Visited)
+{
+	// Templates that are not loaded notice the change in PostLoad. Includes are inlined from their
+	// source, so the order does not matter and a template included along several paths compiles once.
+	const FSoftObjectPath Path(this);
+	TArray<USimpleTemplate*> Dependents;
+	for (TObjectIterator<USimpleTemplate> It; It; ++It)
+	{
+		USimpleTemplate* Dependent = *It;
+		if (!Dependent->IsTemplate() && !Visited.Contains(Dependent) && Dependent->Includes.ContainsByPredicate([&Path](const FSimpleTemplateInclude& Include)
+		{
+			return Include.Template == Path;
+		}))
+		{
+			Visited.Add(Dependent);
+			Dependents.Add(Dependent);
+		}
+	}
+
+	for (USimpleTemplate* Dependent : Dependents)
+	{
+		Dependent->CancelAsyncCompile();
+		if (Dependent->CompileSource(true))
+		{
+			Dependent->RecompileDependents(Visited);
+		}
+	}
+}
+
+#endif
@@ -17,6 +17,7 @@ bool USimpleTemplateData::SetData(const FString& Data)
 		return true;
 	}
 	JsonString = JsonString;
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Data);
 	auto Reader = TJsonReaderFactory<>::Create(*Data);
 	if (FJsonSerializer::Deserialize(Reader, JsonPtr) && JsonPtr.IsValid())
 	{
@@ -0,0 +1,27 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateLazyData.h"
+
+void USimpleTemplateLazyData::SetCallbacks(FSimpleTemplateLazyDataSource::FResolvePath ResolvePath, FSimpleTemplateLazyDataSource::FIterateArray IterateArray, bool bCacheValues)
+{
+	DataSource = MakeShareable(new FSimpleTemplateLazyDataSource(MoveTemp(ResolvePath), MoveTemp(IterateArray), bCacheValues));
+}
+
+void USimpleTemplateLazyData::ResetCache()
+{
+	if (DataSource.IsValid())
+	{
+		DataSource->ResetCache();
+	}
+}
+
+TSharedPtr<FJsonObject> USimpleTemplateLazyData::GetData() const
+{
+	// All values are pulled through the data source
+	return nullptr;
+}
+
+TSharedPtr<ISimpleTemplateDataSource> USimpleTemplateLazyData::GetDataSource() const
+{
+	return DataSource;
+}
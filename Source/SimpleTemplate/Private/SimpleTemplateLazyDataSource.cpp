@@ -0,0 +1,82 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateLazyDataSource.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+
+/* FSimpleTemplateJsonDataSource interface
+ *****************************************************************************/
+
+TSharedPtr<FJsonValue> FSimpleTemplateJsonDataSource::GetValue(const FString& Key)
+{
+	if (Key.IsEmpty())
+	{
+		return Value;
+	}
+
+	const TSharedPtr<FJsonObject>* Object;
+	if (Value.IsValid() && Value->TryGetObject(Object))
+	{
+		return TTemplateCompilerHelper::GetValue(Key, *Object);
+	}
+	return nullptr;
+}
+
+
+bool FSimpleTemplateJsonDataSource::IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback)
+{
+	TSharedPtr<FJsonValue> ListValue = GetValue(Key);
+	const TArray<TSharedPtr<FJsonValue>>* List;
+	if (ListValue.IsValid() && ListValue->TryGetArray(List))
+	{
+		for (const TSharedPtr<FJsonValue>& ListItem : *List)
+		{
+			FSimpleTemplateJsonDataSource Item(ListItem);
+			Callback(Item);
+		}
+		return true;
+	}
+	return false;
+}
+
+
+/* FSimpleTemplateLazyDataSource interface
+ *****************************************************************************/
+
+TSharedPtr<FJsonValue> FSimpleTemplateLazyDataSource::GetValue(const FString& Key)
+{
+	if (!ResolvePath)
+	{
+		return nullptr;
+	}
+
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Data);
+
+	if (bCacheValues)
+	{
+		const TSharedPtr<FJsonValue>* Cached = Cache.Find(Key);
+		if (Cached != nullptr)
+		{
+			return *Cached;
+		}
+		return Cache.Add(Key, ResolvePath(Key));
+	}
+	return ResolvePath(Key);
+}
+
+
+bool FSimpleTemplateLazyDataSource::IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback)
+{
+	TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Data);
+	if (IterateArray)
+	{
+		return IterateArray(Key, [&Callback](const TSharedPtr<FJsonValue>& ListItem)
+		{
+			FSimpleTemplateJsonDataSource Item(ListItem);
+			Callback(Item);
+		});
+	}
+
+	// Fall back to resolve the whole list
+	FSimpleTemplateJsonDataSource List(GetValue(Key));
+	return List.IterateList(FString(), Callback);
+}
@@ -1,6 +1,7 @@
 // Copyright Playspace S.L. 2017
 
 #include "ISimpleTemplate.h"
+#include "SimpleTemplatePropertyDataSource.h"
 
 /**
  * Implements the SimpleTemplate module.
@@ -13,7 +14,10 @@ public:
 	//~ IModuleInterface interface
 
 	virtual void StartupModule() override { }
-	virtual void ShutdownModule() override { }
+	virtual void ShutdownModule() override
+	{
+		FSimpleTemplatePropertyDataSource::ResetCache();
+	}
 
 	virtual bool SupportsDynamicReloading() override
 	{
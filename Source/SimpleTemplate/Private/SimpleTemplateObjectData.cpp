@@ -0,0 +1,35 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateObjectData.h"
+#include "SimpleTemplatePropertyDataSource.h"
+
+void USimpleTemplateObjectData::SetSourceObject(UObject* InSourceObject)
+{
+	SourceObject = InSourceObject;
+	DataSource.Reset();
+	if (SourceObject != nullptr)
+	{
+		DataSource = MakeShareable(new FSimpleTemplatePropertyDataSource(SourceObject));
+	}
+}
+
+UObject* USimpleTemplateObjectData::GetSourceObject() const
+{
+	return SourceObject;
+}
+
+TSharedPtr<FJsonObject> USimpleTemplateObjectData::GetData() const
+{
+	// All values are resolved through the data source
+	return nullptr;
+}
+
+TSharedPtr<ISimpleTemplateDataSource> USimpleTemplateObjectData::GetDataSource() const
+{
+	// The source object might have been destroyed in the meantime
+	if (SourceObject == nullptr || SourceObject->IsPendingKill())
+	{
+		return nullptr;
+	}
+	return DataSource;
+}
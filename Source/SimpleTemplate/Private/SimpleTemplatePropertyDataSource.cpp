@@ -0,0 +1,482 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplatePropertyDataSource.h"
+#include "SimpleTemplateStats.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Compiler/SimpleTemplateKey.h"
+#include "UObject/EnumProperty.h"
+#include "UObject/TextProperty.h"
+
+#if TPL_OBJECT_PROPERTIES
+typedef UBoolProperty FBoolProperty;
+typedef UEnumProperty FEnumProperty;
+typedef UNumericProperty FNumericProperty;
+typedef UStrProperty FStrProperty;
+typedef UNameProperty FNameProperty;
+typedef UTextProperty FTextProperty;
+typedef UObjectPropertyBase FObjectPropertyBase;
+typedef UStructProperty FStructProperty;
+typedef UArrayProperty FArrayProperty;
+
+namespace
+{
+	template<typename PropertyType>
+	const PropertyType* CastField(const UProperty* Property)
+	{
+		return Cast<PropertyType>(Property);
+	}
+}
+#endif
+
+namespace SimpleTemplatePropertyPath
+{
+	/** A key resolved against a struct, the chain walks nested structs of the same memory block */
+	struct FResolvedPath
+	{
+		// Used to detect structs that got replaced at the same address
+		TWeakObjectPtr<UStruct> Struct;
+
+		// Properties to follow, empty if the key could not be resolved
+		TArray<const FProperty*> Chain;
+
+		// Part of the key behind an object reference or a list, resolved at runtime
+		FTemplateKey Remainder;
+	};
+
+	typedef TSharedPtr<FResolvedPath> FResolvedPathPtr;
+
+	/** Paths resolved by a thread, reads do not lock */
+	struct FPathCache
+	{
+		int32 Generation = 0;
+		TMap<const UStruct*, TMap<FString, FResolvedPathPtr>> Paths;
+	};
+
+	// Bumped by ResetCache, threads drop their paths when they see a new value
+	static FThreadSafeCounter CacheGeneration;
+
+	static FResolvedPathPtr BuildPath(const UStruct* Struct, const FString& Key)
+	{
+		FResolvedPathPtr Path = MakeShareable(new FResolvedPath());
+		Path->Struct = const_cast<UStruct*>(Struct);
+
+		TArray<FString> Segments;
+		Key.ParseIntoArray(Segments, TEXT("."), true);
+
+		const UStruct* CurrentStruct = Struct;
+		for (int32 i = 0; i < Segments.Num(); i++)
+		{
+			const FName SegmentName(*Segments[i], FNAME_Find);
+			const FProperty* Property = SegmentName != NAME_None ? CurrentStruct->FindPropertyByName(SegmentName) : nullptr;
+			if (Property == nullptr)
+			{
+				Path->Chain.Reset();
+				break;
+			}
+			Path->Chain.Add(Property);
+
+			if (i < Segments.Num() - 1)
+			{
+				const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+				if (StructProperty != nullptr)
+				{
+					CurrentStruct = StructProperty->Struct;
+					continue;
+				}
+
+				// Object references and lists depend on the actual data
+				FString Remainder;
+				for (int32 j = i + 1; j < Segments.Num(); j++)
+				{
+					if (!Remainder.IsEmpty())
+					{
+						Remainder += TEXT(".");
+					}
+					Remainder += Segments[j];
+				}
+				Path->Remainder.Set(Remainder);
+				break;
+			}
+		}
+		return Path;
+	}
+
+	static FResolvedPathPtr FindPath(const UStruct* Struct, const FString& Key)
+	{
+		static thread_local FPathCache Cache;
+		const int32 Generation = CacheGeneration.GetValue();
+		if (Cache.Generation != Generation)
+		{
+			Cache.Paths.Reset();
+			Cache.Generation = Generation;
+		}
+
+		TMap<FString, FResolvedPathPtr>& StructCache = Cache.Paths.FindOrAdd(Struct);
+		FResolvedPathPtr* Found = StructCache.Find(Key);
+		if (Found != nullptr)
+		{
+			if ((*Found)->Struct.Get() == Struct)
+			{
+				return *Found;
+			}
+			StructCache.Reset();
+		}
+
+		FResolvedPathPtr Path = BuildPath(Struct, Key);
+		StructCache.Add(Key, Path);
+		return Path;
+	}
+
+	static bool ResolvePath(const UStruct* Struct, const void* Container, const FString& Key, const FProperty*& OutProperty, const void*& OutValue);
+
+	/** Resolve the fields of the remainder starting at a field, fields are never empty */
+	static bool ResolveRemainder(const FProperty* Property, const void* Value, const FTemplateKey& Remainder, int32 Field, const FProperty*& OutProperty, const void*& OutValue)
+	{
+		// Keys behind a list index are cut from the remainder when they are walked
+		FString CutRest;
+		if (Field > 0)
+		{
+			CutRest = Remainder.GetRest(Field);
+		}
+		const FString& Rest = Field > 0 ? CutRest : Remainder.Key;
+
+		const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property);
+		if (ObjectProperty != nullptr)
+		{
+			const UObject* Object = ObjectProperty->GetObjectPropertyValue(Value);
+			return Object != nullptr && ResolvePath(Object->GetClass(), Object, Rest, OutProperty, OutValue);
+		}
+
+		const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+		if (StructProperty != nullptr)
+		{
+			return ResolvePath(StructProperty->Struct, Value, Rest, OutProperty, OutValue);
+		}
+
+		const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property);
+		if (ArrayProperty != nullptr)
+		{
+			// Lists are indexed by the next field of the key
+			const FString& IndexKey = Remainder.Fields[Field];
+			FScriptArrayHelper Helper(ArrayProperty, Value);
+			const int32 Index = IndexKey.IsNumeric() ? FCString::Atoi(*IndexKey) : INDEX_NONE;
+			if (!Helper.IsValidIndex(Index))
+			{
+				return false;
+			}
+
+			const void* Element = Helper.GetRawPtr(Index);
+			if (Field + 1 >= Remainder.Fields.Num())
+			{
+				OutProperty = ArrayProperty->Inner;
+				OutValue = Element;
+				return true;
+			}
+			return ResolveRemainder(ArrayProperty->Inner, Element, Remainder, Field + 1, OutProperty, OutValue);
+		}
+
+		return false;
+	}
+
+	static bool ResolvePath(const UStruct* Struct, const void* Container, const FString& Key, const FProperty*& OutProperty, const void*& OutValue)
+	{
+		// Shared so the path outlives the cache being reset while it is walked
+		FResolvedPathPtr PathPtr = FindPath(Struct, Key);
+		const FResolvedPath& Path = *PathPtr;
+		if (Path.Chain.Num() == 0)
+		{
+			return false;
+		}
+
+		const void* Value = Container;
+		for (const FProperty* Property : Path.Chain)
+		{
+			Value = Property->ContainerPtrToValuePtr<void>(Value);
+		}
+
+		if (Path.Remainder.Fields.Num() == 0)
+		{
+			OutProperty = Path.Chain.Last();
+			OutValue = Value;
+			return true;
+		}
+		return ResolveRemainder(Path.Chain.Last(), Value, Path.Remainder, 0, OutProperty, OutValue);
+	}
+}
+
+/* FSimpleTemplatePropertyDataSource structors
+ *****************************************************************************/
+
+FSimpleTemplatePropertyDataSource::FSimpleTemplatePropertyDataSource(const UObject* InObject)
+	: Struct(InObject != nullptr ? InObject->GetClass() : nullptr)
+	, Container(InObject)
+	, Property(nullptr)
+	, Value(nullptr)
+{ }
+
+
+FSimpleTemplatePropertyDataSource::FSimpleTemplatePropertyDataSource(const UStruct* InStruct, const void* InContainer)
+	: Struct(InStruct)
+	, Container(InContainer)
+	, Property(nullptr)
+	, Value(nullptr)
+{ }
+
+
+FSimpleTemplatePropertyDataSource::FSimpleTemplatePropertyDataSource(const FProperty* InProperty, const void* InValue)
+	: Struct(nullptr)
+	, Container(nullptr)
+	, Property(InProperty)
+	, Value(InValue)
+{
+	// Structs and objects expose their own properties as well
+	const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+	if (StructProperty != nullptr)
+	{
+		Struct = StructProperty->Struct;
+		Container = Value;
+		return;
+	}
+
+	const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property);
+	if (ObjectProperty != nullptr)
+	{
+		const UObject* Object = ObjectProperty->GetObjectPropertyValue(Value);
+		if (Object != nullptr)
+		{
+			Struct = Object->GetClass();
+			Container = Object;
+		}
+	}
+}
+
+
+/* ISimpleTemplateDataSource interface
+ *****************************************************************************/
+
+TSharedPtr<FJsonValue> FSimpleTemplatePropertyDataSource::GetValue(const FString& Key)
+{
+	const FProperty* ValueProperty = nullptr;
+	const void* ValueMemory = nullptr;
+	if (Resolve(Key, ValueProperty, ValueMemory))
+	{
+		TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Data);
+		return PropertyToJson(ValueProperty, ValueMemory);
+	}
+	return nullptr;
+}
+
+
+bool FSimpleTemplatePropertyDataSource::GetString(const FString& Key, FString& OutString)
+{
+	const FProperty* ValueProperty = nullptr;
+	const void* ValueMemory = nullptr;
+	return Resolve(Key, ValueProperty, ValueMemory) && PropertyToString(ValueProperty, ValueMemory, OutString);
+}
+
+
+bool FSimpleTemplatePropertyDataSource::IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback)
+{
+	const FProperty* ListProperty = nullptr;
+	const void* ListMemory = nullptr;
+	if (!Resolve(Key, ListProperty, ListMemory))
+	{
+		return false;
+	}
+
+	const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(ListProperty);
+	if (ArrayProperty == nullptr)
+	{
+		return false;
+	}
+
+	FScriptArrayHelper Helper(ArrayProperty, ListMemory);
+	for (int32 i = 0; i < Helper.Num(); i++)
+	{
+		FSimpleTemplatePropertyDataSource Item(ArrayProperty->Inner, Helper.GetRawPtr(i));
+		Callback(Item);
+	}
+	return true;
+}
+
+
+/* FSimpleTemplatePropertyDataSource implementation
+ *****************************************************************************/
+
+TSharedPtr<FJsonValue> FSimpleTemplatePropertyDataSource::PropertyToJson(const FProperty* Property, const void* Value)
+{
+	const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property);
+	if (BoolProperty != nullptr)
+	{
+		return MakeShareable(new FJsonValueBoolean(BoolProperty->GetPropertyValue(Value)));
+	}
+
+	const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property);
+	if (EnumProperty != nullptr)
+	{
+		const int64 EnumValue = EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(Value);
+		return MakeShareable(new FJsonValueString(EnumProperty->GetEnum()->GetNameStringByValue(EnumValue)));
+	}
+
+	const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property);
+	if (NumericProperty != nullptr)
+	{
+		const UEnum* Enum = NumericProperty->GetIntPropertyEnum();
+		if (Enum != nullptr)
+		{
+			return MakeShareable(new FJsonValueString(Enum->GetNameStringByValue(NumericProperty->GetSignedIntPropertyValue(Value))));
+		}
+		if (NumericProperty->IsFloatingPoint())
+		{
+			return MakeShareable(new FJsonValueNumber(NumericProperty->GetFloatingPointPropertyValue(Value)));
+		}
+		return MakeShareable(new FJsonValueNumber(static_cast<double>(NumericProperty->GetSignedIntPropertyValue(Value))));
+	}
+
+	const FStrProperty* StrProperty = CastField<FStrProperty>(Property);
+	if (StrProperty != nullptr)
+	{
+		return MakeShareable(new FJsonValueString(StrProperty->GetPropertyValue(Value)));
+	}
+
+	const FNameProperty* NameProperty = CastField<FNameProperty>(Property);
+	if (NameProperty != nullptr)
+	{
+		return MakeShareable(new FJsonValueString(NameProperty->GetPropertyValue(Value).ToString()));
+	}
+
+	const FTextProperty* TextProperty = CastField<FTextProperty>(Property);
+	if (TextProperty != nullptr)
+	{
+		return MakeShareable(new FJsonValueString(TextProperty->GetPropertyValue(Value).ToString()));
+	}
+
+	const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property);
+	if (ObjectProperty != nullptr)
+	{
+		const UObject* Object = ObjectProperty->GetObjectPropertyValue(Value);
+		if (Object == nullptr)
+		{
+			return nullptr;
+		}
+		return MakeShareable(new FJsonValueString(Object->GetName()));
+	}
+
+	const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property);
+	if (ArrayProperty != nullptr)
+	{
+		FScriptArrayHelper Helper(ArrayProperty, Value);
+		TArray<TSharedPtr<FJsonValue>> Items;
+		Items.Reserve(Helper.Num());
+		for (int32 i = 0; i < Helper.Num(); i++)
+		{
+			TSharedPtr<FJsonValue> Item = PropertyToJson(ArrayProperty->Inner, Helper.GetRawPtr(i));
+			if (!Item.IsValid())
+			{
+				Item = MakeShareable(new FJsonValueNull());
+			}
+			Items.Add(Item);
+		}
+		return MakeShareable(new FJsonValueArray(Items));
+	}
+
+	// Everything else, e.g. structs, is printed as exported text
+	FString Exported;
+	Property->ExportTextItem(Exported, Value, nullptr, nullptr, PPF_None);
+	return MakeShareable(new FJsonValueString(Exported));
+}
+
+
+bool FSimpleTemplatePropertyDataSource::PropertyToString(const FProperty* Property, const void* Value, FString& OutString)
+{
+	const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property);
+	if (BoolProperty != nullptr)
+	{
+		OutString = BoolProperty->GetPropertyValue(Value) ? TEXT("true") : TEXT("false");
+		return true;
+	}
+
+	const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property);
+	if (EnumProperty != nullptr)
+	{
+		const int64 EnumValue = EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(Value);
+		OutString = EnumProperty->GetEnum()->GetNameStringByValue(EnumValue);
+		return true;
+	}
+
+	const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property);
+	if (NumericProperty != nullptr)
+	{
+		const UEnum* Enum = NumericProperty->GetIntPropertyEnum();
+		if (Enum != nullptr)
+		{
+			OutString = Enum->GetNameStringByValue(NumericProperty->GetSignedIntPropertyValue(Value));
+			return true;
+		}
+
+		// Printed by a json value on the stack, the text matches PropertyToJson
+		const double Number = NumericProperty->IsFloatingPoint() ? NumericProperty->GetFloatingPointPropertyValue(Value) : static_cast<double>(NumericProperty->GetSignedIntPropertyValue(Value));
+		return FJsonValueNumber(Number).TryGetString(OutString);
+	}
+
+	const FStrProperty* StrProperty = CastField<FStrProperty>(Property);
+	if (StrProperty != nullptr)
+	{
+		OutString = StrProperty->GetPropertyValue(Value);
+		return true;
+	}
+
+	const FNameProperty* NameProperty = CastField<FNameProperty>(Property);
+	if (NameProperty != nullptr)
+	{
+		NameProperty->GetPropertyValue(Value).ToString(OutString);
+		return true;
+	}
+
+	const FTextProperty* TextProperty = CastField<FTextProperty>(Property);
+	if (TextProperty != nullptr)
+	{
+		OutString = TextProperty->GetPropertyValue(Value).ToString();
+		return true;
+	}
+
+	const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property);
+	if (ObjectProperty != nullptr)
+	{
+		const UObject* Object = ObjectProperty->GetObjectPropertyValue(Value);
+		if (Object == nullptr)
+		{
+			return false;
+		}
+		Object->GetName(OutString);
+		return true;
+	}
+
+	// Lists have no text
+	if (CastField<FArrayProperty>(Property) != nullptr)
+	{
+		return false;
+	}
+
+	OutString.Reset();
+	Property->ExportTextItem(OutString, Value, nullptr, nullptr, PPF_None);
+	return true;
+}
+
+
+void FSimpleTemplatePropertyDataSource::ResetCache()
+{
+	SimpleTemplatePropertyPath::CacheGeneration.Increment();
+}
+
+
+bool FSimpleTemplatePropertyDataSource::Resolve(const FString& Key, const FProperty*& OutProperty, const void*& OutValue) const
+{
+	if (Key.IsEmpty())
+	{
+		OutProperty = Property;
+		OutValue = Value;
+		return Property != nullptr;
+	}
+	return Struct != nullptr && Container != nullptr && SimpleTemplatePropertyPath::ResolvePath(Struct, Container, Key, OutProperty, OutValue);
+}
@@ -0,0 +1,27 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateStats.h"
+
+DEFINE_STAT(STAT_SimpleTemplate_Compile);
+DEFINE_STAT(STAT_SimpleTemplate_Deserialize);
+DEFINE_STAT(STAT_SimpleTemplate_Interpret);
+
+DEFINE_STAT(STAT_SimpleTemplate_Renders);
+DEFINE_STAT(STAT_SimpleTemplate_Tokens);
+DEFINE_STAT(STAT_SimpleTemplate_Lookups);
+DEFINE_STAT(STAT_SimpleTemplate_LoopIterations);
+DEFINE_STAT(STAT_SimpleTemplate_BytesEmitted);
+DEFINE_STAT(STAT_SimpleTemplate_Allocations);
+
+DEFINE_STAT(STAT_SimpleTemplate_FallbackCompile);
+DEFINE_STAT(STAT_SimpleTemplate_FallbackCompiles);
+DEFINE_STAT(STAT_SimpleTemplate_FallbackCompileFailures);
+
+DEFINE_STAT(STAT_SimpleTemplateLLM_Compiler);
+DEFINE_STAT(STAT_SimpleTemplateLLM_Tokens);
+DEFINE_STAT(STAT_SimpleTemplateLLM_Interpreter);
+DEFINE_STAT(STAT_SimpleTemplateLLM_Data);
+
+#if TPL_TRACE_ENABLED && CPUPROFILERTRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(SimpleTemplateChannel);
+#endif
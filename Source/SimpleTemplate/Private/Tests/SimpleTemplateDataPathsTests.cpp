@@ -0,0 +1,40 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	TArray<FString> CollectPaths(const FString& Source, bool bLiteralKeys = false)
+	{
+		FTokenArray Tokens;
+		FString Error;
+		FTemplateDataPaths Paths(bLiteralKeys);
+		if (Compile(Source, Tokens, Error))
+		{
+			Tokens.CollectDataPaths(Paths);
+		}
+		Paths.Paths.Sort();
+		return Paths.Paths;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateDataPathsTest, "SimpleTemplate.DataPaths", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateDataPathsTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Vars"), CollectPaths(TEXT("{$Name} {$Player.Level}")), TArray<FString>({ TEXT("Name"), TEXT("Player.Level") }));
+	TestEqual(TEXT("Loops"), CollectPaths(TEXT("{% for Item in Items %}{$Item.Name}{$loop.index}{% endfor %}")), TArray<FString>({ TEXT("Items"), TEXT("Items[].Name") }));
+	TestEqual(TEXT("Conditions"), CollectPaths(TEXT("{% if Score > 1 and Name in Admins %}x{% endif %}")), TArray<FString>({ TEXT("Admins"), TEXT("Name"), TEXT("Score") }));
+
+	// Unquoted operands that may be text are not data paths, the render cache still watches them
+	TestEqual(TEXT("Literal operand"), CollectPaths(TEXT("{% if Engine == UE4 %}x{% endif %}")), TArray<FString>({ TEXT("Engine") }));
+	TestEqual(TEXT("Literal operand kept"), CollectPaths(TEXT("{% if Engine == UE4 %}x{% endif %}"), true), TArray<FString>({ TEXT("Engine"), TEXT("UE4") }));
+	return true;
+}
+
+#endif
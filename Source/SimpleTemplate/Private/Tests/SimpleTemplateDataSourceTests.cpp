@@ -0,0 +1,48 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+#include "SimpleTemplatePropertyDataSource.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplatePropertyDataSourceTest, "SimpleTemplate.DataSource.Properties", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplatePropertyDataSourceTest::RunTest(const FString& Parameters)
+{
+	const FTransform Transform(FRotator::ZeroRotator, FVector(1.5f, 2.0f, -3.0f));
+	FSimpleTemplatePropertyDataSource DataSource(TBaseStructure<FTransform>::Get(), &Transform);
+
+	// Strings are read straight from the properties, they match the text of the json values
+	for (const TCHAR* Key : { TEXT("Translation.X"), TEXT("Translation.Y"), TEXT("Translation.Z"), TEXT("Scale3D"), TEXT("Rotation") })
+	{
+		FString Direct;
+		FString Json;
+		const TSharedPtr<FJsonValue> Value = DataSource.GetValue(Key);
+		TestTrue(FString::Printf(TEXT("%s resolves"), Key), DataSource.GetString(Key, Direct) && Value.IsValid() && Value->TryGetString(Json));
+		TestEqual(FString::Printf(TEXT("%s text"), Key), Direct, Json);
+	}
+
+	FString Missing;
+	TestFalse(TEXT("Missing property"), DataSource.GetString(TEXT("Translation.W"), Missing));
+
+	// Paths are resolved again after the cache was reset
+	FSimpleTemplatePropertyDataSource::ResetCache();
+	FString Reset;
+	TestTrue(TEXT("After reset"), DataSource.GetString(TEXT("Translation.X"), Reset) && Reset.StartsWith(TEXT("1.5")));
+
+	// Templates write the values of native sources
+	FTokenArray Tokens;
+	FString Error;
+	if (TestTrue(TEXT("Compiles"), Compile(TEXT("{$Translation.Y}|{% if Translation.Z < 0 %}below{% endif %}"), Tokens, Error)))
+	{
+		FString Output;
+		TTemplateInterpreter(Tokens).Interpret(Output, DataSource);
+		TestTrue(TEXT("Rendered"), Output.StartsWith(TEXT("2")) && Output.EndsWith(TEXT("|below")));
+	}
+	return true;
+}
+
+#endif
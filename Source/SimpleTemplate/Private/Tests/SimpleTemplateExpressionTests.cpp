@@ -0,0 +1,113 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+#include "Compiler/SimpleTemplateExpression.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	const TCHAR* ExpressionData = TEXT("{ \"Score\": 120, \"Cheated\": false, \"Name\": \"Ann\", \"Admins\": [\"Bob\", \"Ann\"],")
+		TEXT(" \"Flags\": { \"fast\": true }, \"Engine\": \"UE4\", \"user-name\": \"dash\", \"path/to\": { \"item\": \"slash\" },")
+		TEXT(" \"Count\": \"7\", \"Player\": { \"Level\": 3 }, \"1st_place\": \"gold\" }");
+
+	FString RenderCondition(const FString& Condition)
+	{
+		return Render(FString::Printf(TEXT("{%% if %s %%}yes{%% endif %%}"), *Condition), ExpressionData);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateExpressionOperatorsTest, "SimpleTemplate.Expression.Operators", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateExpressionOperatorsTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Truthy key"), RenderCondition(TEXT("Name")), TEXT("yes"));
+	TestEqual(TEXT("Missing key"), RenderCondition(TEXT("Missing")), TEXT(""));
+	TestEqual(TEXT("String equality"), RenderCondition(TEXT("Engine == \"UE4\"")), TEXT("yes"));
+	TestEqual(TEXT("Case sensitive"), RenderCondition(TEXT("Engine == \"ue4\"")), TEXT(""));
+	TestEqual(TEXT("Case insensitive"), RenderCondition(TEXT("Engine ~= \"ue4\"")), TEXT("yes"));
+	TestEqual(TEXT("Inequality"), RenderCondition(TEXT("Engine != \"UE5\"")), TEXT("yes"));
+	TestEqual(TEXT("Numbers"), RenderCondition(TEXT("Score >= 100")), TEXT("yes"));
+	TestEqual(TEXT("Numeric strings"), RenderCondition(TEXT("Count < 10")), TEXT("yes"));
+	TestEqual(TEXT("Number text"), RenderCondition(TEXT("Score == \"120\"")), TEXT("yes"));
+	TestEqual(TEXT("Number against text"), RenderCondition(TEXT("Score == Name")), TEXT(""));
+	TestEqual(TEXT("String ordering"), RenderCondition(TEXT("Name < \"Bob\"")), TEXT("yes"));
+	TestEqual(TEXT("Nested key"), RenderCondition(TEXT("Player.Level > 2")), TEXT("yes"));
+	TestEqual(TEXT("Booleans"), RenderCondition(TEXT("Cheated == false")), TEXT("yes"));
+	TestEqual(TEXT("Precedence"), RenderCondition(TEXT("(Score >= 100 and not Cheated) or Missing")), TEXT("yes"));
+	TestEqual(TEXT("Symbols"), RenderCondition(TEXT("!Cheated && (Missing || Name)")), TEXT("yes"));
+	TestEqual(TEXT("In list"), RenderCondition(TEXT("Name in Admins")), TEXT("yes"));
+	TestEqual(TEXT("Not in list"), RenderCondition(TEXT("\"Eve\" not in Admins")), TEXT("yes"));
+	TestEqual(TEXT("In object"), RenderCondition(TEXT("\"fast\" in Flags")), TEXT("yes"));
+	TestEqual(TEXT("In string"), RenderCondition(TEXT("\"E4\" in Engine")), TEXT("yes"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateExpressionKeysTest, "SimpleTemplate.Expression.Keys", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateExpressionKeysTest::RunTest(const FString& Parameters)
+{
+	// Keys of the first 'if' tokens could contain anything but spaces
+	TestEqual(TEXT("Dash"), RenderCondition(TEXT("user-name == \"dash\"")), TEXT("yes"));
+	TestEqual(TEXT("Slash"), RenderCondition(TEXT("path/to.item == \"slash\"")), TEXT("yes"));
+	TestEqual(TEXT("Unquoted literal"), RenderCondition(TEXT("Engine == UE4")), TEXT("yes"));
+	TestEqual(TEXT("Leading digit"), RenderCondition(TEXT("1st_place == \"gold\"")), TEXT("yes"));
+	TestEqual(TEXT("Decimal"), RenderCondition(TEXT("Score > 119.5 and Score > -1")), TEXT("yes"));
+
+	FTemplateExpression Expression;
+	TestTrue(TEXT("Key chars"), Expression.Compile(TEXT("a-b/c.d_e == 1")).IsEmpty());
+	TestEqual(TEXT("Key kept whole"), Expression.GetStrings().Num() > 0 ? Expression.GetStrings()[0] : FString(), TEXT("a-b/c.d_e"));
+	TestEqual(TEXT("Key split"), Expression.GetKeys().Num() > 0 ? Expression.GetKeys()[0].Fields.Num() : 0, 2);
+
+	// Only the key behind the first field is stored, the others are cut when needed
+	const FTemplateKey Key(TEXT("item.stats.level"));
+	TestEqual(TEXT("Whole key"), *Key.FindRest(0), Key.Key);
+	TestEqual(TEXT("Rest"), Key.FindRest(5) != nullptr ? *Key.FindRest(5) : FString(), TEXT("stats.level"));
+	TestNull(TEXT("Rest not stored"), Key.FindRest(11));
+	TestEqual(TEXT("Rest cut"), Key.GetRest(2), TEXT("level"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateExpressionLoopTest, "SimpleTemplate.Expression.Loop", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateExpressionLoopTest::RunTest(const FString& Parameters)
+{
+	// The loop state answers numbers without creating json values
+	FTemplateLoopState LoopState;
+	LoopState.Index = 3;
+	double Number = 0.0;
+	TestTrue(TEXT("Index number"), LoopState.TryGetNumber(TEXT("index"), Number) && Number == 3.0);
+	TestFalse(TEXT("Other number"), LoopState.TryGetNumber(TEXT("other"), Number));
+
+	// And behaves like the json number it used to be
+	TestEqual(TEXT("Compare"), Render(TEXT("{% for Item in Admins %}{% if loop.index > 0 %},{% endif %}{$Item}{% endfor %}"), ExpressionData), TEXT("Bob,Ann"));
+	TestEqual(TEXT("Equal"), Render(TEXT("{% for Item in Admins %}{% if loop.index == 1 %}{$Item}{% endif %}{% endfor %}"), ExpressionData), TEXT("Ann"));
+	TestEqual(TEXT("Text"), Render(TEXT("{% for Item in Admins %}{% if loop.index == \"1\" %}{$Item}{% endif %}{% endfor %}"), ExpressionData), TEXT("Ann"));
+	TestEqual(TEXT("Truthy at zero"), Render(TEXT("{% for Item in Admins %}{% if loop.index %}{$Item}{% endif %}{% endfor %}"), ExpressionData), TEXT("BobAnn"));
+	TestEqual(TEXT("Written"), Render(TEXT("{% for Item in Admins %}{$loop.index}{% endfor %}"), ExpressionData), Render(TEXT("{$Zero}{$One}"), TEXT("{ \"Zero\": 0, \"One\": 1 }")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateExpressionErrorsTest, "SimpleTemplate.Expression.Errors", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateExpressionErrorsTest::RunTest(const FString& Parameters)
+{
+	FTemplateExpression Expression;
+	TestFalse(TEXT("Empty"), Expression.Compile(TEXT("")).IsEmpty());
+	TestFalse(TEXT("Missing operand"), Expression.Compile(TEXT("Score >=")).IsEmpty());
+	TestFalse(TEXT("Unbalanced parentheses"), Expression.Compile(TEXT("(Score > 1")).IsEmpty());
+	TestFalse(TEXT("Unterminated string"), Expression.Compile(TEXT("Name == \"Ann")).IsEmpty());
+	TestFalse(TEXT("Two operands"), Expression.Compile(TEXT("Name Score")).IsEmpty());
+	TestFalse(TEXT("Two dots in a number"), Expression.Compile(TEXT("Score > 1.2.3")).IsEmpty());
+
+	AddExpectedError(TEXT("Line: 1"), EAutomationExpectedErrorFlags::Contains, 1);
+	FTokenArray Tokens;
+	FString Error;
+	TestFalse(TEXT("Template with a bad condition"), Compile(TEXT("{% if Score >= %}x{% endif %}"), Tokens, Error));
+	return true;
+}
+
+#endif
@@ -0,0 +1,105 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/ObjectReader.h"
+#include "Serialization/ObjectWriter.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+#include "UObject/Package.h"
+#include "SimpleTemplate.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+using namespace SimpleTemplateTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateFallbackCompileTest, "SimpleTemplate.Fallback.Compile", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateFallbackCompileTest::RunTest(const FString& Parameters)
+{
+	USimpleTemplate* Template = NewObject<USimpleTemplate>(GetTransientPackage(), NAME_None, RF_Transient);
+
+	// Derived data is shared by templates compiled from the same source with the same options only
+	Template->Escape = ETemplateEscape::None;
+	Template->bStripBlockWhitespace = false;
+	const FString Key = Template->GetDerivedDataKey(TEXT("{$Name}"));
+	TestEqual(TEXT("Same key"), Template->GetDerivedDataKey(TEXT("{$Name}")), Key);
+	TestNotEqual(TEXT("Source in the key"), Template->GetDerivedDataKey(TEXT("{$Other}")), Key);
+	Template->Escape = ETemplateEscape::Html;
+	TestNotEqual(TEXT("Escape in the key"), Template->GetDerivedDataKey(TEXT("{$Name}")), Key);
+	Template->Escape = ETemplateEscape::None;
+	Template->bStripBlockWhitespace = true;
+	TestNotEqual(TEXT("Strip blocks in the key"), Template->GetDerivedDataKey(TEXT("{$Name}")), Key);
+
+	// Loading outdated cooked data with its source starts compiling it on a worker, as PostLoad does
+	int32 Compiles = 0;
+	int32 Failures = 0;
+	USimpleTemplate::GetFallbackCompileCounts(Compiles, Failures);
+	Template->Status = ETemplateStatus::TS_Dirty;
+	Template->Tokens.Reset();
+	Template->DataPaths.Reset();
+	Template->FallbackSource = MakeUnique<FSimpleTemplateFallbackSource>();
+	Template->FallbackSource->Source = TEXT("Hello {$Name}!");
+	Template->bNeedsFallbackCompile = true;
+	Template->PreloadAsync();
+
+	// The first render and the data paths wait for it
+	TestEqual(TEXT("Rendered"), Template->Interpret(ParseJson(TEXT("{ \"Name\": \"Ann\" }"))), TEXT("Hello Ann!"));
+	TestTrue(TEXT("Up to date"), Template->IsUpToDate());
+	TestTrue(TEXT("Data paths"), Template->GetDataPaths() == TArray<FString>({ TEXT("Name") }));
+	int32 NewCompiles = 0;
+	USimpleTemplate::GetFallbackCompileCounts(NewCompiles, Failures);
+	TestEqual(TEXT("Counted"), NewCompiles, Compiles + 1);
+
+	// Sources that do not compile leave the template in error, the compiler and the fallback compile log it
+	AddExpectedError(TEXT("Missing end token"), EAutomationExpectedErrorFlags::Contains, 2);
+	Template->Status = ETemplateStatus::TS_Dirty;
+	Template->FallbackSource = MakeUnique<FSimpleTemplateFallbackSource>();
+	Template->FallbackSource->Source = TEXT("{% if Name %}");
+	Template->bNeedsFallbackCompile = true;
+	Template->PreloadAsync();
+	TestEqual(TEXT("Failed render"), Template->Interpret(ParseJson(TEXT("{}"))), FString());
+	TestTrue(TEXT("Error"), Template->IsError());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateDeferredViewTest, "SimpleTemplate.Program.DeferredView", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateDeferredViewTest::RunTest(const FString& Parameters)
+{
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiled"), Compile(TEXT("{% for Item in Items %}{$Item.Name} {% endfor %}"), Tokens, Error)))
+	{
+		return false;
+	}
+
+	// A template holding a flat program, as cooked ones do
+	USimpleTemplate* Cooked = NewObject<USimpleTemplate>(GetTransientPackage(), NAME_None, RF_Transient);
+	Cooked->SetCompiledTokens(Tokens);
+	Cooked->Program.Build(Cooked->Tokens);
+	Cooked->Tokens.Reset();
+	Cooked->Status = ETemplateStatus::TS_UpToDate;
+	TArray<uint8> Bytes;
+	FObjectWriter Writer(Cooked, Bytes);
+
+	IConsoleVariable* DeferredLoad = IConsoleManager::Get().FindConsoleVariable(TEXT("SimpleTemplate.DeferredLoad"));
+	const int32 PreviousDeferredLoad = DeferredLoad->GetInt();
+	DeferredLoad->Set(1);
+	USimpleTemplate* Loaded = NewObject<USimpleTemplate>(GetTransientPackage(), NAME_None, RF_Transient);
+	FObjectReader Reader(Loaded, Bytes);
+	DeferredLoad->Set(PreviousDeferredLoad);
+
+	// The program renders from the deferred data, it is not copied
+	const FString Data = TEXT("{ \"Items\": [ { \"Name\": \"a\" }, { \"Name\": \"b\" } ] }");
+	TestEqual(TEXT("Rendered"), Loaded->Interpret(ParseJson(Data)), TEXT("a b "));
+	TestTrue(TEXT("Program"), Loaded->Program.IsValid() && Loaded->Tokens.Items.Num() == 0);
+	TestTrue(TEXT("View"), Loaded->ProgramData.Num() > 0 && Loaded->PendingData.Num() == 0);
+
+	// Compiling again drops the view and its data
+	Loaded->SetCompiledTokens(Tokens);
+	TestFalse(TEXT("View dropped"), Loaded->Program.IsValid() || Loaded->ProgramData.Num() > 0);
+	TestEqual(TEXT("Rendered tokens"), Loaded->Interpret(ParseJson(Data)), TEXT("a b "));
+	return true;
+}
+
+#endif
@@ -0,0 +1,96 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	const TCHAR* FilterData = TEXT("{ \"Name\": \"  ann lee  \", \"Markup\": \"<a href=\\\"x\\\">Tom & 'Jerry'</a>\", \"Cell\": \"a,\\\"b\\\"\", \"Empty\": \"\" }");
+
+	void ReverseFilter(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		TCHAR* Chars = Value.GetChars();
+		for (int32 i = 0; i < Value.Len / 2; i++)
+		{
+			Swap(Chars[i], Chars[Value.Len - 1 - i]);
+		}
+	}
+
+	void ShoutFilter(FTemplateFilterValue& Value, const FTemplateFilterCall& Call)
+	{
+		Value.Set(FString(Value.GetChars(), Value.Len) + TEXT("!"));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateEscapeTest, "SimpleTemplate.Filters.Escape", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateEscapeTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Html"), Render(TEXT("{$Markup|html}"), FilterData), TEXT("&lt;a href=&quot;x&quot;&gt;Tom &amp; &#39;Jerry&#39;&lt;/a&gt;"));
+	TestEqual(TEXT("Json"), Render(TEXT("{$Markup|json}"), FilterData), TEXT("<a href=\\\"x\\\">Tom & 'Jerry'</a>"));
+	TestEqual(TEXT("Csv"), Render(TEXT("{$Cell|csv}"), FilterData), TEXT("\"a,\"\"b\"\"\""));
+
+	// The template default applies to vars without an escape filter of their own
+	FOptions Options;
+	Options.Escape = ETemplateEscape::Html;
+	TestEqual(TEXT("Default escape"), Render(TEXT("{$Markup}"), FilterData, Options), TEXT("&lt;a href=&quot;x&quot;&gt;Tom &amp; &#39;Jerry&#39;&lt;/a&gt;"));
+	TestEqual(TEXT("Raw"), Render(TEXT("{$Markup|raw}"), FilterData, Options), TEXT("<a href=\"x\">Tom & 'Jerry'</a>"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateFiltersTest, "SimpleTemplate.Filters.Chain", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateFiltersTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Trim"), Render(TEXT("[{$Name|trim}]"), FilterData), TEXT("[ann lee]"));
+	TestEqual(TEXT("Chain"), Render(TEXT("[{$Name|trim|capitalize|truncate:5}]"), FilterData), TEXT("[Ann l]"));
+	TestEqual(TEXT("Upper then escape"), Render(TEXT("{$Markup|upper|html}"), FilterData), TEXT("&lt;A HREF=&quot;X&quot;&gt;TOM &amp; &#39;JERRY&#39;&lt;/A&gt;"));
+	TestEqual(TEXT("Default of missing"), Render(TEXT("{$Missing|default:\"none\"}"), FilterData), TEXT("none"));
+	TestEqual(TEXT("Default of empty"), Render(TEXT("{$Empty|default:\"none\"}"), FilterData), TEXT("none"));
+	TestEqual(TEXT("Bar in quotes"), Render(TEXT("{$Missing|default:\"a|b\"|upper}"), FilterData), TEXT("A|B"));
+	TestEqual(TEXT("Colon in quotes"), Render(TEXT("{$Missing|default:\"a:b\"}"), FilterData), TEXT("a:b"));
+
+	// Tokens and programs run the same filters
+	FTokenArray Tokens;
+	FString Error;
+	if (TestTrue(TEXT("Compiles"), Compile(TEXT("{$Name|trim|upper|html}|{$Missing|default:\"x|y\"}"), Tokens, Error)))
+	{
+		FTemplateProgram Program;
+		Program.Build(Tokens);
+		TestEqual(TEXT("Program"), Render(Program, FilterData), Render(Tokens, FilterData));
+	}
+
+	AddExpectedError(TEXT("filter"), EAutomationExpectedErrorFlags::Contains, 0);
+	TestFalse(TEXT("Unknown filter"), Compile(TEXT("{$Name|nope}"), Tokens, Error));
+	TestFalse(TEXT("Number argument"), Compile(TEXT("{$Name|truncate:x}"), Tokens, Error));
+	TestFalse(TEXT("Escape not last"), Compile(TEXT("{$Name|html|upper}"), Tokens, Error));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateFilterRegistryTest, "SimpleTemplate.Filters.Registry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateFilterRegistryTest::RunTest(const FString& Parameters)
+{
+	FTemplateFilters::Register(TEXT("testreverse"), &ReverseFilter);
+	FTokenArray Tokens;
+	FString Error;
+	if (TestTrue(TEXT("Compiles"), Compile(TEXT("{$Name|trim|testreverse}"), Tokens, Error)))
+	{
+		FTemplateProgram Program;
+		Program.Build(Tokens);
+		TestEqual(TEXT("Registered"), Render(Tokens, FilterData), TEXT("eel nna"));
+
+		// Compiled tokens and programs use the filter registered last under the name
+		FTemplateFilters::Register(TEXT("testreverse"), &ShoutFilter);
+		TestEqual(TEXT("Registered again"), Render(Tokens, FilterData), TEXT("ann lee!"));
+		TestEqual(TEXT("Registered again, program"), Render(Program, FilterData), TEXT("ann lee!"));
+	}
+	FTemplateFilters::Register(TEXT("testreverse"), &ReverseFilter);
+	return true;
+}
+
+#endif
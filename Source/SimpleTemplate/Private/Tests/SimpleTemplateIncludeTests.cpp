@@ -0,0 +1,120 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateIncludeTest, "SimpleTemplate.Include.Include", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateIncludeTest::RunTest(const FString& Parameters)
+{
+	FOptions Options;
+	Options.Path = TEXT("/Game/Pages/Root");
+	Options.Includes.Add(TEXT("/Game/Pages/Header"), TEXT("<h>{$Title}</h>"));
+	TestEqual(TEXT("Include"), Render(TEXT("{% include Header %}body"), TEXT("{ \"Title\": \"T\" }"), Options), TEXT("<h>T</h>body"));
+
+	// Nested includes resolve next to the template including them, not next to the compiled one
+	Options.Includes.Add(TEXT("/Game/Widgets/Outer"), TEXT("[{% include Inner %}]"));
+	Options.Includes.Add(TEXT("/Game/Widgets/Inner"), TEXT("widgets"));
+	Options.Includes.Add(TEXT("/Game/Pages/Inner"), TEXT("pages"));
+	TestEqual(TEXT("Nested include"), Render(TEXT("{% include /Game/Widgets/Outer %}"), TEXT("{}"), Options), TEXT("[widgets]"));
+
+	TSharedRef<TTemplateTokenizer<TCHAR>> Compiler = CreateCompiler(TEXT("{% include /Game/Widgets/Outer %}{% include Inner %}"), Options);
+	if (TestTrue(TEXT("Compiles"), Compiler->Compile()))
+	{
+		TestEqual(TEXT("Include paths"), Compiler->GetIncludes(), TArray<FString>({ TEXT("/Game/Widgets/Outer"), TEXT("/Game/Widgets/Inner"), TEXT("/Game/Pages/Inner") }));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateIncludeLocationTest, "SimpleTemplate.Include.Location", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateIncludeLocationTest::RunTest(const FString& Parameters)
+{
+	FOptions Options;
+	Options.Path = TEXT("/Game/Root");
+	Options.Includes.Add(TEXT("/Game/List"), TEXT("{% for Item in Items %}\n{% if Item %}{$Item}{% endif %}{% endfor %}\n{% include Inner %}"));
+	Options.Includes.Add(TEXT("/Game/Inner"), TEXT("{% if Show %}\n\n{$Name}{% endif %}"));
+
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(TEXT("first\n  {% include List %}"), Tokens, Error, Options)))
+	{
+		return true;
+	}
+
+	// Every token of the included templates is located at the tag, nested tokens and nested includes too
+	TArray<const FTokenArray*> Lists = { &Tokens };
+	int32 NumIncluded = 0;
+	while (Lists.Num() > 0)
+	{
+		for (const FToken* Token : Lists.Pop()->Items)
+		{
+			if (Token->bIncluded)
+			{
+				NumIncluded++;
+				TestTrue(TEXT("At the tag"), Token->Line == 1 && Token->Column == 2);
+			}
+			else
+			{
+				TestEqual(TEXT("Own line"), Token->Line, 0);
+			}
+			if (Token->GetType() == ETokenType::For || Token->GetType() == ETokenType::If)
+			{
+				Lists.Add(&static_cast<const FTokenNested*>(Token)->Children);
+			}
+		}
+	}
+	TestEqual(TEXT("Included tokens"), NumIncluded, 8);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateIncludeErrorsTest, "SimpleTemplate.Include.Errors", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateIncludeErrorsTest::RunTest(const FString& Parameters)
+{
+	AddExpectedError(TEXT("not found"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("includes or extends itself"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	FOptions Options;
+	Options.Path = TEXT("/Game/A");
+	Options.Includes.Add(TEXT("/Game/A"), TEXT("{% include B %}"));
+	Options.Includes.Add(TEXT("/Game/B"), TEXT("{% include A %}"));
+
+	FTokenArray Tokens;
+	FString Error;
+	TestFalse(TEXT("Missing"), Compile(TEXT("{% include Missing %}"), Tokens, Error, Options));
+	TestTrue(TEXT("Missing error"), Error.Contains(TEXT("not found")));
+	TestFalse(TEXT("Self"), Compile(TEXT("{% include A %}"), Tokens, Error, Options));
+	TestTrue(TEXT("Self error"), Error.Contains(TEXT("itself")));
+	TestFalse(TEXT("Cycle"), Compile(TEXT("{% include B %}"), Tokens, Error, Options));
+	TestTrue(TEXT("Cycle error"), Error.Contains(TEXT("itself")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateExtendsTest, "SimpleTemplate.Include.Extends", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateExtendsTest::RunTest(const FString& Parameters)
+{
+	FOptions Options;
+	Options.Path = TEXT("/Game/Pages/Page");
+	Options.Includes.Add(TEXT("/Game/Layouts/Base"), TEXT("<{% block Head %}head{% endblock %}|{% block Body %}body{% endblock %}>{% include Footer %}"));
+	Options.Includes.Add(TEXT("/Game/Layouts/Footer"), TEXT("!"));
+	Options.Includes.Add(TEXT("/Game/Layouts/Middle"), TEXT("{% extends Base %}{% block Head %}middle{% endblock %}"));
+
+	const FString Json = TEXT("{ \"Name\": \"Ann\" }");
+	TestEqual(TEXT("Override"), Render(TEXT("{% extends /Game/Layouts/Base %}{% block Body %}Hi {$Name}{% endblock %}"), Json, Options), TEXT("<head|Hi Ann>!"));
+	TestEqual(TEXT("Defaults"), Render(TEXT("{% extends /Game/Layouts/Base %}"), Json, Options), TEXT("<head|body>!"));
+	TestEqual(TEXT("Extended again"), Render(TEXT("{% extends /Game/Layouts/Middle %}{% block Body %}page{% endblock %}"), Json, Options), TEXT("<middle|page>!"));
+
+	AddExpectedError(TEXT("is not defined"), EAutomationExpectedErrorFlags::Contains, 0);
+	FTokenArray Tokens;
+	FString Error;
+	TestFalse(TEXT("Unknown block"), Compile(TEXT("{% extends /Game/Layouts/Base %}{% block Nope %}x{% endblock %}"), Tokens, Error, Options));
+	return true;
+}
+
+#endif
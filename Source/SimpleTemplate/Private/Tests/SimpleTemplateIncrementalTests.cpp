@@ -0,0 +1,263 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	/** The first difference of two token trees, empty if they are the same */
+	FString CompareTokens(const FTokenArray& Expected, const FTokenArray& Actual, const FString& Location = FString())
+	{
+		if (Expected.Items.Num() != Actual.Items.Num())
+		{
+			return FString::Printf(TEXT("%s: %d tokens instead of %d"), *Location, Actual.Items.Num(), Expected.Items.Num());
+		}
+		for (int32 i = 0; i < Expected.Items.Num(); i++)
+		{
+			const FToken* A = Expected.Items[i];
+			const FToken* B = Actual.Items[i];
+			const FString Where = FString::Printf(TEXT("%s/%d"), *Location, i);
+			if (A->GetType() != B->GetType())
+			{
+				return Where + TEXT(": other type");
+			}
+			if (A->Line != B->Line || A->Column != B->Column)
+			{
+				return FString::Printf(TEXT("%s: at %d:%d instead of %d:%d"), *Where, B->Line, B->Column, A->Line, A->Column);
+			}
+			if (A->bIncluded != B->bIncluded)
+			{
+				return Where + TEXT(": other include marker");
+			}
+			switch (A->GetType())
+			{
+			case ETokenType::Text:
+				if (!static_cast<const FTokenText*>(A)->Text.Equals(static_cast<const FTokenText*>(B)->Text, ESearchCase::CaseSensitive))
+				{
+					return Where + TEXT(": other text");
+				}
+				break;
+			case ETokenType::Var:
+				if (!static_cast<const FTokenVar*>(A)->Key.Equals(static_cast<const FTokenVar*>(B)->Key, ESearchCase::CaseSensitive))
+				{
+					return Where + TEXT(": other key");
+				}
+				break;
+			case ETokenType::For:
+			case ETokenType::If:
+				{
+					const FTokenNested* NestedA = static_cast<const FTokenNested*>(A);
+					const FTokenNested* NestedB = static_cast<const FTokenNested*>(B);
+					if (!NestedA->Expression.Equals(NestedB->Expression, ESearchCase::CaseSensitive))
+					{
+						return Where + TEXT(": other expression");
+					}
+					const FString Difference = CompareTokens(NestedA->Children, NestedB->Children, Where);
+					if (!Difference.IsEmpty())
+					{
+						return Difference;
+					}
+				}
+				break;
+			default:
+				break;
+			}
+		}
+		return FString();
+	}
+
+	/** Compiles every version of a template from scratch and from the state of the version before */
+	struct FIncrementalCompiles
+	{
+		FOptions Options;
+		TSharedPtr<const FTemplateTokenizerState, ESPMode::ThreadSafe> State;
+
+		// What the incremental compile got wrong, empty if both compiles are the same
+		FString Compile(const FString& Source)
+		{
+			TSharedRef<TTemplateTokenizer<TCHAR>> Scratch = CreateCompiler(Source, Options);
+			if (!Scratch->Compile())
+			{
+				return TEXT("From scratch: ") + Scratch->GetLastError();
+			}
+			TSharedRef<TTemplateTokenizer<TCHAR>> Incremental = CreateCompiler(Source, Options);
+			Incremental->SetPrevious(State);
+			if (!Incremental->Compile())
+			{
+				return TEXT("Incremental: ") + Incremental->GetLastError();
+			}
+			State = Incremental->GetState();
+
+			const FString Difference = CompareTokens(Scratch->GetTokenTree(), Incremental->GetTokenTree());
+			if (!Difference.IsEmpty())
+			{
+				return Difference;
+			}
+			if (Scratch->GetIncludes() != Incremental->GetIncludes())
+			{
+				return FString::Printf(TEXT("Includes %s instead of %s"), *FString::Join(Incremental->GetIncludes(), TEXT(",")), *FString::Join(Scratch->GetIncludes(), TEXT(",")));
+			}
+			return FString();
+		}
+	};
+
+	/** A template of whole lines, tags are on lines of their own and balanced */
+	struct FRandomTemplate
+	{
+		// The lines and the pair of tags each belongs to, INDEX_NONE for text
+		TArray<FString> Lines;
+		TArray<int32> Pairs;
+		int32 NextPair = 0;
+
+		FString GetSource() const
+		{
+			return FString::Join(Lines, TEXT(""));
+		}
+
+		bool IsPlainText(int32 Index) const
+		{
+			return Pairs[Index] == INDEX_NONE && !Lines[Index].Contains(TEXT("{"));
+		}
+
+		void Insert(int32 Index, const FString& Line, int32 Pair = INDEX_NONE)
+		{
+			Lines.Insert(Line, Index);
+			Pairs.Insert(Pair, Index);
+		}
+
+		void Edit(FRandomStream& Random)
+		{
+			static const TCHAR* TextLines[] = { TEXT("text\n"), TEXT("  indented text\n"), TEXT("{$Name} and {$Player.Score|upper}\n"), TEXT("\n"), TEXT("  {% include Part %}\n") };
+			static const TCHAR* Tags[][2] = {
+				{ TEXT("{% if Show %}\n"), TEXT("{% endif %}\n") },
+				{ TEXT("  {% for Item in Items %}\n"), TEXT("  {% endfor %}\n") },
+				{ TEXT("{%- if Name -%}\n"), TEXT("{% endif -%}\n") },
+				{ TEXT("{% if Show %} inline\n"), TEXT("tail {% endif %}  \n") }
+			};
+			static const TCHAR Chars[] = { TCHAR('x'), TCHAR(' '), TCHAR('\t'), TCHAR('\n'), TCHAR('-') };
+
+			const int32 Index = Random.RandHelper(Lines.Num());
+			switch (Random.RandHelper(5))
+			{
+			case 0:
+				Insert(Random.RandHelper(Lines.Num() + 1), TextLines[Random.RandHelper(ARRAY_COUNT(TextLines))]);
+				break;
+			case 1:
+				if (Lines.Num() > 1 && Pairs[Index] == INDEX_NONE)
+				{
+					Lines.RemoveAt(Index);
+					Pairs.RemoveAt(Index);
+				}
+				break;
+			case 2:
+				// Wrap a line or nothing in a pair of tags
+				if (Pairs[Index] == INDEX_NONE)
+				{
+					const int32 Kind = Random.RandHelper(ARRAY_COUNT(Tags));
+					const int32 Pair = NextPair++;
+					Insert(Index + Random.RandHelper(2), Tags[Kind][1], Pair);
+					Insert(Index, Tags[Kind][0], Pair);
+				}
+				break;
+			case 3:
+				// Unwrap, the tags of a pair are removed together
+				if (Lines.Num() > 2 && Pairs[Index] != INDEX_NONE)
+				{
+					const int32 Pair = Pairs[Index];
+					for (int32 i = Lines.Num() - 1; i >= 0; i--)
+					{
+						if (Pairs[i] == Pair)
+						{
+							Lines.RemoveAt(i);
+							Pairs.RemoveAt(i);
+						}
+					}
+				}
+				break;
+			default:
+				// Type or delete a char in plain text
+				if (IsPlainText(Index))
+				{
+					FString& Line = Lines[Index];
+					const int32 Position = Random.RandHelper(Line.Len() + 1);
+					if (Random.RandHelper(2) == 0 || Line.Len() <= 1)
+					{
+						Line.InsertAt(Position, Chars[Random.RandHelper(ARRAY_COUNT(Chars))]);
+					}
+					else
+					{
+						Line.RemoveAt(FMath::Min(Position, Line.Len() - 1));
+					}
+				}
+				break;
+			}
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateIncrementalRandomEditsTest, "SimpleTemplate.Incremental.RandomEdits", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateIncrementalRandomEditsTest::RunTest(const FString& Parameters)
+{
+	for (const bool bStripBlocks : { false, true })
+	{
+		FIncrementalCompiles Compiles;
+		Compiles.Options.bStripBlocks = bStripBlocks;
+		Compiles.Options.Path = TEXT("/Game/Main");
+		Compiles.Options.Includes.Add(TEXT("/Game/Part"), TEXT("part {$Name}\n"));
+
+		FRandomTemplate Template;
+		Template.Insert(0, TEXT("header\n"));
+		Template.Insert(1, TEXT("{$Name}\n"));
+		Template.Insert(2, TEXT("footer\n"));
+
+		FRandomStream Random(bStripBlocks ? 17 : 42);
+		for (int32 Step = 0; Step < 300; Step++)
+		{
+			const FString Source = Template.GetSource();
+			const FString Difference = Compiles.Compile(Source);
+			if (!Difference.IsEmpty())
+			{
+				AddError(FString::Printf(TEXT("Strip blocks %d, edit %d: %s\n%s"), bStripBlocks ? 1 : 0, Step, *Difference, *Source));
+				break;
+			}
+			Template.Edit(Random);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateIncrementalIncludesTest, "SimpleTemplate.Incremental.Includes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateIncrementalIncludesTest::RunTest(const FString& Parameters)
+{
+	FIncrementalCompiles Compiles;
+	Compiles.Options.Path = TEXT("/Game/Main");
+	Compiles.Options.Includes.Add(TEXT("/Game/Part"), TEXT("part\n"));
+	Compiles.Options.Includes.Add(TEXT("/Game/Other"), TEXT("other\n"));
+
+	TestEqual(TEXT("First"), Compiles.Compile(TEXT("a\n{% include Part %}\nb\n{% include Other %}\n")), FString());
+
+	// Includes in front of, inside and behind the edit are all listed
+	TestEqual(TEXT("Edit between"), Compiles.Compile(TEXT("a\n{% include Part %}\nb x\n{% include Other %}\n")), FString());
+	TestEqual(TEXT("Include removed"), Compiles.Compile(TEXT("a\n{% include Part %}\nb x\n")), FString());
+	TestEqual(TEXT("Include added"), Compiles.Compile(TEXT("a\n{% include Other %}\n{% include Part %}\nb x\n")), FString());
+
+	// Changed sources of included templates are noticed
+	Compiles.Options.Includes.Add(TEXT("/Game/Part"), TEXT("changed\n"));
+	TestEqual(TEXT("Include changed"), Compiles.Compile(TEXT("a\n{% include Other %}\n{% include Part %}\nb y\n")), FString());
+
+	// And so are templates that moved, relative includes resolve next to them
+	Compiles.Options.Path = TEXT("/Game/Moved/Main");
+	Compiles.Options.Includes.Add(TEXT("/Game/Moved/Part"), TEXT("moved\n"));
+	Compiles.Options.Includes.Add(TEXT("/Game/Moved/Other"), TEXT("moved other\n"));
+	TestEqual(TEXT("Template moved"), Compiles.Compile(TEXT("a\n{% include Other %}\n{% include Part %}\nb z\n")), FString());
+	return true;
+}
+
+#endif
@@ -0,0 +1,75 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/Package.h"
+#include "SimpleTemplate.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	void RenderNative(FTemplateCompilerContent& Context, FArchive& WriteStream)
+	{
+		static const TCHAR Text[] = TEXT("native");
+		WriteStream.Serialize((void*)Text, 6 * sizeof(TCHAR));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateNativeRegistryTest, "SimpleTemplate.Native.Registry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateNativeRegistryTest::RunTest(const FString& Parameters)
+{
+	USimpleTemplate* Template = NewObject<USimpleTemplate>(GetTransientPackage(), NAME_None, RF_Transient);
+	Template->Template = FText::FromString(TEXT("interpreted"));
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Template->Compile() && Compile(TEXT("interpreted"), Tokens, Error)))
+	{
+		return true;
+	}
+	FTemplateProgram Program;
+	Program.Build(Tokens);
+	const FString Path = Template->GetPathName();
+	const TSharedPtr<FJsonObject> Data = MakeShared<FJsonObject>();
+	TestEqual(TEXT("Interpreted"), Template->Interpret(Data), TEXT("interpreted"));
+
+	// Functions registered after the template looked for one are found
+	const int32 Generation = FTemplateNativeRegistry::GetGeneration();
+	FTemplateNativeRegistry::Register(Path, Program.GetCrc(), &RenderNative);
+	TestNotEqual(TEXT("Generation"), FTemplateNativeRegistry::GetGeneration(), Generation);
+	TestEqual(TEXT("Registered"), Template->Interpret(Data), TEXT("native"));
+
+	// Native renders are profiled as a whole, without a token
+	FTemplateProfiler Profiler;
+	FTemplateCompilerContent Context;
+	Context.Profiler = &Profiler;
+	TArray<uint8> Output;
+	FMemoryWriter Writer(Output);
+	{
+		FTemplateProfileScope ProfileScope(Context, nullptr, Writer);
+		RenderNative(Context, Writer);
+	}
+	FSimpleTemplateProfile Report;
+	Profiler.BuildReport(1, Report);
+	if (TestEqual(TEXT("Profiled"), Report.Tokens.Num(), 1))
+	{
+		TestEqual(TEXT("Profiled bytes"), Report.Tokens[0].OutputBytes, Output.Num());
+		TestEqual(TEXT("Profiled line"), Report.Tokens[0].Line, (int32)INDEX_NONE);
+	}
+
+	// And dropped once their module is gone
+	FTemplateNativeRegistry::Unregister(Path);
+	TestEqual(TEXT("Unregistered"), Template->Interpret(Data), TEXT("interpreted"));
+
+	AddExpectedError(TEXT("is outdated"), EAutomationExpectedErrorFlags::Contains, 1);
+	FTemplateNativeRegistry::Register(Path, Program.GetCrc() + 1, &RenderNative);
+	TestEqual(TEXT("Outdated"), Template->Interpret(Data), TEXT("interpreted"));
+	FTemplateNativeRegistry::Unregister(Path);
+	return true;
+}
+
+#endif
@@ -0,0 +1,185 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	const TCHAR* ProgramSource = TEXT("<h1>{$Title|upper}</h1>{% for Item in Items %}{% if Item.Price > 10 and Item.Name != \"Hidden\" %}")
+		TEXT("<li>{$Item.Name|html}</li>{% endif %}{% endfor %}{$Missing|default:\"none\"}");
+
+	const TCHAR* ProgramData = TEXT("{ \"Title\": \"Shop\", \"Items\": [ { \"Name\": \"A&B\", \"Price\": 20 }, { \"Name\": \"Hidden\", \"Price\": 30 }, { \"Name\": \"C\", \"Price\": 5 } ] }");
+
+	/** Copy a program into memory aligned for InitializeView */
+	struct FProgramMemory
+	{
+		explicit FProgramMemory(const TArray<uint8>& Bytes)
+			: Data(FMemory::Malloc(Bytes.Num(), TPL_PROGRAM_ALIGNMENT))
+			, Size(Bytes.Num())
+		{
+			FMemory::Memcpy(Data, Bytes.GetData(), Size);
+		}
+
+		~FProgramMemory()
+		{
+			FMemory::Free(Data);
+		}
+
+		FTemplateProgramHeader& GetHeader()
+		{
+			return *static_cast<FTemplateProgramHeader*>(Data);
+		}
+
+		FTemplateInstruction* GetInstructions()
+		{
+			return reinterpret_cast<FTemplateInstruction*>(static_cast<uint8*>(Data) + GetHeader().InstructionsOffset);
+		}
+
+		void* Data;
+		int32 Size;
+	};
+
+	/** The program bytes without the size in front */
+	TArray<uint8> SaveProgram(FTemplateProgram& Program)
+	{
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		Program.Serialize(Writer);
+		Bytes.RemoveAt(0, sizeof(int32));
+		return Bytes;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateProgramRoundTripTest, "SimpleTemplate.Program.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateProgramRoundTripTest::RunTest(const FString& Parameters)
+{
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(ProgramSource, Tokens, Error)))
+	{
+		return false;
+	}
+	const FString Expected = Render(Tokens, ProgramData);
+	TestEqual(TEXT("Token output"), Expected, TEXT("<h1>SHOP</h1><li>A&amp;B</li>none"));
+
+	FTemplateProgram Program;
+	Program.Build(Tokens);
+	TestEqual(TEXT("Built program"), Render(Program, ProgramData), Expected);
+
+	// Saved and loaded with a single read
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Program.Serialize(Writer);
+	FTemplateProgram Loaded;
+	FMemoryReader Reader(Bytes);
+	Loaded.Serialize(Reader);
+	TestTrue(TEXT("Loaded"), Loaded.IsValid() && !Reader.IsError());
+	TestEqual(TEXT("Loaded crc"), Loaded.GetCrc(), Program.GetCrc());
+	TestEqual(TEXT("Loaded program"), Render(Loaded, ProgramData), Expected);
+
+	// Used in place
+	FProgramMemory Memory(SaveProgram(Program));
+	FTemplateProgram View;
+	TestTrue(TEXT("View"), View.InitializeView(Memory.Data, Memory.Size));
+	TestEqual(TEXT("View program"), Render(View, ProgramData), Expected);
+
+	// Tokens rebuilt from the program render the same
+	FTokenArray Rebuilt;
+	Program.ToTokens(Rebuilt);
+	TestEqual(TEXT("Rebuilt tokens"), Render(Rebuilt, ProgramData), Expected);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateProgramValidationTest, "SimpleTemplate.Program.Validation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateProgramValidationTest::RunTest(const FString& Parameters)
+{
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(ProgramSource, Tokens, Error)))
+	{
+		return false;
+	}
+	FTemplateProgram Program;
+	Program.Build(Tokens);
+	const TArray<uint8> Bytes = SaveProgram(Program);
+
+	// A size past the end of the archive is rejected before allocating it
+	{
+		TArray<uint8> Truncated;
+		FMemoryWriter Writer(Truncated);
+		int32 Size = MAX_int32;
+		Writer << Size;
+		Truncated.Append(Bytes);
+		FMemoryReader Reader(Truncated);
+		FTemplateProgram Loaded;
+		Loaded.Serialize(Reader);
+		TestTrue(TEXT("Oversized program"), !Loaded.IsValid() && Reader.IsError());
+	}
+
+	AddExpectedError(TEXT("Template program has invalid instructions"), EAutomationExpectedErrorFlags::Contains, 5);
+
+	// A string index out of the pool
+	{
+		FProgramMemory Memory(Bytes);
+		Memory.GetInstructions()[0].First = Memory.GetHeader().NumStrings;
+		FTemplateProgram View;
+		TestFalse(TEXT("String index"), View.InitializeView(Memory.Data, Memory.Size));
+	}
+
+	// A body ending in front of its instruction
+	{
+		FProgramMemory Memory(Bytes);
+		for (int32 i = 0; i < Memory.GetHeader().NumInstructions; i++)
+		{
+			if (Memory.GetInstructions()[i].Type == ETemplateInstruction::For)
+			{
+				Memory.GetInstructions()[i].End = i;
+			}
+		}
+		FTemplateProgram View;
+		TestFalse(TEXT("Body end"), View.InitializeView(Memory.Data, Memory.Size));
+	}
+
+	// A condition with more ops than the program has
+	{
+		FProgramMemory Memory(Bytes);
+		for (int32 i = 0; i < Memory.GetHeader().NumInstructions; i++)
+		{
+			if (Memory.GetInstructions()[i].Type == ETemplateInstruction::If)
+			{
+				Memory.GetInstructions()[i].Second = Memory.GetHeader().NumExpressionOps + 1;
+			}
+		}
+		FTemplateProgram View;
+		TestFalse(TEXT("Expression ops"), View.InitializeView(Memory.Data, Memory.Size));
+	}
+
+	// A string past the characters
+	{
+		FProgramMemory Memory(Bytes);
+		FTemplateProgramString* Strings = reinterpret_cast<FTemplateProgramString*>(static_cast<uint8*>(Memory.Data) + Memory.GetHeader().StringsOffset);
+		Strings[0].Len = Memory.Size;
+		FTemplateProgram View;
+		TestFalse(TEXT("String length"), View.InitializeView(Memory.Data, Memory.Size));
+	}
+
+	// A filter argument out of the pool
+	{
+		FProgramMemory Memory(Bytes);
+		FTemplateProgramFilter* Filters = reinterpret_cast<FTemplateProgramFilter*>(static_cast<uint8*>(Memory.Data) + Memory.GetHeader().FiltersOffset);
+		Filters[0].Argument = Memory.GetHeader().NumStrings;
+		FTemplateProgram View;
+		TestFalse(TEXT("Filter string"), View.InitializeView(Memory.Data, Memory.Size));
+	}
+	return true;
+}
+
+#endif
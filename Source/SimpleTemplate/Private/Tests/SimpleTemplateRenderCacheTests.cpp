@@ -0,0 +1,123 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+#include "Compiler/SimpleTemplateRenderCache.h"
+#include "Compiler/SimpleTemplateProgram.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	FString RenderCached(FTemplateRenderCache& Cache, const FTokenArray& Tokens, const TSharedPtr<FJsonObject>& Data, const TArray<FString>& ChangedPaths)
+	{
+		FScopedTemplateRenderContext RenderContext;
+		FString Output;
+		Cache.Interpret(Tokens, RenderContext->Begin(Data), ChangedPaths, Output);
+		RenderContext->Reset();
+		return Output;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateRenderCacheTest, "SimpleTemplate.RenderCache", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateRenderCacheTest::RunTest(const FString& Parameters)
+{
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(TEXT("{$Title}:{% for Item in Items %}[{$Item.Name}]{% endfor %}"), Tokens, Error)))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Data = ParseJson(TEXT("{ \"Title\": \"T\", \"Items\": [ { \"Name\": \"a\" }, { \"Name\": \"b\" } ] }"));
+	FTemplateRenderCache Cache;
+	TestEqual(TEXT("First render"), RenderCached(Cache, Tokens, Data, {}), TEXT("T:[a][b]"));
+
+	// Only the changed item renders again, the cached output of the others is kept
+	Data->GetArrayField(TEXT("Items"))[1]->AsObject()->SetStringField(TEXT("Name"), TEXT("c"));
+	Data->GetArrayField(TEXT("Items"))[0]->AsObject()->SetStringField(TEXT("Name"), TEXT("stale"));
+	TestEqual(TEXT("Changed item"), RenderCached(Cache, Tokens, Data, { TEXT("Items.1.Name") }), TEXT("T:[a][c]"));
+
+	// Unrelated and empty fields do not change anything
+	Data->SetStringField(TEXT("Title"), TEXT("U"));
+	TestEqual(TEXT("Unrelated path"), RenderCached(Cache, Tokens, Data, { TEXT("Other..Name") }), TEXT("T:[a][c]"));
+	TestEqual(TEXT("Changed title"), RenderCached(Cache, Tokens, Data, { TEXT("Title") }), TEXT("U:[a][c]"));
+	TestEqual(TEXT("Changed list"), RenderCached(Cache, Tokens, Data, { TEXT("Items") }), TEXT("U:[stale][c]"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateRenderCacheNestedTest, "SimpleTemplate.RenderCache.Nested", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateRenderCacheNestedTest::RunTest(const FString& Parameters)
+{
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(TEXT("{% if Show %}{$Title}|{% for Team in Teams %}<{$Team.Name}:{% for P in Team.Players %}{% if P.Active %}{$P.Score}{% endif %},{% endfor %}>{% endfor %}{% endif %}"), Tokens, Error)))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Data = ParseJson(TEXT("{ \"Show\": true, \"Title\": \"T\", \"Teams\": [")
+		TEXT(" { \"Name\": \"A\", \"Players\": [ { \"Active\": true, \"Score\": \"1\" }, { \"Active\": true, \"Score\": \"2\" } ] },")
+		TEXT(" { \"Name\": \"B\", \"Players\": [ { \"Active\": false, \"Score\": \"3\" } ] } ] }"));
+	const TArray<TSharedPtr<FJsonValue>>& Teams = Data->GetArrayField(TEXT("Teams"));
+	FTemplateRenderCache Cache;
+	TestEqual(TEXT("First render"), RenderCached(Cache, Tokens, Data, {}), TEXT("T|<A:1,2,><B:,>"));
+
+	// Stale values that are not reported show which tokens rendered again
+	Data->SetStringField(TEXT("Title"), TEXT("stale"));
+	Teams[0]->AsObject()->SetStringField(TEXT("Name"), TEXT("stale"));
+	Teams[0]->AsObject()->GetArrayField(TEXT("Players"))[0]->AsObject()->SetStringField(TEXT("Score"), TEXT("9"));
+	Teams[0]->AsObject()->GetArrayField(TEXT("Players"))[1]->AsObject()->SetStringField(TEXT("Score"), TEXT("5"));
+	TestEqual(TEXT("Var in a nested loop"), RenderCached(Cache, Tokens, Data, { TEXT("Teams.0.Players.1.Score") }), TEXT("T|<A:1,5,><B:,>"));
+
+	Teams[1]->AsObject()->GetArrayField(TEXT("Players"))[0]->AsObject()->SetBoolField(TEXT("Active"), true);
+	TestEqual(TEXT("Condition in a nested loop"), RenderCached(Cache, Tokens, Data, { TEXT("Teams.1.Players.0.Active") }), TEXT("T|<A:1,5,><B:3,>"));
+	TestEqual(TEXT("Var of an item"), RenderCached(Cache, Tokens, Data, { TEXT("Teams.0.Name") }), TEXT("T|<stale:1,5,><B:3,>"));
+	TestEqual(TEXT("Nested list"), RenderCached(Cache, Tokens, Data, { TEXT("Teams.0.Players") }), TEXT("T|<stale:9,5,><B:3,>"));
+
+	// A branch that is taken again renders everything in it
+	Data->SetBoolField(TEXT("Show"), false);
+	TestEqual(TEXT("Branch hidden"), RenderCached(Cache, Tokens, Data, { TEXT("Show") }), TEXT(""));
+	Data->SetBoolField(TEXT("Show"), true);
+	TestEqual(TEXT("Branch shown"), RenderCached(Cache, Tokens, Data, { TEXT("Show") }), TEXT("stale|<stale:9,5,><B:3,>"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateRenderCacheProgramTest, "SimpleTemplate.RenderCache.Program", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateRenderCacheProgramTest::RunTest(const FString& Parameters)
+{
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(TEXT("{$Title}:{% for Item in Items %}[{$Item.Name}]{% endfor %}"), Tokens, Error)))
+	{
+		return false;
+	}
+	FTemplateProgram Program;
+	Program.Build(Tokens);
+
+	TSharedPtr<FJsonObject> Data = ParseJson(TEXT("{ \"Title\": \"T\", \"Items\": [ { \"Name\": \"a\" }, { \"Name\": \"b\" } ] }"));
+	FTemplateRenderCache Cache;
+	FString Output;
+	{
+		FScopedTemplateRenderContext RenderContext;
+		Cache.Interpret(Program, RenderContext->Begin(Data), {}, Output);
+	}
+	TestEqual(TEXT("First render"), Output, TEXT("T:[a][b]"));
+
+	// The tokens rebuilt from the program are kept by the cache
+	Data->SetStringField(TEXT("Title"), TEXT("stale"));
+	Data->GetArrayField(TEXT("Items"))[1]->AsObject()->SetStringField(TEXT("Name"), TEXT("c"));
+	{
+		FScopedTemplateRenderContext RenderContext;
+		Cache.Interpret(Program, RenderContext->Begin(Data), { TEXT("Items.1.Name") }, Output);
+	}
+	TestEqual(TEXT("Changed item"), Output, TEXT("T:[a][c]"));
+	return true;
+}
+
+#endif
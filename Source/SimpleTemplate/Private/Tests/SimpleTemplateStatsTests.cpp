@@ -0,0 +1,76 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && STATS
+
+using namespace SimpleTemplateTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateStatsBytesTest, "SimpleTemplate.Stats.BytesEmitted", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateStatsBytesTest::RunTest(const FString& Parameters)
+{
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(TEXT("Hello {$Name}!{% for X in List %}[{$X}]{% endfor %}"), Tokens, Error)))
+	{
+		return true;
+	}
+	const FString Json = TEXT("{ \"Name\": \"Ann\", \"List\": [\"a\", \"b\"] }");
+
+	// Renders into archives of the caller are counted too
+	TArray<uint8> External;
+	FMemoryWriter ExternalWriter(External);
+	FTemplateRenderContext RenderContext;
+	TTemplateInterpreter(Tokens).Interpret(ExternalWriter, RenderContext.Begin(ParseJson(Json)));
+	TestEqual(TEXT("External archive"), (int32)RenderContext.GetContext().Stats.BytesEmitted, External.Num());
+	TestEqual(TEXT("External output"), FString(External.Num() / sizeof(TCHAR), reinterpret_cast<const TCHAR*>(External.GetData())), TEXT("Hello Ann![a][b]"));
+
+	// And so are the renders of flat programs
+	FTemplateProgram Program;
+	Program.Build(Tokens);
+	Program.Interpret(RenderContext.Begin(ParseJson(Json)), RenderContext.GetWriteStream());
+	TestEqual(TEXT("Program"), (int32)RenderContext.GetContext().Stats.BytesEmitted, (int32)(16 * sizeof(TCHAR)));
+	RenderContext.Reset();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateStatsAllocationsTest, "SimpleTemplate.Stats.Allocations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateStatsAllocationsTest::RunTest(const FString& Parameters)
+{
+	// Allocators that do not count their calls report no allocations
+	const uint64 CallsBefore = FTemplateRenderStats::GetMallocCalls();
+	FMemory::Free(FMemory::Malloc(16));
+	if (FTemplateRenderStats::GetMallocCalls() == CallsBefore)
+	{
+		return true;
+	}
+
+	FTokenArray Tokens;
+	FString Error;
+	if (!TestTrue(TEXT("Compiles"), Compile(TEXT("{% for X in List %}[{$X}]{% endfor %}"), Tokens, Error)))
+	{
+		return true;
+	}
+
+	// Growing the archive of the caller allocates during the render
+	TArray<uint8> External;
+	FMemoryWriter ExternalWriter(External);
+	FTemplateRenderContext RenderContext;
+	TTemplateInterpreter(Tokens).Interpret(ExternalWriter, RenderContext.Begin(ParseJson(TEXT("{ \"List\": [\"a\", \"b\"] }"))));
+	FTemplateRenderStats& Stats = RenderContext.GetContext().Stats;
+	Stats.StopAllocations();
+	TestTrue(TEXT("Counted"), Stats.Allocations > 0);
+
+	// Counting stops once, the flush does not count again
+	const uint32 Allocations = Stats.Allocations;
+	FMemory::Free(FMemory::Malloc(16));
+	Stats.StopAllocations();
+	TestEqual(TEXT("Stopped"), Stats.Allocations, Allocations);
+	RenderContext.Reset();
+	return true;
+}
+
+#endif
@@ -0,0 +1,95 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+#include "Compiler/SimpleTemplateProgram.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Compiles and renders template sources for the automation tests. Included templates are
+ * looked up by path in a map of sources, names without a folder are next to the including template.
+ */
+namespace SimpleTemplateTests
+{
+	struct FOptions
+	{
+		ETemplateEscape Escape = ETemplateEscape::None;
+		bool bStripBlocks = false;
+		FString Path;
+		TMap<FString, FString> Includes;
+	};
+
+	inline TSharedPtr<FJsonObject> ParseJson(const FString& Json)
+	{
+		TSharedPtr<FJsonObject> Object;
+		const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+		FJsonSerializer::Deserialize(Reader, Object);
+		return Object;
+	}
+
+	inline TSharedRef<TTemplateTokenizer<TCHAR>> CreateCompiler(const FString& Source, const FOptions& Options = FOptions())
+	{
+		TSharedRef<TTemplateTokenizer<TCHAR>> Compiler = TTemplateCompilerFactory<TCHAR>::Create(Source);
+		Compiler->SetDefaultEscape(Options.Escape);
+		Compiler->SetStripBlocks(Options.bStripBlocks);
+		const TMap<FString, FString> Includes = Options.Includes;
+		Compiler->SetIncludeResolver([Includes](const FString& Name, const FString& IncludingPath, FString& OutPath, FString& OutSource)
+		{
+			OutPath = Name.StartsWith(TEXT("/")) ? Name : FPaths::GetPath(IncludingPath) / Name;
+			const FString* Found = Includes.Find(OutPath);
+			if (Found == nullptr)
+			{
+				return false;
+			}
+			OutSource = *Found;
+			return true;
+		}, Options.Path);
+		return Compiler;
+	}
+
+	/** Compile a source, returns false and the error if it does not compile */
+	inline bool Compile(const FString& Source, FTokenArray& OutTokens, FString& OutError, const FOptions& Options = FOptions())
+	{
+		TSharedRef<TTemplateTokenizer<TCHAR>> Compiler = CreateCompiler(Source, Options);
+		if (!Compiler->Compile())
+		{
+			OutError = Compiler->GetLastError();
+			return false;
+		}
+		OutTokens = Compiler->GetTokenTree();
+		return true;
+	}
+
+	/** Render compiled tokens with json data */
+	inline FString Render(const FTokenArray& Tokens, const FString& Json)
+	{
+		FString Output;
+		TTemplateInterpreter Interpreter(Tokens);
+		Interpreter.Interpret(Output, ParseJson(Json));
+		return Output;
+	}
+
+	/** Render a flat program with json data */
+	inline FString Render(const FTemplateProgram& Program, const FString& Json)
+	{
+		FScopedTemplateRenderContext RenderContext;
+		Program.Interpret(RenderContext->Begin(ParseJson(Json)), RenderContext->GetWriteStream());
+		return RenderContext->Finish();
+	}
+
+	/** Compile and render a source with json data, the error if it does not compile */
+	inline FString Render(const FString& Source, const FString& Json, const FOptions& Options = FOptions())
+	{
+		FTokenArray Tokens;
+		FString Error;
+		return Compile(Source, Tokens, Error, Options) ? Render(Tokens, Json) : Error;
+	}
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Tests/SimpleTemplateTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace SimpleTemplateTests;
+
+namespace
+{
+	const TCHAR* WhitespaceData = TEXT("{ \"Show\": true }");
+
+	FString RenderStripped(const FString& Source)
+	{
+		FOptions Options;
+		Options.bStripBlocks = true;
+		return Render(Source, WhitespaceData, Options);
+	}
+
+	/** Compile the edited source reusing the tokens of the original one */
+	FString RenderEdited(const FString& Source, const FString& Edited)
+	{
+		FOptions Options;
+		Options.bStripBlocks = true;
+		TSharedRef<TTemplateTokenizer<TCHAR>> First = CreateCompiler(Source, Options);
+		if (!First->Compile())
+		{
+			return First->GetLastError();
+		}
+		TSharedRef<TTemplateTokenizer<TCHAR>> Second = CreateCompiler(Edited, Options);
+		Second->SetPrevious(First->GetState());
+		return Second->Compile() ? Render(Second->GetTokenTree(), WhitespaceData) : Second->GetLastError();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateWhitespaceStripBlocksTest, "SimpleTemplate.Whitespace.StripBlocks", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateWhitespaceStripBlocksTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Own line"), RenderStripped(TEXT("<ul>\n  {% if Show %}\n  <li>x</li>\n  {% endif %}\n</ul>")), TEXT("<ul>\n  <li>x</li>\n</ul>"));
+	TestEqual(TEXT("Text after the tag"), RenderStripped(TEXT("<p>\n  {% if Show %}yes\n  {% endif %}\n</p>")), TEXT("<p>\n  yes\n</p>"));
+	TestEqual(TEXT("Text after the tag at EOF"), RenderStripped(TEXT("x\n  {% if Show %}y{% endif %}")), TEXT("x\n  y"));
+	TestEqual(TEXT("Trailing whitespace"), RenderStripped(TEXT("a\n{% if Show %}  \t\nb\n{% endif %}")), TEXT("a\nb\n"));
+	TestEqual(TEXT("Whitespace at EOF"), RenderStripped(TEXT("{% if Show %}\ny\n{% endif %}  ")), TEXT("y\n"));
+	TestEqual(TEXT("Windows line breaks"), RenderStripped(TEXT("a\r\n{% if Show %}\r\nb\r\n{% endif %}\r\n")), TEXT("a\r\nb\r\n"));
+	TestEqual(TEXT("Off"), Render(TEXT("a\n  {% if Show %}\nb{% endif %}"), WhitespaceData), TEXT("a\n  \nb"));
+
+	// The rest of the line is looked at again when it is edited
+	const FString Source = TEXT("a\n{% if Show %}\nb\n{% endif %}\n");
+	const FString WithText = TEXT("a\n{% if Show %}x\nb\n{% endif %}\n");
+	TestEqual(TEXT("Text added after the tag"), RenderEdited(Source, WithText), RenderStripped(WithText));
+	TestEqual(TEXT("Text removed after the tag"), RenderEdited(WithText, Source), RenderStripped(Source));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateWhitespaceMarkersTest, "SimpleTemplate.Whitespace.Markers", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateWhitespaceMarkersTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Both sides"), Render(TEXT("a  \n {%- if Show -%}  \n b {%- endif %}\nc"), WhitespaceData), TEXT("ab\nc"));
+	TestEqual(TEXT("Before"), Render(TEXT("a \n\t{%- if Show %} b{% endif %}"), WhitespaceData), TEXT("a b"));
+	TestEqual(TEXT("After"), Render(TEXT("a {% if Show -%}\n\n b{% endif %}"), WhitespaceData), TEXT("a b"));
+	TestEqual(TEXT("Not a marker"), Render(TEXT("a - {% if Show %}-{% endif %}"), WhitespaceData), TEXT("a - -"));
+
+	// Markers trim the same with stripping on
+	TestEqual(TEXT("Marker on its own line"), RenderStripped(TEXT("a\n  {%- if Show %}\nb{% endif %}")), TEXT("ab"));
+	TestEqual(TEXT("Marker with text after"), RenderStripped(TEXT("x {%- if Show %}y{% endif %}")), TEXT("xy"));
+	return true;
+}
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "ISimpleTemplate.h"
+#include "SimpleTemplateStats.h"
 #include "UObject/ObjectMacros.h"
 #include "UObject/Object.h"
 #include "Dom/JsonValue.h"
@@ -12,9 +13,19 @@
 #include "Serialization/BufferReader.h"
 #include "Serialization/MemoryWriter.h"
 #include "Interfaces/SimpleTemplateDataProvider.h"
+#include "Interfaces/SimpleTemplateDataSource.h"
+#include "Compiler/SimpleTemplateEscape.h"
+#include "Compiler/SimpleTemplateExpression.h"
+#include "Compiler/SimpleTemplateFilter.h"
+#include "Compiler/SimpleTemplateKey.h"
+#include "SimpleTemplateLazyDataSource.h"
 
 #include "SimpleTemplateCompiler.generated.h"
 
+// Size of the first chunk of a token arena, following chunks double up to TPL_ARENA_MAX_CHUNK
+#define TPL_ARENA_MIN_CHUNK 1024
+#define TPL_ARENA_MAX_CHUNK (64 * 1024)
+
 // Static tokens
 static FString TPL_START_TOKEN(TEXT("{"));
 static FString TPL_END_TOKEN(TEXT("}"));
@@ -22,38 +33,366 @@ static FString TPL_START_IF_TOKEN(TEXT("if"));
 static FString TPL_END_IF_TOKEN(TEXT("endif"));
 static FString TPL_START_FOR_TOKEN(TEXT("for"));
 static FString TPL_END_FOR_TOKEN(TEXT("endfor"));
+static FString TPL_INCLUDE_TOKEN(TEXT("include"));
+static FString TPL_EXTENDS_TOKEN(TEXT("extends"));
+static FString TPL_START_BLOCK_TOKEN(TEXT("block"));
+static FString TPL_END_BLOCK_TOKEN(TEXT("endblock"));
+
+// Name of the loop data
+static FString TPL_LOOP_KEY(TEXT("loop"));
 
 // The template serialization version
 // 1: Initial version
 // 2: If token changed it's bool values from uint32 with pack : 1 to a real bool
-static uint32 TPL_VERSION = 2;
+// 3: If token stores a compiled expression instead of key/value
+// 4: Cooked templates store a flat program instead of the token tree
+// 5: Tokens store their source location
+// 6: Var tokens store their escape mode
+// 7: Var tokens store their filters
+// 8: Cooked templates can keep their source after the compiled data
+// 9: Tokens store whether they come from an included template
+static uint32 TPL_VERSION = 9;
+
+/** A native data source bound to a name in the lexical scope */
+struct FTemplateSourceBinding
+{
+	// The bound name, owned by the token that created the binding
+	const FString* Name;
+
+	ISimpleTemplateDataSource* Source;
+
+	// Index of the lexical scope the binding lives in
+	int32 ScopeIndex;
+};
+
+class FToken;
+class FTemplateProfiler;
 
 class SIMPLETEMPLATE_API FTemplateCompilerContent
 {
 public:
+	FTemplateCompilerContent()
+		: DataSource(nullptr)
+		, Profiler(nullptr)
+	{}
+
 	// The dynamic scope
 	TSharedPtr<FJsonObject> DynamicScope;
 
+	// Native data source, used after the dynamic scope
+	ISimpleTemplateDataSource* DataSource;
+
 	// The lexical scope
 	TArray<TSharedPtr<FJsonObject>> LexicalScope;
+
+	// Native sources bound in the lexical scope, e.g. items of a native list
+	TArray<FTemplateSourceBinding> SourceBindings;
+
+	// Collects the time of every token when profiling, see FTemplateProfiler
+	FTemplateProfiler* Profiler;
+
+	// Text of the var being filtered, its memory is reused by all vars of the render
+	FString ValueScratch;
+
+#if STATS
+	// Work done by the current render
+	FTemplateRenderStats Stats;
+#endif
+};
+
+/** What a FTemplateProfileScope measures */
+enum class ETemplateProfileEvent : uint8
+{
+	// Everything a token does
+	Token,
+	// Evaluating the condition of an if
+	Condition,
+	// A single iteration of a loop body
+	Iteration
+};
+
+/** Attributes the time and output of a scope to a token when the render is being profiled */
+class SIMPLETEMPLATE_API FTemplateProfileScope
+{
+public:
+	FTemplateProfileScope(FTemplateCompilerContent& Context, const FToken* Token, FArchive& WriteStream, ETemplateProfileEvent Event = ETemplateProfileEvent::Token)
+		: Profiler(Context.Profiler)
+		, WriteStream(nullptr)
+	{
+		if (Profiler != nullptr)
+		{
+			Begin(Token, WriteStream, Event);
+		}
+	}
+
+	~FTemplateProfileScope()
+	{
+		if (Profiler != nullptr)
+		{
+			End();
+		}
+	}
+
+private:
+	void Begin(const FToken* Token, FArchive& InWriteStream, ETemplateProfileEvent Event);
+	void End();
+
+	FTemplateProfiler* Profiler;
+	FArchive* WriteStream;
+};
+
+/**
+ * Native state of a running loop, lives on the stack of the loop. It provides the loop data
+ * ('loop.index') and wraps json items so binding an item does not allocate scope data.
+ */
+class SIMPLETEMPLATE_API FTemplateLoopState : public ISimpleTemplateDataSource
+{
+public:
+	FTemplateLoopState()
+		: Index(0)
+		, JsonItem(nullptr)
+	{}
+
+	//~ ISimpleTemplateDataSource interface
+
+	virtual TSharedPtr<FJsonValue> GetValue(const FString& Key) override
+	{
+		if (Key.IsEmpty())
+		{
+			TSharedPtr<FJsonObject> LoopData = MakeShareable(new FJsonObject());
+			LoopData->SetNumberField(TEXT("index"), Index);
+			return MakeShareable(new FJsonValueObject(LoopData));
+		}
+		if (Key.Equals(TEXT("index"), ESearchCase::CaseSensitive))
+		{
+			return MakeShareable(new FJsonValueNumber(Index));
+		}
+		return nullptr;
+	}
+
+	// 'loop.index' is read without creating a json value, conditions and vars read it every iteration
+	virtual bool TryGetNumber(const FString& Key, double& OutNumber) override
+	{
+		if (Key.Equals(TEXT("index"), ESearchCase::CaseSensitive))
+		{
+			OutNumber = Index;
+			return true;
+		}
+		return false;
+	}
+
+	virtual bool GetString(const FString& Key, FString& OutString) override
+	{
+		double Number = 0.0;
+		if (TryGetNumber(Key, Number))
+		{
+			// Written like the json number would be
+			return FJsonValueNumber(Number).TryGetString(OutString);
+		}
+		return ISimpleTemplateDataSource::GetString(Key, OutString);
+	}
+
+	virtual bool IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback) override
+	{
+		return false;
+	}
+
+public:
+	// Index of the current item
+	int32 Index;
+
+	// The current item if it is json data
+	FSimpleTemplateJsonDataSource JsonItem;
 };
 
 class TTemplateCompilerHelper
 {
 public:
+	// Push a scope, its json data is only created when a value gets set
 	static void PushScope(FTemplateCompilerContent& Context)
 	{
-		Context.LexicalScope.Push(MakeShareable(new FJsonObject()));
+		Context.LexicalScope.AddDefaulted();
 	}
 
 	static void PopScope(FTemplateCompilerContent& Context)
 	{
 		Context.LexicalScope.Pop();
+		while (Context.SourceBindings.Num() > 0 && Context.SourceBindings.Last().ScopeIndex >= Context.LexicalScope.Num())
+		{
+			Context.SourceBindings.Pop(false);
+		}
+	}
+
+	static TSharedPtr<FJsonValue> GetValue(FTemplateCompilerContent& Context, const FTemplateKey& Key)
+	{
+		ISimpleTemplateDataSource* Source = nullptr;
+		const FString* SubKey = nullptr;
+		TSharedPtr<FJsonValue> Value = FindValue(Context, Key, Source, SubKey);
+		if (Source != nullptr)
+		{
+			return Source->GetValue(*SubKey);
+		}
+		return Value;
+	}
+
+	// A value for conditions, numbers of native sources are read without creating a json value. Returns
+	// true if OutNumber was set, OutValue is set otherwise.
+	static bool GetNumberOrValue(FTemplateCompilerContent& Context, const FTemplateKey& Key, double& OutNumber, TSharedPtr<FJsonValue>& OutValue)
+	{
+		ISimpleTemplateDataSource* Source = nullptr;
+		const FString* SubKey = nullptr;
+		OutValue = FindValue(Context, Key, Source, SubKey);
+		if (Source != nullptr)
+		{
+			if (Source->TryGetNumber(*SubKey, OutNumber))
+			{
+				return true;
+			}
+			OutValue = Source->GetValue(*SubKey);
+		}
+		return false;
 	}
 
+	// Splits the key on every call, tokens keep their keys split
 	static TSharedPtr<FJsonValue> GetValue(FTemplateCompilerContent& Context, const FString& Key)
 	{
+		return GetValue(Context, FTemplateKey(Key));
+	}
+
+	// The text of a value, native sources write it without creating a json value
+	static bool GetString(FTemplateCompilerContent& Context, const FTemplateKey& Key, FString& OutString)
+	{
+		ISimpleTemplateDataSource* Source = nullptr;
+		const FString* SubKey = nullptr;
+		TSharedPtr<FJsonValue> Value = FindValue(Context, Key, Source, SubKey);
+		if (Source != nullptr)
+		{
+			return Source->GetString(*SubKey, OutString);
+		}
+		return Value.IsValid() && Value->TryGetString(OutString);
+	}
+
+	static bool GetString(FTemplateCompilerContent& Context, const FString& Key, FString& OutString)
+	{
+		return GetString(Context, FTemplateKey(Key), OutString);
+	}
+
+	// Write a value through its filters, it is read into the scratch string of the render through the
+	// json value or data source. Missing values still run the filters, e.g. 'default'.
+	static void WriteValue(FTemplateCompilerContent& Context, const FTemplateKey& Key, FArchive& WriteStream, const FTemplateFilterCall* Filters, int32 NumFilters, ETemplateEscape Escape)
+	{
+		ISimpleTemplateDataSource* Source = nullptr;
+		const FString* SubKey = nullptr;
+		TSharedPtr<FJsonValue> Value = FindValue(Context, Key, Source, SubKey);
+
+		FString& Scratch = Context.ValueScratch;
+		Scratch.Reset();
+		bool bFound = true;
+		if (Source != nullptr)
+		{
+			bFound = Source->GetString(*SubKey, Scratch);
+		}
+		else
+		{
+			bFound = Value.IsValid() && Value->TryGetString(Scratch);
+		}
+		if (bFound || NumFilters > 0)
+		{
+			FTemplateFilters::Write(WriteStream, Scratch, Filters, NumFilters, Escape);
+		}
+	}
+
+	static void SetValue(FTemplateCompilerContent& Context, const FString& Key, TSharedPtr<FJsonValue>& Value)
+	{
+		TSharedPtr<FJsonObject>& Scope = Context.LexicalScope.Last();
+		if (!Scope.IsValid())
+		{
+			Scope = MakeShareable(new FJsonObject());
+		}
+		Scope->SetField(Key, Value);
+	}
+
+	// Bind a native source to a name in the current scope, the name must outlive the scope
+	static void SetSource(FTemplateCompilerContent& Context, const FString& Key, ISimpleTemplateDataSource& Source)
+	{
+		const int32 ScopeIndex = Context.LexicalScope.Num() - 1;
+		for (int32 i = Context.SourceBindings.Num() - 1; i >= 0 && Context.SourceBindings[i].ScopeIndex == ScopeIndex; i--)
+		{
+			if (Context.SourceBindings[i].Name->Equals(Key, ESearchCase::CaseSensitive))
+			{
+				Context.SourceBindings[i].Source = &Source;
+				return;
+			}
+		}
+
+		FTemplateSourceBinding Binding;
+		Binding.Name = &Key;
+		Binding.Source = &Source;
+		Binding.ScopeIndex = ScopeIndex;
+		Context.SourceBindings.Add(Binding);
+	}
+
+	// Bind the loop data and the current item of a loop in the current scope, the name and the state must outlive the scope
+	static void SetLoopItem(FTemplateCompilerContent& Context, FTemplateLoopState& LoopState, const FString& Key, int32 Index, const TSharedPtr<FJsonValue>& JsonItem, ISimpleTemplateDataSource* SourceItem)
+	{
+		// Add loop data
+		// loop.index
+		LoopState.Index = Index;
+		SetSource(Context, TPL_LOOP_KEY, LoopState);
+		TPL_RENDER_STAT(Context, LoopIterations);
+
+		// Set item, json items are wrapped by the loop state
+		if (SourceItem != nullptr)
+		{
+			SetSource(Context, Key, *SourceItem);
+		}
+		else
+		{
+			LoopState.JsonItem.SetJsonValue(JsonItem);
+			SetSource(Context, Key, LoopState.JsonItem);
+		}
+	}
+
+	// Iterate a list either from json data or from a native source
+	static bool IterateList(FTemplateCompilerContent& Context, const FTemplateKey& Key, TFunctionRef<void(int32 Index, const TSharedPtr<FJsonValue>& JsonItem, ISimpleTemplateDataSource* SourceItem)> Callback)
+	{
+		ISimpleTemplateDataSource* Source = nullptr;
+		const FString* SubKey = nullptr;
+		TSharedPtr<FJsonValue> Value = FindValue(Context, Key, Source, SubKey);
+		if (Source != nullptr)
+		{
+			int32 Index = 0;
+			return Source->IterateList(*SubKey, [&Callback, &Index](ISimpleTemplateDataSource& Item)
+			{
+				Callback(Index++, nullptr, &Item);
+			});
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* List;
+		if (Value.IsValid() && Value->TryGetArray(List))
+		{
+			for (int32 i = 0; i < List->Num(); i++)
+			{
+				Callback(i, (*List)[i], nullptr);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	static bool IterateList(FTemplateCompilerContent& Context, const FString& Key, TFunctionRef<void(int32 Index, const TSharedPtr<FJsonValue>& JsonItem, ISimpleTemplateDataSource* SourceItem)> Callback)
+	{
+		return IterateList(Context, FTemplateKey(Key), Callback);
+	}
+
+private:
+	// Find a json value or the native source that owns the key and the part of the key it gets
+	static TSharedPtr<FJsonValue> FindValue(FTemplateCompilerContent& Context, const FTemplateKey& Key, ISimpleTemplateDataSource*& OutSource, const FString*& OutSubKey)
+	{
+		TPL_RENDER_STAT(Context, Lookups);
+
 		// Get it always from the lexical scope first
+		int32 BindingIndex = Context.SourceBindings.Num() - 1;
 		for (int32 i = Context.LexicalScope.Num()-1; i >= 0; i--)
 		{
 			if (Context.LexicalScope[i].IsValid() && Context.LexicalScope[i]->Values.Num() > 0)
@@ -64,26 +403,83 @@ public:
 					return Value;
 				}
 			}
+
+			for (; BindingIndex >= 0 && Context.SourceBindings[BindingIndex].ScopeIndex >= i; BindingIndex--)
+			{
+				const FTemplateSourceBinding& Binding = Context.SourceBindings[BindingIndex];
+				const int32 NameLen = Binding.Name->Len();
+				if (Key.Key.StartsWith(*Binding.Name, ESearchCase::CaseSensitive) && (Key.Key.Len() == NameLen || Key.Key[NameLen] == TCHAR('.')))
+				{
+					// The bound item itself is asked for with an empty key
+					static const FString Empty;
+					const FString* SubKey = Key.Key.Len() == NameLen ? &Empty : Key.FindRest(NameLen + 1);
+					if (SubKey != nullptr)
+					{
+						OutSource = Binding.Source;
+						OutSubKey = SubKey;
+						return nullptr;
+					}
+				}
+			}
 		}
-		
-		// Dynamic scope is our last guess
-		return GetValue(Key, Context.DynamicScope);
+
+		// Dynamic scope is our next guess
+		TSharedPtr<FJsonValue> Value = GetValue(Key, Context.DynamicScope);
+		if (!Value.IsValid() && Context.DataSource != nullptr)
+		{
+			// Native data is our last guess
+			OutSource = Context.DataSource;
+			OutSubKey = &Key.Key;
+		}
+		return Value;
 	}
 
-	static void SetValue(FTemplateCompilerContent& Context, const FString& Key, TSharedPtr<FJsonValue>& Value)
+public:
+	// Resolve a split key in a json object
+	static TSharedPtr<FJsonValue> GetValue(const FTemplateKey& Key, const TSharedPtr<FJsonObject>& Data)
 	{
-		TSharedPtr<FJsonObject> Scope = Context.LexicalScope.Last();
-		if (Scope.IsValid())
+		if (!Data.IsValid() || Key.Fields.Num() == 0)
 		{
-			Scope->SetField(Key, Value);
+			return nullptr;
 		}
+		const FJsonObject* CurrentObject = Data.Get();
+		for (int32 i = 0; i < Key.Fields.Num(); i++)
+		{
+			const TSharedPtr<FJsonValue>* Field = CurrentObject->Values.Find(Key.Fields[i]);
+			if (Field == nullptr || !Field->IsValid())
+			{
+				return nullptr;
+			}
+			if (i == Key.Fields.Num() - 1)
+			{
+				return *Field;
+			}
+			if ((*Field)->Type != EJson::Object)
+			{
+				return nullptr;
+			}
+			const TSharedPtr<FJsonObject>& NextObject = (*Field)->AsObject();
+			if (!NextObject.IsValid())
+			{
+				return nullptr;
+			}
+			CurrentObject = NextObject.Get();
+		}
+		return nullptr;
 	}
 
-private:
+	// Resolve a dotted key in a json object
 	static TSharedPtr<FJsonValue> GetValue(const FString& Key, TSharedPtr<FJsonObject> Data)
 	{
 		if (Data.IsValid() && !Key.IsEmpty())
 		{
+			// Most keys are a single field
+			int32 DotIndex;
+			if (!Key.FindChar(TCHAR('.'), DotIndex))
+			{
+				return Data->TryGetField(Key);
+			}
+
 			TArray<FString> KeyList;
 			Key.ParseIntoArray(KeyList, TEXT("."), true);
 
@@ -117,6 +513,186 @@ private:
 	}
 };
 
+/**
+ * Reusable state of a render. The compiler context, its scope stacks and the output buffer are
+ * only reset between renders so they keep their memory. Keep one per caller for batch rendering
+ * or borrow one of the current thread through FScopedTemplateRenderContext.
+ */
+class SIMPLETEMPLATE_API FTemplateRenderContext
+{
+public:
+	FTemplateRenderContext()
+		: Writer(Buffer)
+	{}
+
+	FTemplateRenderContext(const FTemplateRenderContext&) = delete;
+	FTemplateRenderContext& operator=(const FTemplateRenderContext&) = delete;
+
+	// Start a render of json data
+	FTemplateCompilerContent& Begin(TSharedPtr<FJsonObject> Data)
+	{
+		Reset();
+		INC_DWORD_STAT(STAT_SimpleTemplate_Renders);
+		Context.DynamicScope = Data;
+#if STATS
+		Context.Stats.Start();
+#endif
+		return Context;
+	}
+
+	// Start a render of a native data source
+	FTemplateCompilerContent& Begin(ISimpleTemplateDataSource& DataSource)
+	{
+		Reset();
+		INC_DWORD_STAT(STAT_SimpleTemplate_Renders);
+		Context.DataSource = &DataSource;
+#if STATS
+		Context.Stats.Start();
+#endif
+		return Context;
+	}
+
+	FTemplateCompilerContent& GetContext()
+	{
+		return Context;
+	}
+
+	FArchive& GetWriteStream()
+	{
+		return Writer;
+	}
+
+	// Copy out the rendered text and reset
+	FString Finish()
+	{
+		FString Output(Buffer.Num() / sizeof(TCHAR), reinterpret_cast<const TCHAR*>(Buffer.GetData()));
+		Reset();
+		return Output;
+	}
+
+	// Drop the data of the last render, memory is kept
+	void Reset()
+	{
+#if STATS
+		Context.Stats.Flush();
+#endif
+		Context.DynamicScope.Reset();
+		Context.DataSource = nullptr;
+		Context.Profiler = nullptr;
+		Context.LexicalScope.Reset();
+		Context.SourceBindings.Reset();
+		Buffer.Reset();
+		Writer.Seek(0);
+	}
+
+private:
+	FTemplateCompilerContent Context;
+	TArray<uint8> Buffer;
+	FMemoryWriter Writer;
+};
+
+/** Borrows a render context of the current thread, nested renders get their own */
+class SIMPLETEMPLATE_API FScopedTemplateRenderContext
+{
+public:
+	FScopedTemplateRenderContext();
+	~FScopedTemplateRenderContext();
+
+	FTemplateRenderContext& operator*()
+	{
+		return *RenderContext;
+	}
+
+	FTemplateRenderContext* operator->()
+	{
+		return RenderContext;
+	}
+
+private:
+	FTemplateRenderContext* RenderContext;
+};
+
+/**
+ * Collects the data paths a template reads. Keys read through a loop variable are mapped
+ * back to the list they iterate, e.g. 'item.Name' in 'for item in Items' becomes 'Items[].Name'.
+ * Unquoted operands of conditions that are used as text when the data has no such key, like
+ * 'foo' in 'x == foo', are only collected if asked for.
+ */
+class SIMPLETEMPLATE_API FTemplateDataPaths
+{
+public:
+	explicit FTemplateDataPaths(bool bInLiteralKeys = false)
+		: bLiteralKeys(bInLiteralKeys)
+	{}
+
+	// Add an operand that is a key or text, depending on the data
+	void AddKeyOrLiteral(const FString& Key)
+	{
+		if (bLiteralKeys)
+		{
+			AddKey(Key);
+		}
+	}
+
+	// Add a key read in the current scope
+	void AddKey(const FString& Key)
+	{
+		// Loop data is provided by the interpreter
+		const bool bLoopData = Loops.Num() > 0 && (Key.Equals(TEXT("loop"), ESearchCase::CaseSensitive) || Key.StartsWith(TEXT("loop."), ESearchCase::CaseSensitive));
+		if (!Key.IsEmpty() && !bLoopData)
+		{
+			Paths.AddUnique(ResolveKey(Key));
+		}
+	}
+
+	// Enter a loop that binds Value to the items of List
+	void PushLoop(const FString& Value, const FString& List)
+	{
+		Loops.Emplace(Value, ResolveKey(List) + TEXT("[]"));
+	}
+
+	void PopLoop()
+	{
+		Loops.Pop();
+	}
+
+	// True if a change to one path affects the other, e.g. 'Items' and 'Items[].Name'
+	static bool Overlaps(const FString& A, const FString& B)
+	{
+		const FString& Short = A.Len() <= B.Len() ? A : B;
+		const FString& Long = A.Len() <= B.Len() ? B : A;
+		if (!Long.StartsWith(Short, ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+		return Long.Len() == Short.Len() || Long[Short.Len()] == TCHAR('.') || Long[Short.Len()] == TCHAR('[');
+	}
+
+	// A key read in the current scope as a data path, loop variables are replaced by their list
+	FString ResolveKey(const FString& Key) const
+	{
+		for (int32 i = Loops.Num() - 1; i >= 0; i--)
+		{
+			const FString& Value = Loops[i].Key;
+			if (Key.StartsWith(Value, ESearchCase::CaseSensitive) && (Key.Len() == Value.Len() || Key[Value.Len()] == TCHAR('.')))
+			{
+				return Loops[i].Value + Key.Mid(Value.Len());
+			}
+		}
+		return Key;
+	}
+
+	// The collected paths
+	TArray<FString> Paths;
+
+private:
+	// Loop variables with their resolved list
+	TArray<TPair<FString, FString>> Loops;
+
+	// Collect operands that may be text as well
+	bool bLiteralKeys;
+};
+
 //
 // Tokens
 //
@@ -134,10 +710,16 @@ enum class ETokenType : uint8
     EndFor
 };
 
+class FTokenArena;
+
 class SIMPLETEMPLATE_API FToken
 {
 public:
-	FToken() {}
+	FToken()
+		: Line(INDEX_NONE)
+		, Column(INDEX_NONE)
+		, bIncluded(false)
+	{}
 
     virtual ~FToken() {}
 
@@ -151,16 +733,97 @@ public:
 		return FString();
 	}
 	
-	virtual void Serialize(FArchive& Ar) {}
+	// Nested tokens allocate their children from the arena when loading
+	virtual void Serialize(FArchive& Ar, FTokenArena& Arena) {}
 
 	// Interpret the token 
 	virtual void Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream, TSharedPtr<FJsonObject> Data) {}
 
 	// Some tokens are nested
-	virtual void AddBranch(TArray<TSharedPtr<FToken>>& children) {}
+	virtual void AddBranch(TArray<FToken*>& children) {}
+
+	// Collect the data paths the token reads
+	virtual void CollectDataPaths(FTemplateDataPaths& Paths) const {}
+
+	// Copy the token into an arena, nested tokens are copied without their children
+	virtual FToken* Clone(FTokenArena& Arena) const;
+
+	// Heap memory owned by the token, the token itself lives in the arena
+	virtual SIZE_T GetAllocatedSize() const
+	{
+		return 0;
+	}
+
+public:
+	// Zero based source location of the token, INDEX_NONE for tokens rebuilt from a flat program
+	int32 Line;
+	int32 Column;
+
+	// Token of an included or base template, it is located at the tag that brought it in
+	bool bIncluded;
 };
 
-typedef TSharedPtr<FToken> FTokenPtr;
+typedef FToken* FTokenPtr;
+
+/**
+ * Owns all tokens of a template. The token objects are bump allocated from chunks and destroyed
+ * all at once with the arena, there is no allocation or reference counting per token object.
+ * The data of a token is not arena backed: its strings, keys and the child arrays of nested
+ * tokens still use the heap and every token destructor runs when the arena goes away.
+ */
+class SIMPLETEMPLATE_API FTokenArena
+{
+public:
+	FTokenArena()
+		: Cursor(nullptr)
+		, End(nullptr)
+		, ChunkSize(TPL_ARENA_MIN_CHUNK)
+		, ChunkBytes(0)
+	{}
+
+	~FTokenArena();
+
+	FTokenArena(const FTokenArena&) = delete;
+	FTokenArena& operator=(const FTokenArena&) = delete;
+
+	// Create a token owned by the arena
+	template <typename TokenType, typename... ArgTypes>
+	TokenType* New(ArgTypes&&... Args)
+	{
+		TokenType* Token = new(Allocate(sizeof(TokenType), alignof(TokenType))) TokenType(Forward<ArgTypes>(Args)...);
+		Tokens.Add(Token);
+		return Token;
+	}
+
+	// Bytes allocated for the tokens in the chunks and for their data on the heap
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = ChunkBytes + Chunks.GetAllocatedSize() + Tokens.GetAllocatedSize();
+		for (const FToken* Token : Tokens)
+		{
+			Size += Token->GetAllocatedSize();
+		}
+		return Size;
+	}
+
+private:
+	void* Allocate(SIZE_T Size, SIZE_T Alignment);
+
+private:
+	TArray<uint8*> Chunks;
+	uint8* Cursor;
+	uint8* End;
+	int32 ChunkSize;
+	SIZE_T ChunkBytes;
+
+	// Tokens to destroy
+	TArray<FToken*> Tokens;
+};
+
+inline FToken* FToken::Clone(FTokenArena& Arena) const
+{
+	return Arena.New<FToken>(*this);
+}
 
 USTRUCT(Blueprintable)
 struct SIMPLETEMPLATE_API FTokenArray
@@ -169,10 +832,51 @@ struct SIMPLETEMPLATE_API FTokenArray
 
 public:
 
-	void Serialize(FArchive& Ar);
+	// Serialize a token tree, tokens are loaded into our arena
+	void Serialize(FArchive& Ar)
+	{
+		Serialize(Ar, GetArena());
+	}
+
+	// Serialize the children of a token, tokens are loaded into the arena of the tree
+	void Serialize(FArchive& Ar, FTokenArena& InArena);
+
+	// The arena owning the tokens, created on first use
+	FTokenArena& GetArena()
+	{
+		if (!Arena.IsValid())
+		{
+			Arena = MakeShareable(new FTokenArena());
+		}
+		return *Arena;
+	}
+
+	// Release all tokens
+	void Reset()
+	{
+		Items.Reset();
+		Arena.Reset();
+	}
+
+	void CollectDataPaths(FTemplateDataPaths& Paths) const
+	{
+		for (const FTokenPtr& Token : Items)
+		{
+			Token->CollectDataPaths(Paths);
+		}
+	}
+
+	// Memory used by the tree, the arena is counted by the tree owning it
+	SIZE_T GetAllocatedSize() const
+	{
+		return Items.GetAllocatedSize() + (Arena.IsValid() ? Arena->GetAllocatedSize() : 0);
+	}
 
 public:
 	TArray<FTokenPtr> Items;
+
+	// Owner of the tokens of a tree, shared by copies of the tree and null for children
+	TSharedPtr<FTokenArena> Arena;
 };
 
 class SIMPLETEMPLATE_API FTokenText : public FToken
@@ -190,13 +894,25 @@ public:
         return ETokenType::Text;
     }
 
-	virtual void Serialize(FArchive& Ar) override
+	virtual void Serialize(FArchive& Ar, FTokenArena& Arena) override
 	{
 		Ar << Text;
 	}
 
+	virtual FToken* Clone(FTokenArena& Arena) const override
+	{
+		return Arena.New<FTokenText>(*this);
+	}
+
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		return Text.GetAllocatedSize();
+	}
+
 	virtual void Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream, TSharedPtr<FJsonObject> Data) override
 	{
+		TPL_RENDER_STAT(Context, Tokens);
+		FTemplateProfileScope ProfileScope(Context, this, WriteStream);
 		WriteStream.Serialize((void*)*Text, Text.Len() * sizeof(TCHAR));
 	}
 
@@ -207,15 +923,29 @@ public:
 class SIMPLETEMPLATE_API FTokenVar : public FToken
 {
 public:
-	FTokenVar() : FToken() {}
+	FTokenVar()
+		: FToken()
+		, Escape(ETemplateEscape::None)
+	{}
 
 	FTokenVar(const FString& InKey)
 		: FToken()
 		, Key(InKey)
+		, SplitKey(InKey)
+		, Escape(ETemplateEscape::None)
 	{}
 
+	// Split off the filters of '{$Key|trim|truncate:20|html}'
 	virtual FString Build() override
 	{
+		int32 FilterStart;
+		if (Key.FindChar(TCHAR('|'), FilterStart))
+		{
+			const FString Chain = Key.Mid(FilterStart + 1);
+			Key = Key.Left(FilterStart).TrimEnd();
+			SplitKey.Set(Key);
+			return FTemplateFilters::Parse(Chain, Filters, Escape);
+		}
 		return FString();
 	}
 
@@ -224,23 +954,55 @@ public:
 		return ETokenType::Var;
 	}
 
-	virtual void Serialize(FArchive& Ar) override
+	virtual void Serialize(FArchive& Ar, FTokenArena& Arena) override
 	{
 		Ar << Key;
+		Ar << Filters;
+		Ar << Escape;
+		if (Ar.IsLoading())
+		{
+			SplitKey.Set(Key);
+		}
 	}
 
-	virtual void Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream, TSharedPtr<FJsonObject> Data) override
+	virtual void CollectDataPaths(FTemplateDataPaths& Paths) const override
+	{
+		Paths.AddKey(Key);
+	}
+
+	virtual FToken* Clone(FTokenArena& Arena) const override
 	{
-		auto value = TTemplateCompilerHelper::GetValue(Context, Key);
-		FString valueStr;
-		if (value.IsValid() && value->TryGetString(valueStr))
+		return Arena.New<FTokenVar>(*this);
+	}
+
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		SIZE_T Size = Key.GetAllocatedSize() + SplitKey.GetAllocatedSize() + Filters.GetAllocatedSize();
+		for (const FTemplateFilterCall& Filter : Filters)
 		{
-			WriteStream.Serialize((void*)*valueStr, valueStr.Len() * sizeof(TCHAR));
+			Size += Filter.GetAllocatedSize();
 		}
+		return Size;
+	}
+
+	virtual void Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream, TSharedPtr<FJsonObject> Data) override
+	{
+		TPL_RENDER_STAT(Context, Tokens);
+		FTemplateProfileScope ProfileScope(Context, this, WriteStream);
+		TTemplateCompilerHelper::WriteValue(Context, SplitKey, WriteStream, Filters.GetData(), Filters.Num(), Escape);
 	}
 
 public:
 	FString Key;
+
+	// The key split into its fields for the lookups
+	FTemplateKey SplitKey;
+
+	// Filters run on the value in order, before it is escaped
+	TArray<FTemplateFilterCall> Filters;
+
+	// How the value is escaped, the filter of the token or the default of the template
+	ETemplateEscape Escape;
 };
 
 class SIMPLETEMPLATE_API FTokenNested : public FToken
@@ -253,18 +1015,40 @@ public:
 		, Expression(InExpression)
 	{}
 
-	virtual void Serialize(FArchive& Ar) override
+	virtual void Serialize(FArchive& Ar, FTokenArena& Arena) override
 	{
 		Ar << Expression;
-		Children.Serialize(Ar);
+		Children.Serialize(Ar, Arena);
 	}
 
 	// Some tokens are nested
-	virtual void AddBranch(TArray<TSharedPtr<FToken>>& children)
+	virtual void AddBranch(TArray<FToken*>& children)
 	{
 		Children.Items = children;
 	}
 
+	virtual void CollectDataPaths(FTemplateDataPaths& Paths) const override
+	{
+		Children.CollectDataPaths(Paths);
+	}
+
+protected:
+	template <typename TokenType>
+	static FToken* CloneNested(const TokenType& Token, FTokenArena& Arena)
+	{
+		TokenType* Copy = Arena.New<TokenType>(Token);
+		Copy->Children.Items.Reset();
+		return Copy;
+	}
+
+public:
+
+	// Children are counted by the arena
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		return Expression.GetAllocatedSize() + Children.Items.GetAllocatedSize();
+	}
+
 public:
 	FString Expression;
 	FTokenArray Children;
@@ -289,43 +1073,42 @@ public:
 		{
 			return FString::Printf(TEXT("'for' token must in form of: for key in value. '%s' found instead"), *Expression);
 		}
-		Value = ForValues[1];
-		List = ForValues[3];
+		SetKeys(ForValues[3], ForValues[1]);
 		return FString();
 	}
 
+	// Set the key of the list and the name of its items
+	void SetKeys(const FString& InList, const FString& InValue)
+	{
+		List = InList;
+		SplitList.Set(InList);
+		Value = InValue;
+	}
+
 	virtual void Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream, TSharedPtr<FJsonObject> Data) override
 	{
+		TPL_RENDER_STAT(Context, Tokens);
+		FTemplateProfileScope ProfileScope(Context, this, WriteStream);
+		FTemplateLoopState LoopState;
 		TTemplateCompilerHelper::PushScope(Context);
-		auto listDataPtr = TTemplateCompilerHelper::GetValue(Context, List);
-		const TArray<TSharedPtr<FJsonValue>>* list;
-		if (listDataPtr.IsValid() && listDataPtr->TryGetArray(list))
+		TTemplateCompilerHelper::IterateList(Context, SplitList, [this, &Context, &WriteStream, &Data, &LoopState](int32 i, const TSharedPtr<FJsonValue>& JsonItem, ISimpleTemplateDataSource* SourceItem)
 		{
-			for (int i = 0; i < list->Num(); i++)
-			{
-				// Add loop data
-				// loop.index
-				TSharedPtr<FJsonObject> loopData = MakeShareable(new FJsonObject());
-				loopData->SetNumberField("index", i);
-				TSharedPtr<FJsonValue> LoopValue = MakeShareable(new FJsonValueObject(loopData));
-
-				TTemplateCompilerHelper::SetValue(Context, "loop", LoopValue);
-
-				//Data->SetField();
+			InterpretItem(Context, WriteStream, Data, LoopState, i, JsonItem, SourceItem);
+		});
+		TTemplateCompilerHelper::PopScope(Context);
+	}
 
-				// Set item
-				auto item = (*list)[i];
-				TTemplateCompilerHelper::SetValue(Context, Value, item);
-				//Data->SetField(Value, item);
+	// Interpret the body for a single item, the loop scope must have been pushed already
+	void InterpretItem(FTemplateCompilerContent& Context, FArchive& WriteStream, TSharedPtr<FJsonObject> Data, FTemplateLoopState& LoopState, int32 i, const TSharedPtr<FJsonValue>& JsonItem, ISimpleTemplateDataSource* SourceItem)
+	{
+		FTemplateProfileScope ProfileScope(Context, this, WriteStream, ETemplateProfileEvent::Iteration);
+		TTemplateCompilerHelper::SetLoopItem(Context, LoopState, Value, i, JsonItem, SourceItem);
 
-				// Now propagate
-				for (auto child : Children.Items)
-				{
-					child->Interpret(Context, WriteStream, Data);
-				}
-			}
+		// Now propagate
+		for (auto child : Children.Items)
+		{
+			child->Interpret(Context, WriteStream, Data);
 		}
-		TTemplateCompilerHelper::PopScope(Context);
 	}
 
     ETokenType GetType() const override
@@ -333,16 +1116,41 @@ public:
         return ETokenType::For;
     }
 
-	virtual void Serialize(FArchive& Ar) override
+	virtual void Serialize(FArchive& Ar, FTokenArena& Arena) override
 	{
-		FTokenNested::Serialize(Ar);
+		FTokenNested::Serialize(Ar, Arena);
 		Ar << List;
 		Ar << Value;
+		if (Ar.IsLoading())
+		{
+			SplitList.Set(List);
+		}
+	}
+
+	virtual void CollectDataPaths(FTemplateDataPaths& Paths) const override
+	{
+		Paths.AddKey(List);
+		Paths.PushLoop(Value, List);
+		FTokenNested::CollectDataPaths(Paths);
+		Paths.PopLoop();
+	}
+
+	virtual FToken* Clone(FTokenArena& Arena) const override
+	{
+		return CloneNested(*this, Arena);
+	}
+
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		return FTokenNested::GetAllocatedSize() + List.GetAllocatedSize() + SplitList.GetAllocatedSize() + Value.GetAllocatedSize();
 	}
 
 public:
 	FString List;
 	FString Value;
+
+	// The list key split into its fields for the lookups
+	FTemplateKey SplitList;
 };
 
 class SIMPLETEMPLATE_API FTokenIf : public FTokenNested
@@ -356,61 +1164,32 @@ public:
 
 	virtual FString Build() override
 	{
-		TArray<FString> IfValues;
-		Expression.ParseIntoArray(IfValues, TEXT(" "));
-
-		// Parse sign
-
-		if (IfValues.Num() < 2)
+		// Strip the leading 'if'
+		FString ConditionSource = Expression.Mid(TPL_START_IF_TOKEN.Len());
+		if (ConditionSource.IsEmpty() || !FChar::IsWhitespace(ConditionSource[0]))
 		{
 			return FString::Printf(TEXT("'if' token is not a boolean operation. '{%s}' found instead."), *Expression);
 		}
 
-		// if not var
-		if (IfValues[1].Equals("not"))
+		FString CompileError = Condition.Compile(ConditionSource);
+		if (!CompileError.IsEmpty())
 		{
-			bSign = false;
-			Key = IfValues[2];
-		}
-		// if var
-		else if (IfValues.Num() == 2)
-		{
-			Key = IfValues[1];
-			if (IfValues[1].StartsWith("!"))
-			{
-				bSign = false;
-				Key.RemoveFromStart("!");
-			}
-			else
-			{
-				bSign = true;
-				Key = IfValues[1];
-			}
-			
-		}
-		// if var == value | if var != value
-		else
-		{
-			if (IfValues[2].Equals("==") | IfValues[2].Equals("!=") || IfValues[2].Equals("~="))
-			{
-				bSign = IfValues[2].Equals("==") || IfValues[2].Equals("~=");
-				bIgnoreCase = IfValues[2].Equals("~=");
-			}
-			else
-			{
-				return FString::Printf(TEXT("'if' boolean operation can either be '==' or '!='. '%s' found instead."), *Expression);
-			}
-			
-			Key = IfValues[1];
-			Value = IfValues[3];
+			return FString::Printf(TEXT("'if' token has an invalid condition '%s': %s"), *ConditionSource.TrimStartAndEnd(), *CompileError);
 		}
 		return FString();
 	}
 
 	virtual void Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream, TSharedPtr<FJsonObject> Data) override
 	{
+		TPL_RENDER_STAT(Context, Tokens);
+		FTemplateProfileScope ProfileScope(Context, this, WriteStream);
 		TTemplateCompilerHelper::PushScope(Context);
-		if (IsTrue(Context, Data))
+		bool bCondition;
+		{
+			FTemplateProfileScope ConditionScope(Context, this, WriteStream, ETemplateProfileEvent::Condition);
+			bCondition = Condition.Evaluate(Context);
+		}
+		if (bCondition)
 		{
 			for(auto child : Children.Items)
 			{
@@ -425,56 +1204,46 @@ public:
         return ETokenType::If;
     }
 
-	virtual void Serialize(FArchive& Ar) override
+	virtual void Serialize(FArchive& Ar, FTokenArena& Arena) override
 	{
-		FTokenNested::Serialize(Ar);
-		Ar << bSign;
-		Ar << bIgnoreCase;
-		Ar << Key;
-		Ar << Value;
+		FTokenNested::Serialize(Ar, Arena);
+		Condition.Serialize(Ar);
 	}
 
-private:
-	bool IsTrue(FTemplateCompilerContent& Context, TSharedPtr<FJsonObject> Data)
+	virtual void CollectDataPaths(FTemplateDataPaths& Paths) const override
 	{
-		// Only key provided
-		if (Value.IsEmpty())
+		CollectConditionPaths(Paths);
+		FTokenNested::CollectDataPaths(Paths);
+	}
+
+	// Collect the data paths of the condition only
+	void CollectConditionPaths(FTemplateDataPaths& Paths) const
+	{
+		for (const FExpressionOp& Op : Condition.GetOps())
 		{
-			bool boolValue = false;
-			auto keyDataPtr = TTemplateCompilerHelper::GetValue(Context, Key);
-			if (keyDataPtr.IsValid())
+			if (Op.Type == EExpressionOp::PushVar)
 			{
-				// Only check against the actual singn in case we have a bool, all other types
-				// are TRUE if they exists and FALSE otherwise
-				if (keyDataPtr->TryGetBool(boolValue))
-				{
-					return boolValue == bSign;
-				}
-				return bSign;
+				Paths.AddKey(Condition.GetStrings()[Op.Operand]);
+			}
+			else if (Op.Type == EExpressionOp::PushVarOrLiteral)
+			{
+				Paths.AddKeyOrLiteral(Condition.GetStrings()[Op.Operand]);
 			}
-			// Just check the sign
-			return !bSign;
 		}
+	}
 
-		// Find l-value and r-value
-		auto lValuePtr = TTemplateCompilerHelper::GetValue(Context, Key);
-		auto rValuePtr = TTemplateCompilerHelper::GetValue(Context, Value);
-		if (!rValuePtr.IsValid())
-		{
-			rValuePtr = MakeShareable(new FJsonValueString(Value.TrimQuotes()));
-		}
+	virtual FToken* Clone(FTokenArena& Arena) const override
+	{
+		return CloneNested(*this, Arena);
+	}
 
-		// Compare
-		FString lValue;
-		FString rValue;
-		return lValuePtr.IsValid() && rValuePtr.IsValid() && lValuePtr->TryGetString(lValue) && rValuePtr->TryGetString(rValue) && (lValue.Equals(rValue, bIgnoreCase ? ESearchCase::IgnoreCase : ESearchCase::CaseSensitive) == bSign);
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		return FTokenNested::GetAllocatedSize() + Condition.GetAllocatedSize();
 	}
 
 public:
-	bool bSign;
-	bool bIgnoreCase;
-	FString Key;
-	FString Value;
+	FTemplateExpression Condition;
 };
 
 class SIMPLETEMPLATE_API FTokenEnd : public FToken
@@ -487,7 +1256,7 @@ public:
 		, Expression(InExpression)
 	{}
 
-	virtual void Serialize(FArchive& Ar) override
+	virtual void Serialize(FArchive& Ar, FTokenArena& Arena) override
 	{
 		Ar << Expression;
 	}
@@ -518,6 +1287,11 @@ public:
 	{
 		return ETokenType::EndIf;
 	}
+
+	virtual FToken* Clone(FTokenArena& Arena) const override
+	{
+		return Arena.New<FTokenEndIf>(*this);
+	}
 };
 
 class SIMPLETEMPLATE_API FTokenEndFor : public FTokenEnd
@@ -537,10 +1311,86 @@ public:
 		return FString();
 	}
 
-	ETokenType GetType() const override
-	{
-		return ETokenType::EndFor;
-	}
+	ETokenType GetType() const override
+	{
+		return ETokenType::EndFor;
+	}
+
+	virtual FToken* Clone(FTokenArena& Arena) const override
+	{
+		return Arena.New<FTokenEndFor>(*this);
+	}
+};
+
+/**
+ * A point of the source the tokenizer can restart from, recorded before every text. Tokenizing
+ * the rest of the source only depends on the state kept here.
+ */
+struct FTemplateTokenizerCheckpoint
+{
+	// Chars into the source
+	int32 Offset;
+	uint32 Line;
+	uint32 Column;
+
+	// Tokens before this point
+	int32 NumTokens;
+
+	// Open tags, a bit per level set for 'for' and clear for 'if'
+	uint64 OpenTags;
+	int32 Depth;
+
+	// Whitespace control asked for by the tag in front
+	bool bTrimWhitespace;
+	bool bTrimLineBreak;
+	bool bInBlock;
+
+	bool HasSameState(const FTemplateTokenizerCheckpoint& Other) const
+	{
+		return OpenTags == Other.OpenTags && Depth == Other.Depth
+			&& bTrimWhitespace == Other.bTrimWhitespace && bTrimLineBreak == Other.bTrimLineBreak
+			&& bInBlock == Other.bInBlock;
+	}
+};
+
+/** A template inlined while compiling, how its name was resolved and the source it had */
+struct FTemplateTokenizerInclude
+{
+	// The name in the tag and the path of the template it was resolved against
+	FString Name;
+	FString IncludingPath;
+
+	// What the resolver returned
+	FString Path;
+	uint32 SourceHash;
+
+	// Chars into the compiled source, the end of the tag that inlined it or the template including it
+	int32 Offset;
+};
+
+/**
+ * What a successful compile leaves for the next compile of the edited source, see
+ * TTemplateTokenizer::SetPrevious. Keeps the arena of its tokens alive.
+ */
+struct FTemplateTokenizerState
+{
+	FString Source;
+
+	// Where the template was compiled, relative includes resolve next to it
+	FString Path;
+
+	// The token list before parsing
+	TArray<FTokenPtr> Tokens;
+	TSharedPtr<FTokenArena> Arena;
+
+	TArray<FTemplateTokenizerCheckpoint> Checkpoints;
+
+	// Every template inlined, nested ones too, in source order
+	TArray<FTemplateTokenizerInclude> Includes;
+
+	// Compile options the tokens were created with
+	ETemplateEscape DefaultEscape;
+	bool bStripBlocks;
 };
 
 //
@@ -558,7 +1408,72 @@ public:
 public:
     virtual ~TTemplateTokenizer() {}
 
-	FTokenArray GetTokenTree()
+	/**
+	 * Resolves an included or extended template by name, relative to the path of the template that
+	 * includes it. Returns false if there is none, else its path and source. The path is handed back
+	 * as the including path of the includes of that template.
+	 */
+	typedef TFunction<bool(const FString& Name, const FString& IncludingPath, FString& OutPath, FString& OutSource)> FIncludeResolver;
+
+	// Allow '{% include Name %}' and '{% extends Name %}', both are resolved when compiling. Path is where the compiled template is.
+	void SetIncludeResolver(FIncludeResolver InIncludeResolver, const FString& InPath = FString())
+	{
+		IncludeResolver = MoveTemp(InIncludeResolver);
+		IncludePath = InPath;
+	}
+
+	// Escape mode of var tokens without an escape filter of their own
+	void SetDefaultEscape(ETemplateEscape InDefaultEscape)
+	{
+		DefaultEscape = InDefaultEscape;
+	}
+
+	// Remove the line of control tags that are alone on their line, their indentation and line break
+	void SetStripBlocks(bool bInStripBlocks)
+	{
+		bStripBlocks = bInStripBlocks;
+	}
+
+	/**
+	 * Reuse the tokens of the last compile of this template. Only the source from the last checkpoint
+	 * in front of the edit up to the first checkpoint after it, in the same state, is tokenized again.
+	 * Tokens are copied to our arena, the state is not modified and has to outlive the compile.
+	 * Nothing is reused if a template the previous compile inlined resolves to another path or
+	 * source now, the resolver is asked for all of them.
+	 */
+	void SetPrevious(TSharedPtr<const FTemplateTokenizerState, ESPMode::ThreadSafe> InPrevious)
+	{
+		Previous = MoveTemp(InPrevious);
+	}
+
+	// What the next compile of the edited source needs to reuse our tokens, null if it has to start over.
+	// The token list and checkpoints are moved to the state, call it once after compiling.
+	TSharedPtr<FTemplateTokenizerState, ESPMode::ThreadSafe> GetState()
+	{
+		if (!bHasTokens || SourceString == nullptr || !ExtendsName.IsEmpty() || Blocks.Num() > 0)
+		{
+			return nullptr;
+		}
+		TSharedPtr<FTemplateTokenizerState, ESPMode::ThreadSafe> State = MakeShared<FTemplateTokenizerState, ESPMode::ThreadSafe>();
+		State->Source = *SourceString;
+		State->Path = IncludePath;
+		State->Tokens = MoveTemp(Tokens.Items);
+		State->Arena = Tree.Arena;
+		State->Checkpoints = MoveTemp(Checkpoints);
+		State->Includes = MoveTemp(ResolvedIncludes);
+		State->DefaultEscape = DefaultEscape;
+		State->bStripBlocks = bStripBlocks;
+		return State;
+	}
+
+	// Paths of all templates included or extended while compiling, nested ones too
+	const TArray<FString>& GetIncludes() const
+	{
+		return Includes;
+	}
+
+	// The compiled tree, copies share the token arena
+	const FTokenArray& GetTokenTree() const
 	{
 		return Tree;
 	}
@@ -584,10 +1499,13 @@ public:
 		{
 			return true;
 		}
+		SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_Compile);
+		TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Compiler);
 		bHasTokens = Tokenize();
 		if (bHasTokens)
 		{
-			Parse(Tokens, Tree, ETokenType::None);
+			int32 Next = 0;
+			Parse(Next, Tree, ETokenType::None);
 		}
 		return bHasTokens;
 	}
@@ -597,24 +1515,63 @@ protected:
     /** Hidden default constructor. */
 	TTemplateTokenizer()
 		: ReadStream(nullptr)
+		, SourceString(nullptr)
 		, ErrorMessage()
 		, LineNumber(0)
 		, CharNumber(0)
+		, TextLine(0)
+		, TextColumn(0)
+		, TagLine(0)
+		, TagColumn(0)
+		, ExtendsLine(0)
+		, ExtendsColumn(0)
+		, CurrentBlock(INDEX_NONE)
+		, DefaultEscape(ETemplateEscape::None)
 		, bHasTokens(false)
+		, bStripBlocks(false)
+		, bTrimWhitespaceAfterTag(false)
+		, bTrimLineBreakAfterTag(false)
 	{ }
 
 	TTemplateTokenizer(FArchive* InStream)
 		: ReadStream(InStream)
+		, SourceString(nullptr)
 		, ErrorMessage()
 		, LineNumber(0)
 		, CharNumber(0)
+		, TextLine(0)
+		, TextColumn(0)
+		, TagLine(0)
+		, TagColumn(0)
+		, ExtendsLine(0)
+		, ExtendsColumn(0)
+		, CurrentBlock(INDEX_NONE)
+		, DefaultEscape(ETemplateEscape::None)
 		, bHasTokens(false)
+		, bStripBlocks(false)
+		, bTrimWhitespaceAfterTag(false)
+		, bTrimLineBreakAfterTag(false)
 	{ }
 
 protected:
 
+	// A '{% block %}', the range of its tokens in the token list
+	struct FBlock
+	{
+		FString Name;
+		int32 Start;
+		int32 End;
+
+		// Open for/if tags when the block started, the block has to end at the same depth
+		int32 Depth;
+	};
+
 	// Current Stream
 	FArchive* ReadStream;
+
+	// The source read by the stream if it is a string, needed for reusing tokens when it is edited
+	const FString* SourceString;
+
     FTokenArray Tokens;
 	FTokenArray Tree;
 	TArray<ETokenType> ParseState;
@@ -624,22 +1581,60 @@ protected:
     uint32 LineNumber;
     uint32 CharNumber;
 
+	// Zero based start of the current text and tag, recorded in the tokens
+	uint32 TextLine;
+	uint32 TextColumn;
+	uint32 TagLine;
+	uint32 TagColumn;
+
 	// Parser state
 	uint32 bHasTokens : 1;
 
+	// Whitespace control
+	uint32 bStripBlocks : 1;
+	uint32 bTrimWhitespaceAfterTag : 1;
+	uint32 bTrimLineBreakAfterTag : 1;
+
+	// Includes, by the paths the resolver returned. Our own path is the one nested includes resolve against.
+	FIncludeResolver IncludeResolver;
+	FString IncludePath;
+	TArray<FString> Includes;
+	TArray<FString> IncludeStack;
+	TArray<FTemplateTokenizerInclude> ResolvedIncludes;
+
+	// Inheritance, the base template and the blocks of the token list
+	FString ExtendsName;
+	uint32 ExtendsLine;
+	uint32 ExtendsColumn;
+	TArray<FBlock> Blocks;
+	int32 CurrentBlock;
+
+	// Escape mode of var tokens without a filter
+	ETemplateEscape DefaultEscape;
+
+	// Incremental compile, the previous compile and where we can restart
+	TSharedPtr<const FTemplateTokenizerState, ESPMode::ThreadSafe> Previous;
+	TArray<FTemplateTokenizerCheckpoint> Checkpoints;
+
+	// The edit since the previous compile, where it ends in the new source and the change of length
+	struct FSourceEdit
+	{
+		int32 NewEnd;
+		int32 Delta;
+	};
+
 private:
 
-	// Parse the plain token list into a tree
-	void Parse(FTokenArray& tokens, FTokenArray& tree, ETokenType mark)
+	// Parse the plain token list into a tree from the token at Next, the list is kept
+	void Parse(int32& Next, FTokenArray& tree, ETokenType mark)
 	{
-		while (Tokens.Items.Num() > 0)
+		while (Next < Tokens.Items.Num())
 		{
-			auto token = Tokens.Items[0];
-			Tokens.Items.RemoveAt(0);
+			auto token = Tokens.Items[Next++];
 			if (token->GetType() == ETokenType::For || token->GetType() == ETokenType::If)
 			{
 				FTokenArray children;
-				Parse(tokens, children, token->GetType() == ETokenType::For ? ETokenType::EndFor : ETokenType::EndIf);
+				Parse(Next, children, token->GetType() == ETokenType::For ? ETokenType::EndFor : ETokenType::EndIf);
 				token->AddBranch(children.Items);
 			}
 			else if (token->GetType() == mark)
@@ -665,13 +1660,33 @@ private:
 			return false;
 		}
 
+		// Start in front of the edit when the previous tokens can be reused
+		FSourceEdit Edit = { 0, 0 };
+		const bool bIncremental = RestorePrevious(Edit);
+
 		FString Buffer = "";
 		while (!ReadStream->AtEnd())
 		{
+			FTemplateTokenizerCheckpoint Checkpoint;
+			if (SourceString != nullptr && MakeCheckpoint(Checkpoint))
+			{
+				// The rest of the source is tokenized as before
+				if (bIncremental && ResumePrevious(Checkpoint, Edit))
+				{
+					break;
+				}
+				Checkpoints.Add(Checkpoint);
+			}
+
+			// Text starts at the next char
+			TextLine = LineNumber;
+			TextColumn = CharNumber;
+
 			// Find start token
 			if (!NextStartToken(Buffer))
 			{
-				if (!AddToken(new FTokenText(Buffer)))
+				TrimTextAfterTag(Buffer);
+				if (!AddToken<FTokenText>(Buffer, TextLine, TextColumn))
 				{
 					return false;
 				}
@@ -679,12 +1694,15 @@ private:
 			}
 
 			// Create text token for the left part
+			TrimTextAfterTag(Buffer);
+			int32 TextIndex = INDEX_NONE;
 			if (!Buffer.IsEmpty())
 			{
-				if (!AddToken(new FTokenText(Buffer)))
+				if (!AddToken<FTokenText>(Buffer, TextLine, TextColumn))
 				{
 					return false;
 				}
+				TextIndex = Tokens.Items.Num() - 1;
 			}
 
 			// Reset buffer
@@ -702,7 +1720,7 @@ private:
 				if (NextEndToken(Buffer))
 				{
 					Buffer.TrimStartInline();
-					if (!AddToken(new FTokenVar(Buffer)))
+					if (!AddToken<FTokenVar>(Buffer, TagLine, TagColumn))
 					{
 						return false;
 					}
@@ -719,9 +1737,38 @@ private:
 				if (NextEndToken(Buffer))
 				{
 					Buffer.TrimStartInline();
-					if (Buffer.StartsWith(TPL_START_FOR_TOKEN))
+					TrimAroundTag(Buffer, TextIndex);
+					if (IsTag(Buffer, TPL_INCLUDE_TOKEN))
+					{
+						if (!AddInclude(Buffer.Mid(TPL_INCLUDE_TOKEN.Len()).TrimStartAndEnd().TrimQuotes()))
+						{
+							return false;
+						}
+					}
+					else if (IsTag(Buffer, TPL_EXTENDS_TOKEN))
+					{
+						if (!SetExtends(Buffer.Mid(TPL_EXTENDS_TOKEN.Len()).TrimStartAndEnd().TrimQuotes()))
+						{
+							return false;
+						}
+					}
+					else if (IsTag(Buffer, TPL_START_BLOCK_TOKEN))
+					{
+						if (!StartBlock(Buffer.Mid(TPL_START_BLOCK_TOKEN.Len()).TrimStartAndEnd()))
+						{
+							return false;
+						}
+					}
+					else if (IsTag(Buffer, TPL_END_BLOCK_TOKEN))
+					{
+						if (!EndBlock(Buffer.Mid(TPL_END_BLOCK_TOKEN.Len()).TrimStartAndEnd()))
+						{
+							return false;
+						}
+					}
+					else if (Buffer.StartsWith(TPL_START_FOR_TOKEN))
 					{
-						if (!AddToken(new FTokenFor(Buffer)))
+						if (!AddToken<FTokenFor>(Buffer, TagLine, TagColumn))
 						{
 							return false;
 						}
@@ -729,7 +1776,7 @@ private:
 					}
 					else if (Buffer.StartsWith(TPL_START_IF_TOKEN))
 					{
-						if (!AddToken(new FTokenIf(Buffer)))
+						if (!AddToken<FTokenIf>(Buffer, TagLine, TagColumn))
 						{
 							return false;
 						}
@@ -739,86 +1786,430 @@ private:
 					{
 						Buffer.TrimEndInline();
 
-						// Check end token to match ParseState
-						if (ParseState.Num() > 0)
-						{
-							ETokenType expectedToken = ParseState.Pop();
-							switch (expectedToken)
-							{
-							case ETokenType::EndIf:
-								if (!Buffer.Equals(TPL_END_IF_TOKEN, ESearchCase::IgnoreCase))
-								{
-									SetError(FString::Printf(TEXT("'%s' expected. '%s' found instead."), *TPL_END_IF_TOKEN, *Buffer));
-									return false;
-								}
-								// Add token
-								if (!AddToken(new FTokenEndIf(Buffer)))
-								{
-									return false;
-								}
-								break;
-							case ETokenType::EndFor:
-								if (!Buffer.Equals(TPL_END_FOR_TOKEN, ESearchCase::IgnoreCase))
-								{
-									SetError(FString::Printf(TEXT("'%s' expected. '%s' found instead."), *TPL_END_FOR_TOKEN, *Buffer));
-									return false;
-								}
-								// Add token
-								if (!AddToken(new FTokenEndFor(Buffer)))
-								{
-									return false;
-								}
-								break;
-							default:
-								SetError(FString::Printf(TEXT("Unexpected token '%s'."), *Buffer));
-								return false;
-								break;
-							}
-						}
-						else
-						{
-							SetError(FString::Printf(TEXT("Unexpected token '%s'."), *Buffer));
-							return false;
-						}
-					}
-					Buffer = "";
-				}
-				else
-				{
-					SetError(FString::Printf(TEXT("Missing '%s' after control token"), *TPL_END_TOKEN));
-					return false;
-				}
+						// Check end token to match ParseState
+						if (CurrentBlock != INDEX_NONE && ParseState.Num() == Blocks[CurrentBlock].Depth)
+						{
+							SetError(FString::Printf(TEXT("'%s' expected. '%s' found instead."), *TPL_END_BLOCK_TOKEN, *Buffer));
+							return false;
+						}
+						else if (ParseState.Num() > 0)
+						{
+							ETokenType expectedToken = ParseState.Pop();
+							switch (expectedToken)
+							{
+							case ETokenType::EndIf:
+								if (!Buffer.Equals(TPL_END_IF_TOKEN, ESearchCase::IgnoreCase))
+								{
+									SetError(FString::Printf(TEXT("'%s' expected. '%s' found instead."), *TPL_END_IF_TOKEN, *Buffer));
+									return false;
+								}
+								// Add token
+								if (!AddToken<FTokenEndIf>(Buffer, TagLine, TagColumn))
+								{
+									return false;
+								}
+								break;
+							case ETokenType::EndFor:
+								if (!Buffer.Equals(TPL_END_FOR_TOKEN, ESearchCase::IgnoreCase))
+								{
+									SetError(FString::Printf(TEXT("'%s' expected. '%s' found instead."), *TPL_END_FOR_TOKEN, *Buffer));
+									return false;
+								}
+								// Add token
+								if (!AddToken<FTokenEndFor>(Buffer, TagLine, TagColumn))
+								{
+									return false;
+								}
+								break;
+							default:
+								SetError(FString::Printf(TEXT("Unexpected token '%s'."), *Buffer));
+								return false;
+								break;
+							}
+						}
+						else
+						{
+							SetError(FString::Printf(TEXT("Unexpected token '%s'."), *Buffer));
+							return false;
+						}
+					}
+					Buffer = "";
+				}
+				else
+				{
+					SetError(FString::Printf(TEXT("Missing '%s' after control token"), *TPL_END_TOKEN));
+					return false;
+				}
+			}
+			else
+			{
+				if (!AddToken<FTokenText>(TPL_START_TOKEN, TagLine, TagColumn))
+				{
+					return false;
+				}
+			}
+		}
+
+		if (ParseState.Num() > 0)
+		{
+			ETokenType expectedToken = ParseState.Pop();
+			switch (expectedToken)
+			{
+			case ETokenType::EndIf:
+				SetError(FString::Printf(TEXT("Missing end token '%s' at EOF"), *TPL_END_IF_TOKEN));
+				break;
+			case ETokenType::EndFor:
+				SetError(FString::Printf(TEXT("Missing end token '%s' at EOF"), *TPL_END_FOR_TOKEN));
+				break;
+			default:
+				SetError(FString::Printf(TEXT("Missing unexpected end token")));
+				return false;
+				break;
+			}
+			return false;
+		}
+		if (CurrentBlock != INDEX_NONE)
+		{
+			SetError(FString::Printf(TEXT("Missing end token '%s' at EOF"), *TPL_END_BLOCK_TOKEN));
+			return false;
+		}
+		return ExtendsName.IsEmpty() || ApplyExtends();
+	}
+
+	// The state at the current position, false if too many tags are open to record it
+	bool MakeCheckpoint(FTemplateTokenizerCheckpoint& OutCheckpoint) const
+	{
+		if (ParseState.Num() > 64)
+		{
+			return false;
+		}
+		OutCheckpoint.Offset = (int32)(ReadStream->Tell() / sizeof(CharType));
+		OutCheckpoint.Line = LineNumber;
+		OutCheckpoint.Column = CharNumber;
+		OutCheckpoint.NumTokens = Tokens.Items.Num();
+		OutCheckpoint.OpenTags = 0;
+		for (int32 i = 0; i < ParseState.Num(); i++)
+		{
+			OutCheckpoint.OpenTags |= ParseState[i] == ETokenType::EndFor ? ((uint64)1 << i) : 0;
+		}
+		OutCheckpoint.Depth = ParseState.Num();
+		OutCheckpoint.bTrimWhitespace = bTrimWhitespaceAfterTag;
+		OutCheckpoint.bTrimLineBreak = bTrimLineBreakAfterTag;
+		OutCheckpoint.bInBlock = CurrentBlock != INDEX_NONE;
+		return true;
+	}
+
+	// Index of the last checkpoint of the previous compile at or before the offset
+	int32 FindPreviousCheckpoint(int32 Offset) const
+	{
+		const TArray<FTemplateTokenizerCheckpoint>& Points = Previous->Checkpoints;
+		int32 Low = 0;
+		int32 High = Points.Num();
+		while (Low < High)
+		{
+			const int32 Middle = (Low + High) / 2;
+			if (Points[Middle].Offset <= Offset)
+			{
+				Low = Middle + 1;
+			}
+			else
+			{
+				High = Middle;
+			}
+		}
+		return Low - 1;
+	}
+
+	static bool HasLineBreak(const TCHAR* Chars, int32 Begin, int32 End)
+	{
+		for (int32 i = Begin; i < End; i++)
+		{
+			if (Chars[i] == TCHAR('\n'))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Restore the state of the previous compile in front of the edit with the tokens before it, false to tokenize everything
+	bool RestorePrevious(FSourceEdit& OutEdit)
+	{
+		if (!Previous.IsValid() || SourceString == nullptr || Previous->Checkpoints.Num() == 0
+			|| Previous->DefaultEscape != DefaultEscape || Previous->bStripBlocks != bStripBlocks
+			|| Previous->Path != IncludePath || !ArePreviousIncludesUnchanged())
+		{
+			return false;
+		}
+
+		// The edit is what is left between the common start and end of both sources
+		const int32 OldLen = Previous->Source.Len();
+		const int32 NewLen = SourceString->Len();
+		const TCHAR* OldChars = *Previous->Source;
+		const TCHAR* NewChars = **SourceString;
+		const int32 MaxCommon = FMath::Min(OldLen, NewLen);
+		int32 Prefix = 0;
+		while (Prefix < MaxCommon && OldChars[Prefix] == NewChars[Prefix])
+		{
+			Prefix++;
+		}
+		int32 Suffix = 0;
+		while (Suffix < MaxCommon - Prefix && OldChars[OldLen - 1 - Suffix] == NewChars[NewLen - 1 - Suffix])
+		{
+			Suffix++;
+		}
+		OutEdit.NewEnd = NewLen - Suffix;
+		OutEdit.Delta = NewLen - OldLen;
+
+		int32 Start = FindPreviousCheckpoint(Prefix);
+		if (Start == INDEX_NONE)
+		{
+			return false;
+		}
+
+		// Stripping a tag depends on the rest of its line, start in front of tags on the edited line
+		while (bStripBlocks && Start > 0 && !HasLineBreak(NewChars, Previous->Checkpoints[Start].Offset, Prefix))
+		{
+			Start--;
+		}
+		const FTemplateTokenizerCheckpoint& Checkpoint = Previous->Checkpoints[Start];
+		ReadStream->Seek((int64)Checkpoint.Offset * sizeof(CharType));
+		LineNumber = Checkpoint.Line;
+		CharNumber = Checkpoint.Column;
+		for (int32 i = 0; i < Checkpoint.Depth; i++)
+		{
+			ParseState.Push((Checkpoint.OpenTags & ((uint64)1 << i)) != 0 ? ETokenType::EndFor : ETokenType::EndIf);
+		}
+		bTrimWhitespaceAfterTag = Checkpoint.bTrimWhitespace;
+		bTrimLineBreakAfterTag = Checkpoint.bTrimLineBreak;
+
+		Checkpoints.Append(Previous->Checkpoints.GetData(), Start);
+		CopyPreviousTokens(0, Checkpoint.NumTokens, INDEX_NONE, 0, 0);
+
+		// Templates inlined in front of the restart point are kept, the tokenizer finds the others again
+		for (const FTemplateTokenizerInclude& Include : Previous->Includes)
+		{
+			if (Include.Offset <= Checkpoint.Offset)
+			{
+				AddResolvedInclude(Include);
+			}
+		}
+		return true;
+	}
+
+	// The templates inlined by the previous compile still resolve to the same paths and sources
+	bool ArePreviousIncludesUnchanged() const
+	{
+		TSet<FString> Checked;
+		for (const FTemplateTokenizerInclude& Include : Previous->Includes)
+		{
+			bool bAlreadyChecked = false;
+			Checked.Add(Include.IncludingPath + TEXT("|") + Include.Name, &bAlreadyChecked);
+			if (bAlreadyChecked)
+			{
+				continue;
+			}
+			FString Path;
+			FString Source;
+			if (!IncludeResolver || !IncludeResolver(Include.Name, Include.IncludingPath, Path, Source)
+				|| Path != Include.Path || FCrc::StrCrc32(*Source) != Include.SourceHash)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Append the tokens of the previous compile if it reached the same point behind the edit in the same state
+	bool ResumePrevious(const FTemplateTokenizerCheckpoint& Checkpoint, const FSourceEdit& Edit)
+	{
+		if (Checkpoint.Offset < Edit.NewEnd)
+		{
+			return false;
+		}
+		const int32 OldOffset = Checkpoint.Offset - Edit.Delta;
+		const int32 Index = FindPreviousCheckpoint(OldOffset);
+		if (Index == INDEX_NONE || Previous->Checkpoints[Index].Offset != OldOffset || !Previous->Checkpoints[Index].HasSameState(Checkpoint))
+		{
+			return false;
+		}
+
+		// Everything behind moves by the lines of the edit, the rest of its line by the columns too
+		const FTemplateTokenizerCheckpoint& Old = Previous->Checkpoints[Index];
+		const int32 LineDelta = (int32)Checkpoint.Line - (int32)Old.Line;
+		const int32 ColumnDelta = (int32)Checkpoint.Column - (int32)Old.Column;
+		const int32 TokenDelta = Checkpoint.NumTokens - Old.NumTokens;
+		CopyPreviousTokens(Old.NumTokens, Previous->Tokens.Num(), (int32)Old.Line, LineDelta, ColumnDelta);
+		for (const FTemplateTokenizerInclude& Include : Previous->Includes)
+		{
+			if (Include.Offset > Old.Offset)
+			{
+				FTemplateTokenizerInclude Moved = Include;
+				Moved.Offset += Edit.Delta;
+				AddResolvedInclude(Moved);
+			}
+		}
+		for (int32 i = Index; i < Previous->Checkpoints.Num(); i++)
+		{
+			FTemplateTokenizerCheckpoint Moved = Previous->Checkpoints[i];
+			if (Moved.Line == Old.Line)
+			{
+				Moved.Column += ColumnDelta;
+			}
+			Moved.Line += LineDelta;
+			Moved.Offset += Edit.Delta;
+			Moved.NumTokens += TokenDelta;
+			Checkpoints.Add(Moved);
+		}
+
+		// The previous compile closed all tags in the rest of the source
+		ParseState.Reset();
+		bTrimWhitespaceAfterTag = false;
+		bTrimLineBreakAfterTag = false;
+		return true;
+	}
+
+	// Copy tokens of the previous compile to our arena, the ones on the edited line move by columns too
+	void CopyPreviousTokens(int32 Begin, int32 End, int32 EditLine, int32 LineDelta, int32 ColumnDelta)
+	{
+		FTokenArena& Arena = Tree.GetArena();
+		Tokens.Items.Reserve(Tokens.Items.Num() + End - Begin);
+		for (int32 i = Begin; i < End; i++)
+		{
+			FToken* Token = Previous->Tokens[i]->Clone(Arena);
+			if (Token->Line == EditLine)
+			{
+				Token->Column += ColumnDelta;
+			}
+			Token->Line += LineDelta;
+			Tokens.Items.Add(Token);
+		}
+	}
+
+	// Handle the '-' markers of '{%- tag -%}' and strip a tag on its own line, TextIndex is the text in front of it
+	void TrimAroundTag(FString& Buffer, int32 TextIndex)
+	{
+		const bool bTrimBefore = Buffer.StartsWith(TEXT("-"));
+		if (bTrimBefore)
+		{
+			Buffer.RemoveAt(0);
+			Buffer.TrimStartInline();
+		}
+		Buffer.TrimEndInline();
+		bTrimWhitespaceAfterTag = Buffer.EndsWith(TEXT("-"));
+		if (bTrimWhitespaceAfterTag)
+		{
+			Buffer.RemoveAt(Buffer.Len() - 1);
+			Buffer.TrimEndInline();
+		}
+
+		FString* Text = TextIndex != INDEX_NONE ? &static_cast<FTokenText*>(Tokens.Items[TextIndex])->Text : nullptr;
+
+		// The tag is on its own line if only indentation is in front of it
+		int32 LineStart = 0;
+		bool bOwnLine = false;
+		if (bStripBlocks)
+		{
+			if (Text == nullptr)
+			{
+				bOwnLine = TagColumn == 0;
+			}
+			else
+			{
+				const bool bHasLineBreak = Text->FindLastChar(TCHAR('\n'), LineStart);
+				LineStart = bHasLineBreak ? LineStart + 1 : 0;
+				bOwnLine = (bHasLineBreak || Tokens.Items[TextIndex]->Column == 0) && IsWhitespace(*Text, LineStart);
+			}
+			bOwnLine = bOwnLine && IsRestOfLineWhitespace();
+		}
+		bTrimLineBreakAfterTag = bOwnLine;
+
+		if (Text != nullptr && (bTrimBefore || bOwnLine))
+		{
+			if (bTrimBefore)
+			{
+				Text->TrimEndInline();
+			}
+			else
+			{
+				Text->LeftInline(LineStart, false);
+			}
+			if (Text->IsEmpty())
+			{
+				Tokens.Items.RemoveAt(TextIndex);
+			}
+		}
+	}
+
+	// Trim the text after a tag as the tag asked for, keeps TextLine and TextColumn at its start
+	void TrimTextAfterTag(FString& Text)
+	{
+		if (bTrimWhitespaceAfterTag)
+		{
+			Text.TrimStartInline();
+		}
+		else if (bTrimLineBreakAfterTag)
+		{
+			// Only whitespace is left on the line of the tag, remove it with the line break
+			int32 LineBreak = INDEX_NONE;
+			if (Text.FindChar(TCHAR('\n'), LineBreak))
+			{
+				// The text starts on the next line now
+				Text.RemoveAt(0, LineBreak + 1, false);
+				TextLine++;
+				TextColumn = 0;
 			}
 			else
 			{
-				if (!AddToken(new FTokenText(TPL_START_TOKEN)))
-				{
-					return false;
-				}
+				TextColumn += Text.Len();
+				Text.Empty();
 			}
 		}
+		bTrimWhitespaceAfterTag = false;
+		bTrimLineBreakAfterTag = false;
+	}
 
-		if (ParseState.Num() > 0)
+	// Whether only whitespace follows the tag up to the line break or the end, the stream stays where it is
+	bool IsRestOfLineWhitespace()
+	{
+		const int64 Position = ReadStream->Tell();
+		bool bWhitespace = true;
+		while (!ReadStream->AtEnd())
 		{
-			ETokenType expectedToken = ParseState.Pop();
-			switch (expectedToken)
+			CharType Char;
+			ReadStream->Serialize(&Char, sizeof(CharType));
+			if (IsEOF(Char) || IsLineBreak(Char))
 			{
-			case ETokenType::EndIf:
-				SetError(FString::Printf(TEXT("Missing end token '%s' at EOF"), *TPL_END_IF_TOKEN));
 				break;
-			case ETokenType::EndFor:
-				SetError(FString::Printf(TEXT("Missing end token '%s' at EOF"), *TPL_END_FOR_TOKEN));
+			}
+			if (!FChar::IsWhitespace((TCHAR)Char))
+			{
+				bWhitespace = false;
 				break;
-			default:
-				SetError(FString::Printf(TEXT("Missing unexpected end token")));
+			}
+		}
+		ReadStream->Seek(Position);
+		return bWhitespace;
+	}
+
+	static bool IsWhitespace(const FString& Text, int32 Start)
+	{
+		for (int32 i = Start; i < Text.Len(); i++)
+		{
+			if (!FChar::IsWhitespace(Text[i]))
+			{
 				return false;
-				break;
 			}
-			return false;
 		}
 		return true;
 	}
 
+	// A control tag starting with the keyword
+	static bool IsTag(const FString& Buffer, const FString& Keyword)
+	{
+		return Buffer.StartsWith(Keyword) && (Buffer.Len() == Keyword.Len() || FChar::IsWhitespace(Buffer[Keyword.Len()]));
+	}
+
 	void SetError(const FString& Error)
 	{
 		ErrorMessage = FString::Printf(TEXT("[ERROR] Line: %u Ch: %u: %s"), LineNumber, CharNumber, *Error);
@@ -830,18 +2221,264 @@ private:
 		ErrorMessage = TEXT("");
 	}
 
-	bool AddToken(FToken* token)
+	// Create a token in the arena of the tree and add it
+	template <typename TokenType>
+	bool AddToken(const FString& Expression, uint32 Line, uint32 Column)
 	{
+		FToken* token = Tree.GetArena().New<TokenType>(Expression);
+		token->Line = Line;
+		token->Column = Column;
+		if (token->GetType() == ETokenType::Var)
+		{
+			static_cast<FTokenVar*>(token)->Escape = DefaultEscape;
+		}
 		FString buildError = token->Build();
 		if (buildError.IsEmpty())
 		{
-			Tokens.Items.Add(MakeShareable(token));
+			Tokens.Items.Add(token);
 			return true;
 		}
 		SetError(buildError);
 		return false;
 	}
 
+	// Tokenize an included template into our token list, its tokens are located at the include tag
+	bool AddInclude(const FString& Name)
+	{
+		if (Name.IsEmpty())
+		{
+			SetError(TEXT("'include' token must in form of: include Name"));
+			return false;
+		}
+
+		FTokenArray IncludedTokens;
+		TArray<FBlock> IncludedBlocks;
+		if (!TokenizeTemplate(Name, TagLine, TagColumn, IncludedTokens, IncludedBlocks))
+		{
+			return false;
+		}
+
+		// Blocks of the included template can be overridden like ours
+		if (CurrentBlock != INDEX_NONE && IncludedBlocks.Num() > 0)
+		{
+			SetError(FString::Printf(TEXT("Template '%s' has blocks and can not be included inside block '%s'"), *Name, *Blocks[CurrentBlock].Name));
+			return false;
+		}
+		for (FBlock& Block : IncludedBlocks)
+		{
+			if (!CheckBlockName(Block.Name))
+			{
+				return false;
+			}
+			Block.Start += Tokens.Items.Num();
+			Block.End += Tokens.Items.Num();
+			Block.Depth = ParseState.Num();
+			Blocks.Add(Block);
+		}
+		Tokens.Items.Append(IncludedTokens.Items);
+		return true;
+	}
+
+	// Tokenize another template into a token list, its tokens are located at the given line and column
+	bool TokenizeTemplate(const FString& Name, uint32 Line, uint32 Column, FTokenArray& OutTokens, TArray<FBlock>& OutBlocks)
+	{
+		if (!IncludeResolver)
+		{
+			SetError(FString::Printf(TEXT("Can not use template '%s', includes are not supported here"), *Name));
+			return false;
+		}
+
+		FString Path;
+		FString Source;
+		if (!IncludeResolver(Name, IncludePath, Path, Source))
+		{
+			SetError(FString::Printf(TEXT("Template '%s' not found"), *Name));
+			return false;
+		}
+		if (Path == IncludePath || IncludeStack.Contains(Path))
+		{
+			SetError(FString::Printf(TEXT("Template '%s' includes or extends itself"), *Name));
+			return false;
+		}
+
+		FBufferReader Reader((void*)*Source, Source.Len() * sizeof(TCHAR), false);
+		TTemplateTokenizer<CharType> Other(&Reader);
+		Tree.GetArena();
+		Other.Tree.Arena = Tree.Arena;
+		Other.IncludeResolver = IncludeResolver;
+		Other.IncludePath = Path;
+		Other.DefaultEscape = DefaultEscape;
+		Other.bStripBlocks = bStripBlocks;
+		Other.IncludeStack = IncludeStack;
+		Other.IncludeStack.Add(IncludePath);
+		if (!Other.Tokenize())
+		{
+			SetError(FString::Printf(TEXT("In template '%s': %s"), *Name, *Other.GetLastError()));
+			return false;
+		}
+
+		// The list is still flat, tokens nested in the tags of the other template are located at our tag too
+		for (FToken* Token : Other.Tokens.Items)
+		{
+			Token->Line = Line;
+			Token->Column = Column;
+			Token->bIncluded = true;
+		}
+		OutTokens.Items = MoveTemp(Other.Tokens.Items);
+		OutBlocks = MoveTemp(Other.Blocks);
+
+		// Nested includes are located at our tag too
+		FTemplateTokenizerInclude Include;
+		Include.Name = Name;
+		Include.IncludingPath = IncludePath;
+		Include.Path = Path;
+		Include.SourceHash = FCrc::StrCrc32(*Source);
+		Include.Offset = (int32)(ReadStream->Tell() / sizeof(CharType));
+		AddResolvedInclude(Include);
+		for (FTemplateTokenizerInclude& NestedInclude : Other.ResolvedIncludes)
+		{
+			NestedInclude.Offset = Include.Offset;
+			AddResolvedInclude(NestedInclude);
+		}
+		return true;
+	}
+
+	// Record an inlined template, GetIncludes lists each path once
+	void AddResolvedInclude(const FTemplateTokenizerInclude& Include)
+	{
+		ResolvedIncludes.Add(Include);
+		Includes.AddUnique(Include.Path);
+	}
+
+	// '{% extends Name %}' has to come first, only the blocks of the template are used after it
+	bool SetExtends(const FString& Name)
+	{
+		if (Name.IsEmpty())
+		{
+			SetError(TEXT("'extends' token must in form of: extends Name"));
+			return false;
+		}
+		if (!ExtendsName.IsEmpty())
+		{
+			SetError(TEXT("A template can only extend one template"));
+			return false;
+		}
+		for (const FToken* Token : Tokens.Items)
+		{
+			if (Token->GetType() != ETokenType::Text || !static_cast<const FTokenText*>(Token)->Text.TrimStartAndEnd().IsEmpty())
+			{
+				SetError(FString::Printf(TEXT("'%s' has to be the first token of the template"), *TPL_EXTENDS_TOKEN));
+				return false;
+			}
+		}
+		ExtendsName = Name;
+		ExtendsLine = TagLine;
+		ExtendsColumn = TagColumn;
+		return true;
+	}
+
+	bool CheckBlockName(const FString& Name)
+	{
+		if (Name.IsEmpty())
+		{
+			SetError(TEXT("'block' token must in form of: block Name"));
+			return false;
+		}
+		if (Blocks.ContainsByPredicate([&Name](const FBlock& Block) { return Block.Name == Name; }))
+		{
+			SetError(FString::Printf(TEXT("Block '%s' is defined twice"), *Name));
+			return false;
+		}
+		return true;
+	}
+
+	bool StartBlock(const FString& Name)
+	{
+		if (CurrentBlock != INDEX_NONE)
+		{
+			SetError(FString::Printf(TEXT("Block '%s' can not be inside block '%s'"), *Name, *Blocks[CurrentBlock].Name));
+			return false;
+		}
+		if (!CheckBlockName(Name))
+		{
+			return false;
+		}
+
+		CurrentBlock = Blocks.AddDefaulted();
+		FBlock& Block = Blocks[CurrentBlock];
+		Block.Name = Name;
+		Block.Start = Tokens.Items.Num();
+		Block.End = Block.Start;
+		Block.Depth = ParseState.Num();
+		return true;
+	}
+
+	bool EndBlock(const FString& Name)
+	{
+		if (CurrentBlock == INDEX_NONE || ParseState.Num() != Blocks[CurrentBlock].Depth)
+		{
+			SetError(FString::Printf(TEXT("Unexpected token '%s'."), *TPL_END_BLOCK_TOKEN));
+			return false;
+		}
+		FBlock& Block = Blocks[CurrentBlock];
+		if (!Name.IsEmpty() && Name != Block.Name)
+		{
+			SetError(FString::Printf(TEXT("'%s %s' expected. '%s %s' found instead."), *TPL_END_BLOCK_TOKEN, *Block.Name, *TPL_END_BLOCK_TOKEN, *Name));
+			return false;
+		}
+		Block.End = Tokens.Items.Num();
+		CurrentBlock = INDEX_NONE;
+		return true;
+	}
+
+	// Replace our token list with the base template, its blocks filled with ours
+	bool ApplyExtends()
+	{
+		FTokenArray BaseTokens;
+		TArray<FBlock> BaseBlocks;
+		if (!TokenizeTemplate(ExtendsName, ExtendsLine, ExtendsColumn, BaseTokens, BaseBlocks))
+		{
+			return false;
+		}
+
+		for (const FBlock& Block : Blocks)
+		{
+			if (!BaseBlocks.ContainsByPredicate([&Block](const FBlock& BaseBlock) { return BaseBlock.Name == Block.Name; }))
+			{
+				SetError(FString::Printf(TEXT("Block '%s' is not defined in '%s'"), *Block.Name, *ExtendsName));
+				return false;
+			}
+		}
+
+		// The resulting blocks can be overridden again by templates extending us
+		TArray<FTokenPtr> Items;
+		TArray<FBlock> ResultBlocks;
+		int32 Next = 0;
+		for (const FBlock& BaseBlock : BaseBlocks)
+		{
+			Items.Append(BaseTokens.Items.GetData() + Next, BaseBlock.Start - Next);
+
+			FBlock& Result = ResultBlocks[ResultBlocks.Add(BaseBlock)];
+			Result.Start = Items.Num();
+			const FBlock* Override = Blocks.FindByPredicate([&BaseBlock](const FBlock& Block) { return Block.Name == BaseBlock.Name; });
+			if (Override != nullptr)
+			{
+				Items.Append(Tokens.Items.GetData() + Override->Start, Override->End - Override->Start);
+			}
+			else
+			{
+				Items.Append(BaseTokens.Items.GetData() + BaseBlock.Start, BaseBlock.End - BaseBlock.Start);
+			}
+			Result.End = Items.Num();
+			Next = BaseBlock.End;
+		}
+		Items.Append(BaseTokens.Items.GetData() + Next, BaseTokens.Items.Num() - Next);
+
+		Tokens.Items = MoveTemp(Items);
+		Blocks = MoveTemp(ResultBlocks);
+		return true;
+	}
+
 	bool ReadNext(CharType& Char)
 	{
 		ReadStream->Serialize(&Char, sizeof(CharType));
@@ -876,6 +2513,8 @@ private:
 			{
 				if (IsTokenStart(Char))
 				{
+					TagLine = LineNumber;
+					TagColumn = CharNumber - 1;
 					return true;
 				}
 			}
@@ -970,6 +2609,7 @@ protected:
 		Reader = new FBufferReader((void*)*JsonString, JsonString.Len() * sizeof(TCHAR), false);
 		check(Reader);
 		ReadStream = Reader;
+		SourceString = &JsonString;
 	}
 
 protected:
@@ -980,71 +2620,123 @@ protected:
 // Factory for easy access
 //
 
+/**
+ * Renders a token tree. The interpreter only references the tree, it is cheap to create on the
+ * stack for each render and the tree must outlive it:
+ *
+ *   TTemplateInterpreter Interpreter(Tokens);
+ *   Interpreter.Interpret(OutString, Data);
+ */
 class SIMPLETEMPLATE_API TTemplateInterpreter
 {
 public:
+	explicit TTemplateInterpreter(const FTokenArray& InTokenTree)
+		: TokenTree(InTokenTree)
+	{
+	}
 
-	static TSharedRef< TTemplateInterpreter > Create(FTokenArray& TokenTree)
+	// The tree is referenced, a temporary would be gone before the render
+	explicit TTemplateInterpreter(FTokenArray&& InTokenTree) = delete;
+
+	// Heap allocated interpreter, prefer creating it on the stack
+	static TSharedRef< TTemplateInterpreter > Create(const FTokenArray& TokenTree)
 	{
 		return MakeShareable(new TTemplateInterpreter(TokenTree));
 	}
 
+	static TSharedRef< TTemplateInterpreter > Create(FTokenArray&& TokenTree) = delete;
+
 	// TODO: Add error handling
 
 	bool Interpret(FArchive& WriteStream, TSharedPtr<FJsonObject> Data)
 	{
-		FTemplateCompilerContent Context;
-		Context.DynamicScope = Data;
-
-		TTemplateCompilerHelper::PushScope(Context);
-		for (auto token : TokenTree.Items)
-		{
-			token->Interpret(Context, WriteStream, Data);
-		}
-		TTemplateCompilerHelper::PopScope(Context);
-		return true;
+		FScopedTemplateRenderContext RenderContext;
+		return Interpret(WriteStream, RenderContext->Begin(Data));
 	}
 
 	bool Interpret(FString& OutString, TSharedPtr<FJsonObject> Data)
 	{
-		TArray<uint8> Bytes;
-		auto WriteStream = new FMemoryWriter(Bytes);
+		FScopedTemplateRenderContext RenderContext;
+		RenderContext->Begin(Data);
+		return Interpret(OutString, *RenderContext);
+	}
 
-		if (Interpret(*WriteStream, Data))
-		{
+	bool Interpret(FArchive& WriteStream, ISimpleTemplateDataSource& DataSource)
+	{
+		FScopedTemplateRenderContext RenderContext;
+		return Interpret(WriteStream, RenderContext->Begin(DataSource));
+	}
 
-			FString Out;
-			for (int32 i = 0; i < Bytes.Num(); i += sizeof(TCHAR))
-			{
-				TCHAR* Char = static_cast<TCHAR*>(static_cast<void*>(&Bytes[i]));
-				Out += *Char;
-			}
-			OutString = Out;
-			WriteStream->Close();
-			delete WriteStream;
-			return true;
-		}
-		return false;
+	bool Interpret(FString& OutString, ISimpleTemplateDataSource& DataSource)
+	{
+		FScopedTemplateRenderContext RenderContext;
+		RenderContext->Begin(DataSource);
+		return Interpret(OutString, *RenderContext);
 	}
 
 	bool Interpret(FArchive& WriteStream, TScriptInterface<ISimpleTemplateDataProvider> DataProvider)
 	{
-		return DataProvider != nullptr ? Interpret(WriteStream, DataProvider->GetData()) : false;
+		if (DataProvider == nullptr)
+		{
+			return false;
+		}
+		TSharedPtr<ISimpleTemplateDataSource> DataSource = DataProvider->GetDataSource();
+		return DataSource.IsValid() ? Interpret(WriteStream, *DataSource) : Interpret(WriteStream, DataProvider->GetData());
 	}
 
 	bool Interpret(FString& OutString, TScriptInterface<ISimpleTemplateDataProvider> DataProvider)
 	{
-		return DataProvider != nullptr ? Interpret(OutString, DataProvider->GetData()) : false;
+		if (DataProvider == nullptr)
+		{
+			return false;
+		}
+		TSharedPtr<ISimpleTemplateDataSource> DataSource = DataProvider->GetDataSource();
+		return DataSource.IsValid() ? Interpret(OutString, *DataSource) : Interpret(OutString, DataProvider->GetData());
 	}
 
-protected:
-	TTemplateInterpreter(FTokenArray& InTokenTree)
-		: TokenTree(InTokenTree)
+	bool Interpret(FArchive& WriteStream, FTemplateCompilerContent& Context)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimpleTemplate_Interpret);
+		TPL_LLM_SCOPE(STAT_SimpleTemplateLLM_Interpreter);
+#if STATS
+		const int64 OutputBegin = WriteStream.Tell();
+#endif
+		TTemplateCompilerHelper::PushScope(Context);
+		for (FToken* token : TokenTree.Items)
+		{
+			token->Interpret(Context, WriteStream, Context.DynamicScope);
+		}
+		TTemplateCompilerHelper::PopScope(Context);
+		TPL_RENDER_OUTPUT_STAT(Context, OutputBegin, WriteStream.Tell());
+		return true;
+	}
+
+	bool Interpret(FString& OutString, FTemplateCompilerContent& Context)
+	{
+		// Only the output buffer of the render context is used
+		FScopedTemplateRenderContext RenderContext;
+		if (Interpret(RenderContext->GetWriteStream(), Context))
+		{
+			OutString = RenderContext->Finish();
+			return true;
+		}
+		return false;
+	}
+
+	// Interpret a render context started with FTemplateRenderContext::Begin
+	bool Interpret(FString& OutString, FTemplateRenderContext& RenderContext)
 	{
+		if (Interpret(RenderContext.GetWriteStream(), RenderContext.GetContext()))
+		{
+			OutString = RenderContext.Finish();
+			return true;
+		}
+		RenderContext.Reset();
+		return false;
 	}
 
 protected:
-	FTokenArray TokenTree;
+	const FTokenArray& TokenTree;
 };
 
 template <class CharType = TCHAR>
@@ -0,0 +1,46 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+
+#include "SimpleTemplateEscape.generated.h"
+
+/** How the values of var tokens are escaped when written */
+UENUM(BlueprintType)
+enum class ETemplateEscape : uint8
+{
+	/** Values are written as they are */
+	None,
+	/** '&', '<', '>', '"' and '\'' become entities */
+	Html,
+	/** Values are written as the inside of a JSON string */
+	Json,
+	/** Values with separators, quotes or line breaks are quoted */
+	Csv,
+	/** Like Html, '\'' becomes '&apos;' */
+	Xml
+};
+
+/**
+ * Escapes values while they are written. The scan copies runs of clean characters with a
+ * single write and only replaces the special ones, there is no second pass over the output.
+ */
+class SIMPLETEMPLATE_API FTemplateEscape
+{
+public:
+	/** Write the characters escaped for the mode */
+	static void Write(FArchive& WriteStream, const TCHAR* Chars, int32 Len, ETemplateEscape Escape);
+
+	static void Write(FArchive& WriteStream, const FString& String, ETemplateEscape Escape)
+	{
+		Write(WriteStream, *String, String.Len(), Escape);
+	}
+
+	/** Find a mode by its filter name, e.g. 'html'. 'raw' is None */
+	static bool Parse(const FString& Name, ETemplateEscape& OutEscape);
+
+	/** Filter name of a mode */
+	static const TCHAR* ToString(ETemplateEscape Escape);
+};
@@ -0,0 +1,208 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "Compiler/SimpleTemplateKey.h"
+
+class FTemplateCompilerContent;
+
+// Max stack depth we evaluate without touching the heap
+#define TPL_EXPRESSION_INLINE_STACK 16
+
+/** Instructions of a compiled expression, evaluated as a postfix program */
+enum class EExpressionOp : uint8
+{
+	// Push the value of a key
+	PushVar,
+	// Push the value of a key or its name as string literal if it does not exist
+	PushVarOrLiteral,
+	// Push a string literal
+	PushString,
+	// Push a number literal
+	PushNumber,
+	// Push a bool literal
+	PushBool,
+	// Logic
+	Not,
+	// Comparison
+	Equal,
+	NotEqual,
+	EqualIgnoreCase,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual,
+	In,
+	NotIn,
+	// Short-circuit jumps, they keep the value on the stack if the jump is taken
+	JumpIfFalseOrPop,
+	JumpIfTrueOrPop
+};
+
+/** A single instruction, the operand is an index into the string/number pools, a bool or a jump target */
+struct FExpressionOp
+{
+	EExpressionOp Type;
+	int32 Operand;
+
+	FExpressionOp()
+		: Type(EExpressionOp::PushBool)
+		, Operand(0)
+	{}
+
+	FExpressionOp(EExpressionOp InType, int32 InOperand = 0)
+		: Type(InType)
+		, Operand(InOperand)
+	{}
+
+	friend FArchive& operator<<(FArchive& Ar, FExpressionOp& Op)
+	{
+		Ar << Op.Type;
+		Ar << Op.Operand;
+		return Ar;
+	}
+};
+
+/** Value on the evaluation stack */
+struct FExpressionValue
+{
+	enum class EKind : uint8
+	{
+		Missing,
+		Bool,
+		Number,
+		String,
+		Json,
+		// A number of the data read without a json value, it behaves like a json number
+		DataNumber
+	};
+
+	EKind Kind;
+	bool bValue;
+	double Number;
+	const FString* String;
+	TSharedPtr<FJsonValue> Json;
+
+	FExpressionValue()
+		: Kind(EKind::Missing)
+		, bValue(false)
+		, Number(0.0)
+		, String(nullptr)
+	{}
+};
+
+/**
+ * Compiled boolean expression used by the 'if' token.
+ *
+ * Supports 'and', 'or', 'not' (also '&&', '||', '!'), parentheses, '==', '!=', '~=',
+ * '<', '<=', '>', '>=', 'in' and 'not in'. Operands are keys, "string" literals,
+ * numbers, true and false. Keys are made of letters, digits and '_', '.', '-', '/'.
+ * The expression is lowered into a postfix program with short-circuit jumps and its keys
+ * are split when compiling. Evaluation does not allocate as long as the stack fits into
+ * TPL_EXPRESSION_INLINE_STACK, except for ordering a number against text and for values
+ * native data sources create.
+ */
+class SIMPLETEMPLATE_API FTemplateExpression
+{
+public:
+	FTemplateExpression()
+		: MaxStackDepth(0)
+	{}
+
+	/** Compile the given expression, returns the error message or an empty string on success */
+	FString Compile(const FString& Source);
+
+	/** Evaluate the expression against the current context */
+	bool Evaluate(FTemplateCompilerContent& Context) const
+	{
+		return Evaluate(Context, Ops.GetData(), Ops.Num(), Keys.GetData(), Numbers.GetData(), MaxStackDepth);
+	}
+
+	/**
+	 * Evaluate a program stored somewhere else, e.g. in place in a cooked template program.
+	 * Keys is the string pool split into keys, literals are the whole key.
+	 */
+	static bool Evaluate(FTemplateCompilerContent& Context, const FExpressionOp* Ops, int32 NumOps, const FTemplateKey* Keys, const double* Numbers, int32 MaxStackDepth);
+
+	/**
+	 * Check a program loaded from untrusted data before evaluating it: operands have to be in the
+	 * pools, jumps have to go forward within the program and the stack has to fit MaxStackDepth.
+	 */
+	static bool IsValid(const FExpressionOp* Ops, int32 NumOps, int32 NumStrings, int32 NumNumbers, int32 MaxStackDepth);
+
+	/** Set an already compiled program */
+	void Initialize(TArray<FExpressionOp>&& InOps, TArray<FString>&& InStrings, TArray<double>&& InNumbers, int32 InMaxStackDepth)
+	{
+		Ops = MoveTemp(InOps);
+		Strings = MoveTemp(InStrings);
+		Numbers = MoveTemp(InNumbers);
+		MaxStackDepth = InMaxStackDepth;
+		UpdateKeys();
+	}
+
+	void Serialize(FArchive& Ar);
+
+	bool IsEmpty() const
+	{
+		return Ops.Num() == 0;
+	}
+
+	/** Ops of the postfix program */
+	const TArray<FExpressionOp>& GetOps() const
+	{
+		return Ops;
+	}
+
+	/** Pool of keys and string literals */
+	const TArray<FString>& GetStrings() const
+	{
+		return Strings;
+	}
+
+	/** The string pool split into keys */
+	const TArray<FTemplateKey>& GetKeys() const
+	{
+		return Keys;
+	}
+
+	/** Pool of number literals */
+	const TArray<double>& GetNumbers() const
+	{
+		return Numbers;
+	}
+
+	/** Deepest stack the program needs */
+	int32 GetMaxStackDepth() const
+	{
+		return MaxStackDepth;
+	}
+
+	/** Heap memory used by the program */
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = Ops.GetAllocatedSize() + Strings.GetAllocatedSize() + Numbers.GetAllocatedSize() + Keys.GetAllocatedSize();
+		for (const FString& String : Strings)
+		{
+			Size += String.GetAllocatedSize();
+		}
+		for (const FTemplateKey& Key : Keys)
+		{
+			Size += Key.GetAllocatedSize();
+		}
+		return Size;
+	}
+
+private:
+	friend class FTemplateExpressionParser;
+
+	/** Split the string pool, keys are not serialized */
+	void UpdateKeys();
+
+	TArray<FExpressionOp> Ops;
+	TArray<FString> Strings;
+	TArray<FTemplateKey> Keys;
+	TArray<double> Numbers;
+	int32 MaxStackDepth;
+};
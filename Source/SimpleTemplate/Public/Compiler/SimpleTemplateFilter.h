@@ -0,0 +1,107 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Compiler/SimpleTemplateEscape.h"
+
+/** The value a filter works on, a range of a buffer owned by the render */
+struct FTemplateFilterValue
+{
+	explicit FTemplateFilterValue(FString& InBuffer)
+		: Buffer(InBuffer)
+		, Start(0)
+		, Len(InBuffer.Len())
+	{}
+
+	/** Characters of the range, filters may change them in place */
+	TCHAR* GetChars()
+	{
+		return Buffer.GetCharArray().GetData() + Start;
+	}
+
+	/** Replace the value */
+	void Set(const FString& NewValue)
+	{
+		Buffer = NewValue;
+		Start = 0;
+		Len = Buffer.Len();
+	}
+
+	FString& Buffer;
+	int32 Start;
+	int32 Len;
+};
+
+struct FTemplateFilterCall;
+
+/** A filter narrows the value or changes it in place, the last one is written to the output */
+typedef void (*FTemplateFilterFunction)(FTemplateFilterValue& Value, const FTemplateFilterCall& Call);
+
+/** Argument a filter takes after ':' */
+enum class ETemplateFilterArgument : uint8
+{
+	None,
+	Number,
+	String
+};
+
+/** A registered filter, entries keep their address so calls see filters registered again later */
+struct FTemplateFilterEntry
+{
+	FTemplateFilterFunction Function;
+	ETemplateFilterArgument Argument;
+};
+
+/** A filter of a var token, e.g. 'truncate:20', resolved to its registry entry when compiled or loaded */
+struct SIMPLETEMPLATE_API FTemplateFilterCall
+{
+	FTemplateFilterCall()
+		: Number(0)
+		, Entry(nullptr)
+	{}
+
+	FString Name;
+	FString Argument;
+
+	// The argument of filters taking a number
+	int32 Number;
+
+	// Entry of the filter name, its function is null until a filter of that name is registered
+	const FTemplateFilterEntry* Entry;
+
+	FTemplateFilterFunction GetFunction() const
+	{
+		return Entry != nullptr ? Entry->Function : nullptr;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Name.GetAllocatedSize() + Argument.GetAllocatedSize();
+	}
+
+	friend SIMPLETEMPLATE_API FArchive& operator<<(FArchive& Ar, FTemplateFilterCall& Call);
+};
+
+/**
+ * Registry of the var filters. Filters are looked up once when a template is compiled or loaded,
+ * rendering calls the function of the entry, so a filter registered again is used by templates
+ * loaded before. Register project filters on module startup:
+ *
+ *   FTemplateFilters::Register(TEXT("slug"), &MakeSlug);
+ */
+class SIMPLETEMPLATE_API FTemplateFilters
+{
+public:
+	/** Add a filter, replaces a filter of the same name */
+	static void Register(const FString& Name, FTemplateFilterFunction Function, ETemplateFilterArgument Argument = ETemplateFilterArgument::None);
+
+	/** Resolve the function of a call from its name and argument, returns an error message on failure */
+	static FString Resolve(FTemplateFilterCall& Call);
+
+	/** Parse a '|' separated chain like 'upper|truncate:20|default:"a|b"|html', returns an error message on failure */
+	static FString Parse(const FString& Chain, TArray<FTemplateFilterCall>& OutFilters, ETemplateEscape& OutEscape);
+
+	/** Run the filters on the value and write it escaped */
+	static void Write(FArchive& WriteStream, FString& Value, const FTemplateFilterCall* Filters, int32 NumFilters, ETemplateEscape Escape);
+};
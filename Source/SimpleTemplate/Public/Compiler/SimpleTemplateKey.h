@@ -0,0 +1,97 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+
+/**
+ * A data key like 'user.address.city', split when the template is compiled. Lookups walk the
+ * fields and hand the rest of the key to native sources without building strings.
+ */
+struct SIMPLETEMPLATE_API FTemplateKey
+{
+	FTemplateKey() {}
+
+	explicit FTemplateKey(const FString& InKey)
+	{
+		Set(InKey);
+	}
+
+	void Set(const FString& InKey)
+	{
+		Key = InKey;
+		Fields.Reset();
+		FieldStarts.Reset();
+		Rest.Reset();
+		int32 Start = 0;
+		for (int32 i = 0; i <= Key.Len(); i++)
+		{
+			if (i == Key.Len() || Key[i] == TCHAR('.'))
+			{
+				if (i > Start)
+				{
+					Fields.Add(Key.Mid(Start, i - Start));
+					FieldStarts.Add(Start);
+				}
+				Start = i + 1;
+			}
+		}
+		if (FieldStarts.Num() > 1)
+		{
+			Rest = Key.Mid(FieldStarts[1]);
+		}
+	}
+
+	// The key starting at a char, the whole key for 0 and null if it is not stored. Only the key
+	// behind the first field is, names bound to native sources are a single field
+	const FString* FindRest(int32 Start) const
+	{
+		if (Start == 0)
+		{
+			return &Key;
+		}
+		return FieldStarts.Num() > 1 && FieldStarts[1] == Start ? &Rest : nullptr;
+	}
+
+	// The key starting at a field, cut from the whole key
+	FString GetRest(int32 Field) const
+	{
+		return Field == 0 ? Key : Key.Mid(FieldStarts[Field]);
+	}
+
+	// Heap memory used by the key
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = Key.GetAllocatedSize() + Fields.GetAllocatedSize() + FieldStarts.GetAllocatedSize() + Rest.GetAllocatedSize();
+		for (const FString& Field : Fields)
+		{
+			Size += Field.GetAllocatedSize();
+		}
+		return Size;
+	}
+
+	// Only the key is stored, it is split again when loading
+	friend FArchive& operator<<(FArchive& Ar, FTemplateKey& InKey)
+	{
+		Ar << InKey.Key;
+		if (Ar.IsLoading())
+		{
+			InKey.Set(FString(InKey.Key));
+		}
+		return Ar;
+	}
+
+public:
+	// The whole key
+	FString Key;
+
+	// The fields between the dots
+	TArray<FString> Fields;
+
+	// The char each field starts at
+	TArray<int32> FieldStarts;
+
+	// The key behind the first field, empty for a single field
+	FString Rest;
+};
@@ -0,0 +1,53 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+
+#include <initializer_list>
+
+/** A template transpiled to C++, called with the scope of the render pushed */
+typedef void (*FTemplateNativeFunction)(FTemplateCompilerContent& Context, FArchive& WriteStream);
+
+/**
+ * Render functions generated by the SimpleTemplateTranspile commandlet. A template renders with
+ * its native function if one is registered for its path and the crc of its compiled program,
+ * templates changed after the code was generated keep using the interpreter.
+ */
+class SIMPLETEMPLATE_API FTemplateNativeRegistry
+{
+public:
+	static void Register(const FString& TemplatePath, uint32 ProgramCrc, FTemplateNativeFunction Function);
+	static void Unregister(const FString& TemplatePath);
+
+	/** The native function of a template, null if there is none or it is outdated */
+	static FTemplateNativeFunction Find(const FString& TemplatePath, uint32 ProgramCrc);
+
+	/** True if any native function is registered */
+	static bool HasFunctions();
+
+	/** Changes with every Register and Unregister, found functions are looked up again when it does */
+	static int32 GetGeneration();
+
+	/** Resolve the filters of a generated var from name and argument pairs */
+	static TArray<FTemplateFilterCall> MakeFilters(std::initializer_list<const TCHAR*> NamesAndArguments);
+};
+
+/** Registers a generated render function while the module holding it is loaded */
+struct FTemplateNativeRegistration
+{
+	FTemplateNativeRegistration(const TCHAR* InTemplatePath, uint32 ProgramCrc, FTemplateNativeFunction Function)
+		: TemplatePath(InTemplatePath)
+	{
+		FTemplateNativeRegistry::Register(TemplatePath, ProgramCrc, Function);
+	}
+
+	~FTemplateNativeRegistration()
+	{
+		FTemplateNativeRegistry::Unregister(TemplatePath);
+	}
+
+private:
+	FString TemplatePath;
+};
@@ -0,0 +1,161 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+
+#include "SimpleTemplateProfiler.generated.h"
+
+/** Time and output attributed to a single token of a template */
+USTRUCT(BlueprintType)
+struct SIMPLETEMPLATE_API FSimpleTemplateTokenProfile
+{
+	GENERATED_USTRUCT_BODY()
+
+	FSimpleTemplateTokenProfile()
+		: Line(INDEX_NONE)
+		, Column(INDEX_NONE)
+		, Calls(0)
+		, Iterations(0)
+		, InclusiveTime(0.0f)
+		, SelfTime(0.0f)
+		, ConditionTime(0.0f)
+		, OutputBytes(0)
+		, Heat(0.0f)
+		, bIncluded(false)
+	{}
+
+	/** Zero based source line of the token, -1 if unknown */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	int32 Line;
+
+	/** Zero based source column of the token, -1 if unknown */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	int32 Column;
+
+	/** Short description of the token, e.g. '{% for Item in Items %}' */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	FString Token;
+
+	/** Times the token ran */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	int32 Calls;
+
+	/** Iterations of a for body */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	int32 Iterations;
+
+	/** Milliseconds spent in the token, nested tokens included */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	float InclusiveTime;
+
+	/** Milliseconds spent in the token itself */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	float SelfTime;
+
+	/** Milliseconds spent evaluating the condition of an if */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	float ConditionTime;
+
+	/** Bytes written by the token, nested tokens included */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	int32 OutputBytes;
+
+	/** Share of the total time spent in the token itself, 0 to 1 */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	float Heat;
+
+	/** The token comes from an included or base template, its location is the tag that brought it in */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	bool bIncluded;
+};
+
+/** Result of profiling a template, all times are the sum over all renders */
+USTRUCT(BlueprintType)
+struct SIMPLETEMPLATE_API FSimpleTemplateProfile
+{
+	GENERATED_USTRUCT_BODY()
+
+	FSimpleTemplateProfile()
+		: Renders(0)
+		, TotalTime(0.0f)
+	{}
+
+	/** Number of profiled renders */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	int32 Renders;
+
+	/** Milliseconds spent in tokens */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	float TotalTime;
+
+	/** Every token that ran, hottest first */
+	UPROPERTY(BlueprintReadOnly, Category="Simple Template")
+	TArray<FSimpleTemplateTokenProfile> Tokens;
+
+	/** Readable table of the hottest tokens */
+	FString ToString(int32 MaxTokens = 20) const;
+};
+
+/**
+ * Collects the time and output of every token while rendering. Set it on the context of a
+ * render to profile it, renders without a profiler only pay for a null check per token:
+ *
+ *   FTemplateProfiler Profiler;
+ *   RenderContext.Begin(Data).Profiler = &Profiler;
+ *   Interpreter.Interpret(OutString, RenderContext);
+ *   Profiler.BuildReport(1, Report);
+ */
+class SIMPLETEMPLATE_API FTemplateProfiler
+{
+public:
+	/** Start measuring an event of a token */
+	void Begin(const FToken* Token, ETemplateProfileEvent Event, int64 OutputPos);
+
+	/** Stop measuring the last event */
+	void End(int64 OutputPos);
+
+	/** Build the report of everything measured so far */
+	void BuildReport(int32 NumRenders, FSimpleTemplateProfile& OutProfile) const;
+
+	/** Forget everything measured */
+	void Reset();
+
+private:
+	/** Short description of a token */
+	static FString Describe(const FToken* Token);
+
+private:
+	struct FTokenStats
+	{
+		FTokenStats()
+			: Calls(0)
+			, Iterations(0)
+			, InclusiveCycles(0)
+			, ChildCycles(0)
+			, ConditionCycles(0)
+			, OutputBytes(0)
+		{}
+
+		int32 Calls;
+		int32 Iterations;
+		uint64 InclusiveCycles;
+		uint64 ChildCycles;
+		uint64 ConditionCycles;
+		int64 OutputBytes;
+	};
+
+	struct FFrame
+	{
+		const FToken* Token;
+		ETemplateProfileEvent Event;
+		uint64 StartCycles;
+		int64 StartOutput;
+		uint64 ChildCycles;
+	};
+
+	TMap<const FToken*, FTokenStats> Stats;
+	TArray<FFrame> Stack;
+};
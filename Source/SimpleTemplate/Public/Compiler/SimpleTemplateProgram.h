@@ -0,0 +1,195 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+
+// Magic of a flat template program, 'STPL'
+#define TPL_PROGRAM_MAGIC 0x4C505453
+
+// Alignment of the sections of a flat template program
+#define TPL_PROGRAM_ALIGNMENT 8
+
+/** Header of a flat template program, offsets are in bytes from the start of the program */
+struct FTemplateProgramHeader
+{
+	uint32 Magic;
+	uint32 Version;
+
+	// Size of the characters in the string pool
+	uint32 CharSize;
+
+	// Size of the whole program
+	int32 Size;
+
+	// FTemplateProgramString table
+	int32 NumStrings;
+	int32 StringsOffset;
+
+	// Characters of all strings
+	int32 CharsOffset;
+
+	// FTemplateInstruction table
+	int32 NumInstructions;
+	int32 InstructionsOffset;
+
+	// FExpressionOp table of all if conditions
+	int32 NumExpressionOps;
+	int32 ExpressionOpsOffset;
+
+	// Number literals of all if conditions
+	int32 NumNumbers;
+	int32 NumbersOffset;
+
+	// FTemplateProgramFilter table of all var filters
+	int32 NumFilters;
+	int32 FiltersOffset;
+};
+
+/** A string of the pool, offset and length are in characters */
+struct FTemplateProgramString
+{
+	int32 Offset;
+	int32 Len;
+};
+
+/** A filter of a var, indices into the string pool */
+struct FTemplateProgramFilter
+{
+	int32 Name;
+	int32 Argument;
+};
+
+/** Instructions of a flat template program */
+enum class ETemplateInstruction : uint8
+{
+	// Write a string, First: the string
+	Text,
+	// Write a value, First: the key, Second: the ETemplateEscape mode, Third: first filter, End: number of filters
+	Var,
+	// Loop the body, First: the list key, Second: the item key
+	For,
+	// Run the body if the condition is true, First: first expression op, Second: number of ops, Third: max stack depth
+	If
+};
+
+/** A single instruction, For and If run the instructions up to End as their body */
+struct FTemplateInstruction
+{
+	ETemplateInstruction Type;
+	int32 First;
+	int32 Second;
+	int32 Third;
+	int32 End;
+};
+
+/**
+ * Position independent, flat form of a compiled token tree used for cooked templates.
+ *
+ * The program is a single memory block: header, expression numbers, expression ops,
+ * instructions and a deduplicated string pool. It loads with a single read, or can be used
+ * in place from memory owned by somebody else, e.g. bulk data or a memory mapped file, and
+ * renders without rebuilding any tokens. Only the strings used as keys get copied into
+ * FStrings for the lookups, text is written straight from the pool.
+ */
+class SIMPLETEMPLATE_API FTemplateProgram
+{
+public:
+	FTemplateProgram()
+		: ExternalData(nullptr)
+		, ExternalSize(0)
+	{}
+
+	/** Flatten a compiled token tree */
+	void Build(const FTokenArray& Tokens);
+
+	/** Save or load the program, check IsValid after loading */
+	void Serialize(FArchive& Ar);
+
+	/**
+	 * Use a program living in memory we do not own.
+	 *
+	 * @param InData The program, must be aligned to TPL_PROGRAM_ALIGNMENT and outlive the program.
+	 * @param InSize Size of the memory.
+	 * @return false if the memory does not hold a valid program.
+	 */
+	bool InitializeView(const void* InData, int32 InSize);
+
+	/** Forget the program */
+	void Reset();
+
+	bool IsValid() const
+	{
+		return GetData() != nullptr;
+	}
+
+	/** Size of the program in bytes */
+	int32 GetSize() const
+	{
+		return IsValid() ? GetHeader().Size : 0;
+	}
+
+	/** Crc of the program, identifies the compiled template */
+	uint32 GetCrc() const;
+
+	/** Heap memory owned by the program, views do not own the program itself */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Render the program */
+	void Interpret(FTemplateCompilerContent& Context, FArchive& WriteStream) const;
+
+	/** Rebuild the token tree, needed by code working on tokens like FTemplateRenderCache */
+	void ToTokens(FTokenArray& OutTokens) const;
+
+private:
+	/** Validate the program and copy out the keys */
+	bool Initialize();
+
+	/** Run the instructions in [Begin, End) */
+	void Run(FTemplateCompilerContent& Context, FArchive& WriteStream, int32 Begin, int32 End) const;
+
+	/** Rebuild the tokens of the instructions in [Begin, End) */
+	void ToTokens(TArray<FToken*>& OutTokens, FTokenArena& Arena, int32 Begin, int32 End) const;
+
+	const uint8* GetData() const
+	{
+		return Storage.Num() > 0 ? Storage.GetData() : ExternalData;
+	}
+
+	const FTemplateProgramHeader& GetHeader() const
+	{
+		return *reinterpret_cast<const FTemplateProgramHeader*>(GetData());
+	}
+
+	template <typename T>
+	const T* GetSection(int32 Offset) const
+	{
+		return reinterpret_cast<const T*>(GetData() + Offset);
+	}
+
+	const FTemplateInstruction* GetInstructions() const
+	{
+		return GetSection<FTemplateInstruction>(GetHeader().InstructionsOffset);
+	}
+
+	/** Write a string of the pool */
+	void WriteString(FArchive& WriteStream, int32 Index) const;
+
+	/** Copy a string of the pool */
+	FString GetString(int32 Index) const;
+
+private:
+	/** The program when we own it */
+	TArray<uint8> Storage;
+
+	/** The program when it lives elsewhere */
+	const uint8* ExternalData;
+	int32 ExternalSize;
+
+	/** Strings used as keys split into fields, indexed like the pool, empty for text */
+	TArray<FTemplateKey> Keys;
+
+	/** Filters of the vars resolved to their functions, indexed like the filter table */
+	TArray<FTemplateFilterCall> Filters;
+};
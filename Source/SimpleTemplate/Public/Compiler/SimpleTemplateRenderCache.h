@@ -0,0 +1,128 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+#include "Compiler/SimpleTemplateProgram.h"
+
+/**
+ * Keeps the output of the previous render of a template split along the token tree: the
+ * output of every var, the branch every 'if' took and the output of every item of every loop,
+ * nested ones included. Rendering again with the data paths that changed since then only
+ * renders the vars, conditions and loop items that depend on them and splices the result.
+ *
+ * Changed paths use the keys of the data, list items are addressed by index: 'Items.3.Score'
+ * only renders the tokens reading 'Score' in the fourth item of a loop over 'Items'. Lists that
+ * grow or shrink should be reported as a change of the list itself.
+ */
+class SIMPLETEMPLATE_API FTemplateRenderCache
+{
+public:
+	/**
+	 * Render the tokens, reusing the output of the previous render where possible.
+	 *
+	 * @param Tokens The compiled tokens, a different token tree renders everything.
+	 * @param Context The context holding the data.
+	 * @param ChangedPaths Data paths changed since the previous render.
+	 * @param OutString The full output.
+	 * @return true on success.
+	 */
+	bool Interpret(const FTokenArray& Tokens, FTemplateCompilerContent& Context, const TArray<FString>& ChangedPaths, FString& OutString);
+
+	/** Render a flat program, its tokens are rebuilt into the cache when the program changes */
+	bool Interpret(const FTemplateProgram& Program, FTemplateCompilerContent& Context, const TArray<FString>& ChangedPaths, FString& OutString);
+
+	/** Forget the previous render, the next one renders everything */
+	void Reset()
+	{
+		Segments.Reset();
+		Rendered.Reset();
+		Arena.Reset();
+		ProgramTokens.Reset();
+		ProgramCrc = 0;
+	}
+
+private:
+	/** A changed path normalized to the form used by FTemplateDataPaths */
+	struct FChange
+	{
+		// 'Items.3.Sub.2' becomes 'Items[].Sub[]'
+		FString Path;
+
+		// Each list addressed by index and the index, ('Items', 3) and ('Items[].Sub', 2)
+		TArray<TPair<FString, int32>> Indices;
+
+		// The index into a list, INDEX_NONE if the change does not address one of its items
+		int32 FindIndex(const FString& List) const;
+	};
+
+	/** What a token of the tree reads, built once per token tree */
+	struct FSegment
+	{
+		// The token of the segment
+		FTokenPtr Token;
+
+		// Data paths the token and its children read
+		TArray<FString> DataPaths;
+
+		// Data paths the condition of an 'if' reads
+		TArray<FString> ConditionPaths;
+
+		// Resolved list of loops, 'Items[].Sub'
+		FString List;
+
+		// Segments of the children of 'if' and 'for' tokens
+		TArray<FSegment> Children;
+	};
+
+	/** Output of a segment at the last render */
+	struct FRendered
+	{
+		// Output of vars, text is written from the token
+		FString Output;
+
+		// Branch taken by an 'if'
+		bool bCondition = false;
+
+		// Children of an 'if' whose condition was true
+		TArray<FRendered> Children;
+
+		// Children of each item of a loop
+		TArray<TArray<FRendered>> Items;
+	};
+
+	static FChange NormalizePath(const FString& Path);
+
+	/** Build the segments of a token list inside the given loops */
+	static void BuildSegments(const FTokenArray& Tokens, TArray<const FTokenFor*>& Loops, TArray<FSegment>& OutSegments);
+
+	/** Render a list of segments, Changes null renders all of them */
+	void RenderSegments(const TArray<FSegment>& InSegments, TArray<FRendered>& InRendered, FTemplateCompilerContent& Context, const TArray<const FChange*>* Changes);
+
+	/** Render a single segment, Changes null renders it completely */
+	void RenderSegment(const FSegment& Segment, FRendered& Render, FTemplateCompilerContent& Context, const TArray<const FChange*>* Changes);
+
+	/** Render into the scratch buffer and return the result */
+	FString RenderToString(FTemplateCompilerContent& Context, TFunctionRef<void(FArchive& WriteStream)> Render);
+
+	/** Length of the output of a list of segments */
+	static int32 GetOutputLen(const TArray<FSegment>& InSegments, const TArray<FRendered>& InRendered);
+
+	/** Append the output of a list of segments */
+	static void AppendOutput(const TArray<FSegment>& InSegments, const TArray<FRendered>& InRendered, FString& OutString);
+
+private:
+	TArray<FSegment> Segments;
+	TArray<FRendered> Rendered;
+
+	/** Owner of the tokens of the segments */
+	TSharedPtr<FTokenArena> Arena;
+
+	/** Tokens rebuilt from a flat program and the crc of the program */
+	FTokenArray ProgramTokens;
+	uint32 ProgramCrc = 0;
+
+	/** Scratch buffer for rendering */
+	TArray<uint8> Buffer;
+};
@@ -6,6 +6,7 @@
 #include "UObject/ObjectMacros.h"
 #include "UObject/Interface.h"
 #include "Dom/JsonObject.h"
+#include "Interfaces/SimpleTemplateDataSource.h"
 #include "SimpleTemplateDataProvider.generated.h"
 
 UINTERFACE(BlueprintType)
@@ -22,4 +23,10 @@ class SIMPLETEMPLATE_API ISimpleTemplateDataProvider
     GENERATED_IINTERFACE_BODY()
 
     virtual TSharedPtr<FJsonObject> GetData() const = 0;
+
+    /** Optional native data source, if provided GetData is not used to interpret a template */
+    virtual TSharedPtr<ISimpleTemplateDataSource> GetDataSource() const
+    {
+        return nullptr;
+    }
 };
@@ -0,0 +1,60 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+
+/**
+* Native access to template data, the interpreter asks for the values it needs instead of
+* reading a prebuilt json payload.
+*/
+class SIMPLETEMPLATE_API ISimpleTemplateDataSource
+{
+public:
+	virtual ~ISimpleTemplateDataSource() {}
+
+	/**
+	* Resolve a dotted key relative to this source.
+	*
+	* @param Key The key to resolve, an empty key resolves the source itself.
+	* @return The value or nullptr if the key does not exist.
+	*/
+	virtual TSharedPtr<FJsonValue> GetValue(const FString& Key) = 0;
+
+	/**
+	* Get the text of a value, var tokens use it to write values. Sources override it to skip
+	* creating a json value.
+	*
+	* @param Key The key to resolve, an empty key resolves the source itself.
+	* @param OutString The text, written like the string of the json value.
+	* @return false if the key does not exist or its value has no text, e.g. a list.
+	*/
+	virtual bool GetString(const FString& Key, FString& OutString)
+	{
+		TSharedPtr<FJsonValue> Value = GetValue(Key);
+		return Value.IsValid() && Value->TryGetString(OutString);
+	}
+
+	/**
+	* Get a number without creating a json value, conditions ask for it before calling GetValue.
+	* Sources with numbers of their own override it, e.g. the index of a loop.
+	*
+	* @param Key The key to resolve.
+	* @param OutNumber The number.
+	* @return false if the value is not a number known to the source, GetValue is used then.
+	*/
+	virtual bool TryGetNumber(const FString& Key, double& OutNumber)
+	{
+		return false;
+	}
+
+	/**
+	* Iterate the list found at the given key.
+	*
+	* @param Key The key of the list.
+	* @param Callback Called for each element, the element is only valid during the call.
+	* @return false if the key does not exist or is not a list.
+	*/
+	virtual bool IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback) = 0;
+};
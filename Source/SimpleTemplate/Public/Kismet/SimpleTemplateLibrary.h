@@ -5,9 +5,19 @@
 #include "Compiler/SimpleTemplateCompiler.h"
 #include "SimpleTemplate.h"
 #include "SimpleTemplateData.h"
+#include "SimpleTemplateObjectData.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "SimpleTemplateLibrary.generated.h"
 
+/** Output of a previous render, used to only render again what changed */
+USTRUCT(BlueprintType)
+struct SIMPLETEMPLATE_API FSimpleTemplateRenderState
+{
+	GENERATED_USTRUCT_BODY()
+
+	TSharedPtr<FTemplateRenderCache> Cache;
+};
+
 UCLASS()
 class SIMPLETEMPLATE_API USimpleTemplateLibrary : public UBlueprintFunctionLibrary
 {
@@ -19,6 +29,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Simple Template Engine")
 	static USimpleTemplateData* NewDataProvider(const FString& Data);
 
+	/** Create a data provider that reads the properties of an object */
+	UFUNCTION(BlueprintCallable, Category = "Simple Template Engine")
+	static USimpleTemplateObjectData* NewObjectDataProvider(UObject* Object);
+
 	/** Interpret a template */
 	UFUNCTION(BlueprintCallable, Category = "Simple Template Engine", meta = (DisplayName = "Interpret (From Provider"))
 	static FString Interpret_FromProvider(USimpleTemplate* SimpleTemplate, TScriptInterface<ISimpleTemplateDataProvider> DataProvider);
@@ -27,6 +41,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Simple Template Engine", meta = (DisplayName = "Interpret (From JSON String"))
 	static FString Interpret_FromJSONString(USimpleTemplate* SimpleTemplate, const FString& Data);
 
+	/** Interpret a template */
+	UFUNCTION(BlueprintCallable, Category = "Simple Template Engine", meta = (DisplayName = "Interpret (From Object"))
+	static FString Interpret_FromObject(USimpleTemplate* SimpleTemplate, UObject* Object);
+
+	/** Interpret a template again, only the parts that depend on the changed data paths are rendered */
+	UFUNCTION(BlueprintCallable, Category = "Simple Template Engine", meta = (DisplayName = "Interpret Incremental (From Provider"))
+	static FString InterpretIncremental_FromProvider(USimpleTemplate* SimpleTemplate, TScriptInterface<ISimpleTemplateDataProvider> DataProvider, const TArray<FString>& ChangedPaths, UPARAM(ref) FSimpleTemplateRenderState& RenderState);
+
 	/** Compile & Interpret a template */
 	UFUNCTION(BlueprintCallable, Category = "Simple Template Engine", meta = (DisplayName = "Compile & Interpret (From Provider"))
 	static FString CompileAndInterpret_FromProvider(const FString& Template, TScriptInterface<ISimpleTemplateDataProvider> DataProvider);
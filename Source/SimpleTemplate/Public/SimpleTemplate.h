@@ -9,10 +9,20 @@
 
 #include "SimpleTemplateData.h"
 #include "Compiler/SimpleTemplateCompiler.h"
+#include "Compiler/SimpleTemplateNative.h"
+#include "Compiler/SimpleTemplateProfiler.h"
+#include "Compiler/SimpleTemplateProgram.h"
+#include "Compiler/SimpleTemplateRenderCache.h"
 
 #include "Interfaces/SimpleTemplateDataProvider.h"
 
+#include "UObject/SoftObjectPath.h"
 #include "Serialization/JsonTypes.h"
+#include "Serialization/CustomVersion.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/ScopeLock.h"
+#include "Async/Future.h"
 
 #include "SimpleTemplate.generated.h"
 
@@ -34,6 +44,59 @@ enum class ETemplateStatus : uint8
 	TS_BeingCreated
 };
 
+/**
+ * A template inlined by '{% include %}', kept to recompile when it changes.
+ */
+USTRUCT()
+struct FSimpleTemplateInclude
+{
+	GENERATED_USTRUCT_BODY()
+
+	FSimpleTemplateInclude()
+		: SourceHash(0)
+	{}
+
+	/** The included template */
+	UPROPERTY()
+	FSoftObjectPath Template;
+
+	/** Hash of its source when it was inlined */
+	UPROPERTY()
+	uint32 SourceHash;
+};
+
+/**
+ * Source of a template kept in cooked data, compiled when the compiled data was written by
+ * another TPL_VERSION. Holds what compiling needs outside of the editor.
+ */
+struct FSimpleTemplateFallbackSource
+{
+	FSimpleTemplateFallbackSource()
+		: Escape(ETemplateEscape::None)
+		, bStripBlocks(false)
+	{}
+
+	/** The template source */
+	FString Source;
+
+	/** Source of every template it includes, nested ones too, by object path */
+	TMap<FString, FString> Includes;
+
+	ETemplateEscape Escape;
+	bool bStripBlocks;
+
+	friend FArchive& operator<<(FArchive& Ar, FSimpleTemplateFallbackSource& FallbackSource)
+	{
+		uint8 Escape = (uint8)FallbackSource.Escape;
+		Ar << FallbackSource.Source;
+		Ar << FallbackSource.Includes;
+		Ar << Escape;
+		Ar << FallbackSource.bStripBlocks;
+		FallbackSource.Escape = (ETemplateEscape)Escape;
+		return Ar;
+	}
+};
+
 /**
  * Asset used to implement complex template replace logic.
  */
@@ -50,6 +113,14 @@ public:
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Simple Template")
 	FText Template;
 
+	/** How values are escaped, var tokens can choose their own with a filter like '{$Name|raw}' */
+	UPROPERTY(EditAnywhere, Category="Simple Template")
+	ETemplateEscape Escape;
+
+	/** Remove the lines of control tokens that are alone on their line, indentation and line break included */
+	UPROPERTY(EditAnywhere, Category="Simple Template")
+	bool bStripBlockWhitespace;
+
 	// TemplateError
 	UPROPERTY()
 	TArray<FString> LastErrors;
@@ -59,11 +130,96 @@ public:
 	uint32 LineNumber;
 	UPROPERTY()
 	uint32 CharacterNumber;
+
+	/** Templates inlined by the last successful compile */
+	UPROPERTY()
+	TArray<FSimpleTemplateInclude> Includes;
+
+private:
+	/** Incremented by every CompileAsync, results of older ones are discarded */
+	int32 AsyncCompileSerial;
+
+	/** Tokens of the last compile, CompileAsync only tokenizes the edited part of the source again */
+	TSharedPtr<FTemplateTokenizerState, ESPMode::ThreadSafe> TokenizerState;
+
+	/** Why the template can not be cooked, found ahead of saving by BeginCacheForCookedPlatformData */
+	FString CookError;
+
+public:
 #endif
 
 #if WITH_EDITOR
 	bool Compile();
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	/**
+	 * Compile many templates, results are fetched from the derived data cache and the others are
+	 * tokenized in parallel. Includes are looked up among the given templates, templates including
+	 * others are compiled on the game thread.
+	 *
+	 * @param Templates The templates to compile.
+	 * @param OutSeconds Optional, the compile time of each template.
+	 * @return The number of templates that failed to compile.
+	 */
+	static int32 CompileAll(const TArray<USimpleTemplate*>& Templates, TArray<double>* OutSeconds = nullptr);
+
+	/**
+	 * Compile the current source on a worker thread, e.g. while it is being edited. The result is applied
+	 * on the game thread unless the source changed or another compile started meanwhile. Templates
+	 * included for the first time are loaded on the game thread once the worker is done. While the
+	 * included templates are unchanged, only the edited part of the source is tokenized again.
+	 *
+	 * @param OnCompiled Optional, called on the game thread when the result was applied.
+	 */
+	void CompileAsync(TFunction<void(bool bSuccess)> OnCompiled = nullptr);
+
+	/** Discard the results of the background compiles still running */
+	void CancelAsyncCompile()
+	{
+		AsyncCompileSerial++;
+	}
+
+	/** Find an included template, names without a path are looked up next to the template including it */
+	static USimpleTemplate* FindInclude(const FString& Name, const FString& IncludingPath);
+
+	/** False if a template we include changed since we were compiled */
+	bool AreIncludesUpToDate() const;
+
+private:
+	/** Create a compiler for the source with the given options, Path is the one of the template for resolving includes. Safe on any thread. */
+	static TSharedRef<TTemplateTokenizer<TCHAR>> CreateCompiler(const FString& Source, const FString& Path, ETemplateEscape InEscape, bool bStripBlocks, TTemplateTokenizer<TCHAR>::FIncludeResolver IncludeResolver);
+
+	/** Create a compiler for the source with the options of this template */
+	TSharedRef<TTemplateTokenizer<TCHAR>> CreateCompiler(const FString& Source, const FString& Path, TTemplateTokenizer<TCHAR>::FIncludeResolver IncludeResolver) const;
+
+	/** Create a compiler for the template, includes are loaded */
+	TSharedRef<TTemplateTokenizer<TCHAR>> CreateCompiler() const;
+
+	/** Compile with the derived data cache, notify the editor about the change if asked to */
+	bool CompileSource(bool bNotify);
+
+	/** Take the result of a compiler, notify the editor about the change if asked to */
+	void FinishCompile(TTemplateTokenizer<TCHAR>& Compiler, bool bSuccess, bool bNotify);
+
+	/** Use the tokens of a successful compile */
+	void SetCompiledTokens(const FTokenArray& InTokens);
+
+	/** Key of the compiled data of a source in the derived data cache, from the source and the compile options */
+	FString GetDerivedDataKey(const FString& Source) const;
+
+	/** Take compiled data from the derived data cache, fails if a template it includes changed since */
+	bool ApplyDerivedData(const TArray<uint8>& Data, bool bNotify);
+
+	/** Store the result of the last successful compile in the derived data cache */
+	void PutDerivedData(const FString& Key) const;
+
+	/** Recompile the loaded templates that include this one, templates including it through several others are compiled once */
+	void RecompileDependents();
+
+	/** Recompile the dependents not visited yet and add them, Visited holds the templates already compiled */
+	void RecompileDependents(TSet<USimpleTemplate*>& Visited);
+
+public:
 #endif
 
 	bool IsUpToDate() const
@@ -83,9 +239,88 @@ public:
 
 	FString Interpret(TScriptInterface<ISimpleTemplateDataProvider> DataProvider);
 	FString Interpret(TSharedPtr<FJsonObject> Data);
+	FString Interpret(ISimpleTemplateDataSource& DataSource);
+
+	/** Interpret using a render context owned by the caller, e.g. to keep one per worker in batch jobs */
+	FString Interpret(FTemplateRenderContext& RenderContext, TSharedPtr<FJsonObject> Data);
+	FString Interpret(FTemplateRenderContext& RenderContext, ISimpleTemplateDataSource& DataSource);
+
+	/** Interpret again, only the parts that depend on the changed data paths are rendered, see FTemplateRenderCache */
+	FString InterpretIncremental(TScriptInterface<ISimpleTemplateDataProvider> DataProvider, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache);
+	FString InterpretIncremental(TSharedPtr<FJsonObject> Data, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache);
+	FString InterpretIncremental(ISimpleTemplateDataSource& DataSource, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache);
+
+#if WITH_EDITOR
+	/**
+	 * Render the template with the profiler on and report the time and output of every token.
+	 * The compiled data is left untouched, source locations are only known for templates compiled in the editor.
+	 */
+	FSimpleTemplateProfile Profile(TScriptInterface<ISimpleTemplateDataProvider> DataProvider, int32 NumRenders = 1);
+#endif
+
+	/** The data paths the compiled template reads, loop items are written as 'List[].Key' */
+	UFUNCTION(BlueprintPure, Category="Simple Template")
+	TArray<FString> GetDataPaths() const
+	{
+		// Waits for a fallback compile running on a worker, it updates them
+		FScopeLock Lock(&PendingDataLock);
+		return DataPaths;
+	}
+
+	/** Update the data paths from the compiled tokens */
+	void UpdateDataPaths();
+
+	/** The sorted data paths read by a token tree */
+	static TArray<FString> CollectDataPaths(const FTokenArray& InTokens);
+
+	/** Load the compiled data now if loading it was deferred, see SimpleTemplate.DeferredLoad */
+	void EnsureLoaded();
+
+	/** Load deferred compiled data or compile outdated cooked data on a worker thread ahead of the first render */
+	UFUNCTION(BlueprintCallable, Category="Simple Template")
+	void PreloadAsync();
+
+	/** Object path of an included template, names without a path are looked up in the given package path, e.g. the one of the including template */
+	static FString GetIncludePath(const FString& Name, const FString& PackagePath);
+
+	/** Number of outdated cooked templates compiled from their source and how many of them failed, for telemetry */
+	static void GetFallbackCompileCounts(int32& OutCompiles, int32& OutFailures);
+
+private:
+	/** Sets up cooked states without cooking */
+	friend class FSimpleTemplateFallbackCompileTest;
+	friend class FSimpleTemplateDeferredViewTest;
+
+	/** Compile the cooked source if the compiled data was outdated, see SimpleTemplate.CookSource */
+	void CompileFallbackSource();
+
+	/** Find the native render function of the compiled template, see FTemplateNativeRegistry */
+	void ResolveNative();
+
+	/** Load tokens or program, returns false if the data is not valid */
+	bool SerializeCompiledData(FArchive& Ar, bool bUpdateDataPaths);
+
+	/** Render a cooked program straight from the deferred data, returns false if it has to be copied */
+	bool InitializeProgramView();
+
+	/** Forget the program and the cooked data it might be a view into */
+	void ResetProgram();
+
+	FString Interpret(FTemplateRenderContext& RenderContext);
+	FString InterpretIncremental(FTemplateCompilerContent& Context, const TArray<FString>& ChangedPaths, FTemplateRenderCache& Cache);
+
+public:
 
 	// UObject interface
 	virtual void Serialize(FArchive& Ar) override;
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#if WITH_EDITOR
+	virtual void BeginCacheForCookedPlatformData(const class ITargetPlatform* TargetPlatform) override;
+	virtual void ClearAllCachedCookedPlatformData() override;
+#endif
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 
 public:
 
@@ -95,4 +330,44 @@ public:
 
 	/** Compiled tokens */
 	FTokenArray Tokens;
+
+	/** Flat program loaded from cooked data, used instead of the tokens */
+	FTemplateProgram Program;
+
+	/** Data paths read by the compiled tokens */
+	UPROPERTY(VisibleAnywhere, Category="Simple Template")
+	TArray<FString> DataPaths;
+
+private:
+	/** Compiled data kept serialized until first use */
+	TArray<uint8> PendingData;
+	FThreadSafeBool bHasPendingData;
+	mutable FCriticalSection PendingDataLock;
+
+	/** State of the archive the pending data was read from, it is read with the same */
+	FCustomVersionContainer PendingCustomVersions;
+	int32 PendingUE4Ver;
+	int32 PendingLicenseeUE4Ver;
+	bool bPendingByteSwapping;
+
+	/** Deferred data the program is a view into, see InitializeProgramView */
+	TArray<uint8> ProgramData;
+
+	/** Running PreloadAsync, started by PostLoad for outdated cooked data */
+	TFuture<void> PendingLoad;
+
+	/** Cooked source, kept while the compiled data is outdated or set for cooking */
+	TUniquePtr<FSimpleTemplateFallbackSource> FallbackSource;
+	FThreadSafeBool bNeedsFallbackCompile;
+
+	/** Our path and stat id for the fallback compile, taken on the game thread by PreloadAsync */
+	FString FallbackPath;
+	TStatId FallbackStatId;
+
+	/** Transpiled render function of the compiled template */
+	FTemplateNativeFunction NativeFunction;
+	FThreadSafeBool bNativeResolved;
+
+	/** FTemplateNativeRegistry::GetGeneration when NativeFunction was looked up */
+	FThreadSafeCounter NativeGeneration;
 };
@@ -0,0 +1,43 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "UObject/ObjectMacros.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/SimpleTemplateDataProvider.h"
+#include "SimpleTemplateLazyDataSource.h"
+
+#include "SimpleTemplateLazyData.generated.h"
+
+/**
+ * Object used to provide a SimpleTemplate with data pulled on demand, see FSimpleTemplateLazyDataSource.
+ */
+UCLASS(BlueprintType, hidecategories=(Object))
+class SIMPLETEMPLATE_API USimpleTemplateLazyData : public UObject, public ISimpleTemplateDataProvider
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Set the callbacks used to pull the data.
+	 *
+	 * @param ResolvePath Callback used to resolve values.
+	 * @param IterateArray Callback used to iterate lists.
+	 * @param bCacheValues Keep resolved values until ResetCache is called.
+	 */
+	void SetCallbacks(FSimpleTemplateLazyDataSource::FResolvePath ResolvePath, FSimpleTemplateLazyDataSource::FIterateArray IterateArray = FSimpleTemplateLazyDataSource::FIterateArray(), bool bCacheValues = false);
+
+	/** Drop all cached values */
+	UFUNCTION(BlueprintCallable, Category = "Data")
+	void ResetCache();
+
+	virtual TSharedPtr<FJsonObject> GetData() const override;
+	virtual TSharedPtr<ISimpleTemplateDataSource> GetDataSource() const override;
+
+private:
+
+	/** Data source bound to the callbacks */
+	TSharedPtr<FSimpleTemplateLazyDataSource> DataSource;
+};
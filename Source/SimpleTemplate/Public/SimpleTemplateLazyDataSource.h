@@ -0,0 +1,84 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "Interfaces/SimpleTemplateDataSource.h"
+
+/**
+ * Data source over a single json value, used for the items of lazily iterated lists.
+ */
+class SIMPLETEMPLATE_API FSimpleTemplateJsonDataSource : public ISimpleTemplateDataSource
+{
+public:
+	FSimpleTemplateJsonDataSource(const TSharedPtr<FJsonValue>& InValue)
+		: Value(InValue)
+	{}
+
+	/** Point the source to a different value */
+	void SetJsonValue(const TSharedPtr<FJsonValue>& InValue)
+	{
+		Value = InValue;
+	}
+
+	//~ ISimpleTemplateDataSource interface
+
+	virtual TSharedPtr<FJsonValue> GetValue(const FString& Key) override;
+	virtual bool IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback) override;
+
+private:
+	TSharedPtr<FJsonValue> Value;
+};
+
+/**
+ * Pull based data source, values are produced by callbacks only when the interpreter needs them.
+ *
+ * Usage:
+ *   FSimpleTemplateLazyDataSource DataSource(
+ *       [&](const FString& Path) { return SaveGame->Lookup(Path); },
+ *       [&](const FString& Path, TFunctionRef<void(const TSharedPtr<FJsonValue>&)> Callback) { return SaveGame->ForEach(Path, Callback); });
+ *   SimpleTemplate->Interpret(DataSource);
+ */
+class SIMPLETEMPLATE_API FSimpleTemplateLazyDataSource : public ISimpleTemplateDataSource
+{
+public:
+	/** Resolve a dotted path into a value, nullptr if it does not exist */
+	typedef TFunction<TSharedPtr<FJsonValue>(const FString& Path)> FResolvePath;
+
+	/** Call back once for each item of the list at path, false if there is no such list */
+	typedef TFunction<bool(const FString& Path, TFunctionRef<void(const TSharedPtr<FJsonValue>& Item)> Callback)> FIterateArray;
+
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InResolvePath Callback used to resolve values.
+	 * @param InIterateArray Callback used to iterate lists, lists are resolved through InResolvePath if not set.
+	 * @param bInCacheValues Keep resolved values so each path is only pulled once.
+	 */
+	FSimpleTemplateLazyDataSource(FResolvePath InResolvePath, FIterateArray InIterateArray = FIterateArray(), bool bInCacheValues = false)
+		: ResolvePath(MoveTemp(InResolvePath))
+		, IterateArray(MoveTemp(InIterateArray))
+		, bCacheValues(bInCacheValues)
+	{}
+
+	/** Drop all cached values, e.g. after the underlying data changed */
+	void ResetCache()
+	{
+		Cache.Reset();
+	}
+
+	//~ ISimpleTemplateDataSource interface
+
+	virtual TSharedPtr<FJsonValue> GetValue(const FString& Key) override;
+	virtual bool IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback) override;
+
+private:
+	FResolvePath ResolvePath;
+	FIterateArray IterateArray;
+
+	/** Cached values */
+	bool bCacheValues;
+	TMap<FString, TSharedPtr<FJsonValue>> Cache;
+};
@@ -0,0 +1,42 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "UObject/ObjectMacros.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/SimpleTemplateDataProvider.h"
+
+#include "SimpleTemplateObjectData.generated.h"
+
+/**
+ * Object used to provide a SimpleTemplate with the properties of another object, values
+ * are read using reflection so no json has to be built.
+ */
+UCLASS(BlueprintType, hidecategories=(Object))
+class SIMPLETEMPLATE_API USimpleTemplateObjectData : public UObject, public ISimpleTemplateDataProvider
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Set the object whose properties the template reads */
+	UFUNCTION(BlueprintCallable, Category = "Data")
+	void SetSourceObject(UObject* InSourceObject);
+
+	/** Get the object whose properties the template reads */
+	UFUNCTION(BlueprintPure, Category = "Data")
+	UObject* GetSourceObject() const;
+
+	virtual TSharedPtr<FJsonObject> GetData() const override;
+	virtual TSharedPtr<ISimpleTemplateDataSource> GetDataSource() const override;
+
+private:
+
+	/** The object we read from */
+	UPROPERTY(Transient)
+	UObject* SourceObject;
+
+	/** Data source bound to the source object */
+	TSharedPtr<ISimpleTemplateDataSource> DataSource;
+};
@@ -0,0 +1,77 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Class.h"
+#include "UObject/UnrealType.h"
+#include "Interfaces/SimpleTemplateDataSource.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+// Properties are fields instead of objects since 4.25, older engines read them under the new name
+#define TPL_OBJECT_PROPERTIES (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION < 25)
+
+#if TPL_OBJECT_PROPERTIES
+typedef UProperty FProperty;
+#endif
+
+/**
+ * Data source that reads values straight from UObject/UStruct properties using reflection.
+ *
+ * Keys are property names separated by dots, walking into nested structs, object references
+ * and list elements ("Inventory.0.Name"). Resolved property paths are cached per class and thread
+ * so the reflection lookup only happens the first time a template reads a key, later reads do not
+ * lock. Var tokens read values straight from the properties without creating json values.
+ *
+ * Usage:
+ *   FSimpleTemplatePropertyDataSource DataSource(FMyHudData::StaticStruct(), &HudData);
+ *   SimpleTemplate->Interpret(DataSource);
+ */
+class SIMPLETEMPLATE_API FSimpleTemplatePropertyDataSource : public ISimpleTemplateDataSource
+{
+public:
+	/** Source reading the properties of an object */
+	FSimpleTemplatePropertyDataSource(const UObject* InObject);
+
+	/** Source reading the properties of a struct or object in memory */
+	FSimpleTemplatePropertyDataSource(const UStruct* InStruct, const void* InContainer);
+
+	/** Source reading a single property value, e.g. an element of a list */
+	FSimpleTemplatePropertyDataSource(const FProperty* InProperty, const void* InValue);
+
+	//~ ISimpleTemplateDataSource interface
+
+	virtual TSharedPtr<FJsonValue> GetValue(const FString& Key) override;
+	virtual bool GetString(const FString& Key, FString& OutString) override;
+	virtual bool IterateList(const FString& Key, TFunctionRef<void(ISimpleTemplateDataSource& Item)> Callback) override;
+
+public:
+
+	/** Convert a single property value into a json value */
+	static TSharedPtr<FJsonValue> PropertyToJson(const FProperty* Property, const void* Value);
+
+	/** Write the text of a single property value, like the string of its json value */
+	static bool PropertyToString(const FProperty* Property, const void* Value, FString& OutString);
+
+	/** Forget all cached property paths, e.g. after classes got reloaded */
+	static void ResetCache();
+
+private:
+
+	/** Resolve a key into the property and the memory holding its value */
+	bool Resolve(const FString& Key, const FProperty*& OutProperty, const void*& OutValue) const;
+
+private:
+
+	/** Struct or class whose properties we read, null for single value sources */
+	const UStruct* Struct;
+
+	/** Memory of the struct or object */
+	const void* Container;
+
+	/** The property of single value sources */
+	const FProperty* Property;
+
+	/** Memory of the single value */
+	const void* Value;
+};
@@ -0,0 +1,188 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "HAL/MemoryBase.h"
+#include "UObject/Object.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+// Unreal Insights trace channels are only available on newer engines
+#define TPL_TRACE_ENABLED (ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 26)
+
+#if TPL_TRACE_ENABLED
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#endif
+
+DECLARE_STATS_GROUP(TEXT("SimpleTemplate"), STATGROUP_SimpleTemplate, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Compile"), STAT_SimpleTemplate_Compile, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Deserialize"), STAT_SimpleTemplate_Deserialize, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interpret"), STAT_SimpleTemplate_Interpret, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Renders"), STAT_SimpleTemplate_Renders, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Tokens executed"), STAT_SimpleTemplate_Tokens, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Lookups"), STAT_SimpleTemplate_Lookups, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Loop iterations"), STAT_SimpleTemplate_LoopIterations, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes emitted"), STAT_SimpleTemplate_BytesEmitted, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Allocations"), STAT_SimpleTemplate_Allocations, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+
+// Outdated cooked templates compiled from their source, see SimpleTemplate.CookSource
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fallback compile"), STAT_SimpleTemplate_FallbackCompile, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Fallback compiles"), STAT_SimpleTemplate_FallbackCompiles, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Fallback compile failures"), STAT_SimpleTemplate_FallbackCompileFailures, STATGROUP_SimpleTemplate, SIMPLETEMPLATE_API);
+
+// Low level memory tracking, allocations are tagged by what they are used for
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("SimpleTemplate Compiler"), STAT_SimpleTemplateLLM_Compiler, STATGROUP_LLMFULL, SIMPLETEMPLATE_API);
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("SimpleTemplate Tokens"), STAT_SimpleTemplateLLM_Tokens, STATGROUP_LLMFULL, SIMPLETEMPLATE_API);
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("SimpleTemplate Interpreter"), STAT_SimpleTemplateLLM_Interpreter, STATGROUP_LLMFULL, SIMPLETEMPLATE_API);
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("SimpleTemplate Data"), STAT_SimpleTemplateLLM_Data, STATGROUP_LLMFULL, SIMPLETEMPLATE_API);
+
+// Tag the allocations of the current scope
+#define TPL_LLM_SCOPE(Stat) LLM_SCOPED_TAG_WITH_STAT(Stat, ELLMTracker::Default)
+
+#if TPL_TRACE_ENABLED && CPUPROFILERTRACE_ENABLED
+// Template scopes in Unreal Insights, enable with -trace=cpu,SimpleTemplate
+UE_TRACE_CHANNEL_EXTERN(SimpleTemplateChannel, SIMPLETEMPLATE_API);
+
+/** Trace event named after a template asset, the name is only built while the channel is on */
+class FSimpleTemplateTraceScope
+{
+public:
+	explicit FSimpleTemplateTraceScope(const UObject* Template)
+		: bEnabled(UE_TRACE_CHANNELEXPR_IS_ENABLED(SimpleTemplateChannel))
+	{
+		if (bEnabled)
+		{
+			FCpuProfilerTrace::OutputBeginDynamicEvent(*Template->GetName());
+		}
+	}
+
+	// Named by a copy of the template name, for threads that must not touch the object
+	explicit FSimpleTemplateTraceScope(const FString& TemplateName)
+		: bEnabled(UE_TRACE_CHANNELEXPR_IS_ENABLED(SimpleTemplateChannel))
+	{
+		if (bEnabled)
+		{
+			FCpuProfilerTrace::OutputBeginDynamicEvent(*TemplateName);
+		}
+	}
+
+	~FSimpleTemplateTraceScope()
+	{
+		if (bEnabled)
+		{
+			FCpuProfilerTrace::OutputEndEvent();
+		}
+	}
+
+private:
+	bool bEnabled;
+};
+
+#define TPL_TRACE_TEMPLATE_SCOPE(Template) FSimpleTemplateTraceScope TemplateTraceScope(Template);
+#else
+#define TPL_TRACE_TEMPLATE_SCOPE(Template)
+#endif
+
+// Names the work of the current scope after a template asset, in stat captures and in Insights
+#define TPL_SCOPE_TEMPLATE(Template) \
+	FScopeCycleCounterUObject TemplateCycleCounter(Template); \
+	TPL_TRACE_TEMPLATE_SCOPE(Template)
+
+// The same on worker threads, from the stat id and name of the template taken on the game thread, see TPL_TEMPLATE_STAT_ID
+#define TPL_SCOPE_TEMPLATE_NAMED(StatId, TemplateName) \
+	FScopeCycleCounter TemplateCycleCounter(StatId); \
+	TPL_TRACE_TEMPLATE_SCOPE(TemplateName)
+
+// Stat id of a template for TPL_SCOPE_TEMPLATE_NAMED
+#if STATS
+#define TPL_TEMPLATE_STAT_ID(Template) ((Template)->GetStatID(true))
+#else
+#define TPL_TEMPLATE_STAT_ID(Template) TStatId()
+#endif
+
+/**
+ * Work done by a single render. The interpreter counts into the render context and the
+ * counters are flushed to the stats once, so the hot paths stay free of stat calls.
+ */
+struct FTemplateRenderStats
+{
+	FTemplateRenderStats()
+		: Tokens(0)
+		, Lookups(0)
+		, LoopIterations(0)
+		, BytesEmitted(0)
+		, Allocations(0)
+		, MallocCallsAtStart(0)
+		, bCountingAllocations(false)
+	{}
+
+	// Malloc and realloc calls counted by the engine allocator, 0 with allocators that do not count them
+	static uint64 GetMallocCalls()
+	{
+		return FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+	}
+
+	// Start counting the allocations of a render
+	void Start()
+	{
+		MallocCallsAtStart = GetMallocCalls();
+		bCountingAllocations = true;
+	}
+
+	// Count the allocations since Start, calls of other threads are counted as well
+	void StopAllocations()
+	{
+		if (bCountingAllocations)
+		{
+			Allocations += (uint32)(GetMallocCalls() - MallocCallsAtStart);
+			bCountingAllocations = false;
+		}
+	}
+
+	// Add the counters to the stats of this frame and reset
+	void Flush()
+	{
+		StopAllocations();
+		INC_DWORD_STAT_BY(STAT_SimpleTemplate_Tokens, Tokens);
+		INC_DWORD_STAT_BY(STAT_SimpleTemplate_Lookups, Lookups);
+		INC_DWORD_STAT_BY(STAT_SimpleTemplate_LoopIterations, LoopIterations);
+		INC_DWORD_STAT_BY(STAT_SimpleTemplate_BytesEmitted, BytesEmitted);
+		INC_DWORD_STAT_BY(STAT_SimpleTemplate_Allocations, Allocations);
+		*this = FTemplateRenderStats();
+	}
+
+	// Count what was written to a stream between two of its positions, streams that can not tell are skipped
+	void AddOutput(int64 Begin, int64 End)
+	{
+		if (Begin >= 0 && End > Begin)
+		{
+			BytesEmitted += (uint32)(End - Begin);
+		}
+	}
+
+	uint32 Tokens;
+	uint32 Lookups;
+	uint32 LoopIterations;
+
+	// Written to the write stream of the render, whatever archive it is
+	uint32 BytesEmitted;
+
+	// Allocator calls between the start of the render and its flush, same counters as the benchmark
+	uint32 Allocations;
+	uint64 MallocCallsAtStart;
+	bool bCountingAllocations;
+};
+
+// Count work of the render of a FTemplateCompilerContent
+#if STATS
+#define TPL_RENDER_STAT(Context, Counter) ((Context).Stats.Counter++)
+#define TPL_RENDER_OUTPUT_STAT(Context, Begin, End) ((Context).Stats.AddOutput(Begin, End))
+#else
+#define TPL_RENDER_STAT(Context, Counter)
+#define TPL_RENDER_OUTPUT_STAT(Context, Begin, End)
+#endif
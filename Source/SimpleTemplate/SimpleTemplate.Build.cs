@@ -20,6 +20,12 @@ namespace UnrealBuildTool.Rules
 				new string[] {
 					"SimpleTemplate/Private",
 				});
+
+			if (Target.bBuildEditor)
+			{
+				// Compiled templates are cached in the editor
+				PrivateDependencyModuleNames.Add("DerivedDataCache");
+			}
 		}
 	}
 }
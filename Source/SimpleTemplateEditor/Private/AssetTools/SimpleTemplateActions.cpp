@@ -55,15 +55,15 @@ void FSimpleTemplateActions::GetActions(const TArray<UObject*>& InObjects, FMenu
 
 void FSimpleTemplateActions::CompileSelected(TArray<TWeakObjectPtr<USimpleTemplate>> SimpleTemplates)
 {
+	TArray<USimpleTemplate*> Templates;
 	for (auto& SimpleTemplate : SimpleTemplates)
 	{
 		if (SimpleTemplate.IsValid() && !SimpleTemplate->Template.IsEmpty())
 		{
-			SimpleTemplate->Compile();
-			SimpleTemplate->PostEditChange();
-			SimpleTemplate->MarkPackageDirty();
+			Templates.Add(SimpleTemplate.Get());
 		}
 	}
+	USimpleTemplate::CompileAll(Templates);
 }
 
 void FSimpleTemplateActions::ExportTemplates(TArray<TWeakObjectPtr<USimpleTemplate>> SimpleTemplates)
@@ -0,0 +1,175 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateBenchmarkCommandlet.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+#include "Compiler/SimpleTemplateProgram.h"
+#include "SimpleTemplateBenchmarkWorkloads.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSimpleTemplateBenchmark, Log, All);
+
+/* USimpleTemplateBenchmarkCommandlet structors
+ *****************************************************************************/
+
+USimpleTemplateBenchmarkCommandlet::USimpleTemplateBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/* UCommandlet interface
+ *****************************************************************************/
+
+int32 USimpleTemplateBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 Scale = 10;
+	int32 Iterations = 100;
+	FString WorkloadName;
+	FString CsvFilename;
+	FParse::Value(*Params, TEXT("Scale="), Scale);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Workload="), WorkloadName);
+	FParse::Value(*Params, TEXT("Csv="), CsvFilename);
+	Scale = FMath::Max(1, Scale);
+	Iterations = FMath::Max(1, Iterations);
+
+	TArray<FResult> Results;
+	bool bSuccess = true;
+	for (const FSimpleTemplateBenchmarkWorkload& Workload : SimpleTemplateBenchmarkWorkloads::All(Scale))
+	{
+		if (!WorkloadName.IsEmpty() && !Workload.Name.Equals(WorkloadName, ESearchCase::IgnoreCase))
+		{
+			continue;
+		}
+
+		FResult Result;
+		if (!Run(Workload, Scale, Iterations, Result))
+		{
+			UE_LOG(LogSimpleTemplateBenchmark, Error, TEXT("%s: template failed to compile"), *Workload.Name);
+			bSuccess = false;
+			continue;
+		}
+
+		UE_LOG(LogSimpleTemplateBenchmark, Display, TEXT("%-12s tokens %6d | compile %10.2f us %8.0f allocs | incremental %10.2f us %8.0f allocs | render %10.2f us %8.2f ns/token %8.2f MB/s %8.0f allocs | program %10.2f us %8.0f allocs"),
+			*Result.Name,
+			Result.NumTokens,
+			Result.CompileSeconds * 1e6, Result.CompileAllocs,
+			Result.IncrementalCompileSeconds * 1e6, Result.IncrementalCompileAllocs,
+			Result.RenderSeconds * 1e6, Result.RenderSeconds * 1e9 / FMath::Max(1, Result.NumTokens), Result.OutputBytes / Result.RenderSeconds / (1024.0 * 1024.0), Result.RenderAllocs,
+			Result.ProgramRenderSeconds * 1e6, Result.ProgramRenderAllocs);
+		Results.Add(Result);
+	}
+
+	if (!CsvFilename.IsEmpty())
+	{
+		WriteCsv(CsvFilename, Results);
+	}
+	return bSuccess ? 0 : 1;
+}
+
+
+/* USimpleTemplateBenchmarkCommandlet implementation
+ *****************************************************************************/
+
+bool USimpleTemplateBenchmarkCommandlet::Run(const FSimpleTemplateBenchmarkWorkload& Workload, int32 Scale, int32 Iterations, FResult& OutResult) const
+{
+	using namespace SimpleTemplateBenchmarkWorkloads;
+
+	auto Compiler = TTemplateCompilerFactory<TCHAR>::Create(Workload.Template);
+	if (!Compiler->Compile())
+	{
+		return false;
+	}
+	const FTokenArray& Tokens = Compiler->GetTokenTree();
+
+	OutResult.Name = Workload.Name;
+	OutResult.Scale = Scale;
+	OutResult.NumTokens = CountTokens(Tokens);
+
+	OutResult.CompileSeconds = Measure(Iterations, OutResult.CompileAllocs, [&Workload]()
+	{
+		TTemplateCompilerFactory<TCHAR>::Create(Workload.Template)->Compile();
+	});
+
+	// A char typed in the middle, only the edited part is tokenized again
+	const FString Edited = EditInMiddle(Workload.Template);
+	const TSharedPtr<const FTemplateTokenizerState, ESPMode::ThreadSafe> State = Compiler->GetState();
+	OutResult.IncrementalCompileSeconds = Measure(Iterations, OutResult.IncrementalCompileAllocs, [&Edited, &State]()
+	{
+		auto EditCompiler = TTemplateCompilerFactory<TCHAR>::Create(Edited);
+		EditCompiler->SetPrevious(State);
+		EditCompiler->Compile();
+	});
+
+	// Warm up, this also sizes the render context of the thread
+	TTemplateInterpreter Interpreter(Tokens);
+	FString Output;
+	Interpreter.Interpret(Output, Workload.Data);
+	OutResult.OutputBytes = Output.Len() * sizeof(TCHAR);
+
+	OutResult.RenderSeconds = Measure(Iterations, OutResult.RenderAllocs, [&Interpreter, &Workload, &Output]()
+	{
+		Interpreter.Interpret(Output, Workload.Data);
+	});
+
+	// Cooked templates render the flat program
+	FTemplateProgram Program;
+	Program.Build(Tokens);
+	FTemplateRenderContext RenderContext;
+	OutResult.ProgramRenderSeconds = Measure(Iterations, OutResult.ProgramRenderAllocs, [&Program, &RenderContext, &Workload, &Output]()
+	{
+		Program.Interpret(RenderContext.Begin(Workload.Data), RenderContext.GetWriteStream());
+		Output = RenderContext.Finish();
+	});
+	return true;
+}
+
+
+void USimpleTemplateBenchmarkCommandlet::WriteCsv(const FString& Filename, const TArray<FResult>& Results) const
+{
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*Filename))
+	{
+		Csv += TEXT("Date,Workload,Scale,Tokens,OutputBytes,CompileUs,CompileAllocs,RenderUs,RenderNsPerToken,RenderBytesPerSec,RenderAllocs,ProgramRenderUs,ProgramRenderNsPerToken,ProgramRenderAllocs,IncrementalCompileUs,IncrementalCompileAllocs\n");
+	}
+
+	const FString Date = FDateTime::UtcNow().ToIso8601();
+	for (const FResult& Result : Results)
+	{
+		const int32 NumTokens = FMath::Max(1, Result.NumTokens);
+		Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%.3f,%.1f,%.3f,%.3f,%.0f,%.1f,%.3f,%.3f,%.1f,%.3f,%.1f\n"),
+			*Date,
+			*Result.Name,
+			Result.Scale,
+			Result.NumTokens,
+			Result.OutputBytes,
+			Result.CompileSeconds * 1e6,
+			Result.CompileAllocs,
+			Result.RenderSeconds * 1e6,
+			Result.RenderSeconds * 1e9 / NumTokens,
+			Result.OutputBytes / Result.RenderSeconds,
+			Result.RenderAllocs,
+			Result.ProgramRenderSeconds * 1e6,
+			Result.ProgramRenderSeconds * 1e9 / NumTokens,
+			Result.ProgramRenderAllocs,
+			Result.IncrementalCompileSeconds * 1e6,
+			Result.IncrementalCompileAllocs);
+	}
+
+	if (FFileHelper::SaveStringToFile(Csv, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogSimpleTemplateBenchmark, Display, TEXT("Results written to %s"), *FPaths::ConvertRelativePathToFull(Filename));
+	}
+	else
+	{
+		UE_LOG(LogSimpleTemplateBenchmark, Error, TEXT("Could not write results to %s"), *Filename);
+	}
+}
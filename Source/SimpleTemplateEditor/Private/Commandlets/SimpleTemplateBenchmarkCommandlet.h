@@ -0,0 +1,60 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UObject/ObjectMacros.h"
+
+#include "SimpleTemplateBenchmarkCommandlet.generated.h"
+
+struct FSimpleTemplateBenchmarkWorkload;
+
+/**
+ * Benchmarks compiling and rendering of synthetic templates.
+ *
+ * Usage:
+ *   UE4Editor-Cmd.exe <Project> -run=SimpleTemplateBenchmark [-Workload=BigLoop] [-Scale=10] [-Iterations=100] [-Csv=Benchmark.csv]
+ *
+ * Every workload reports compile, incremental compile and render times, ns per token, output
+ * bytes per second and allocations. Results are appended to the csv file so they can be tracked over time.
+ */
+UCLASS()
+class USimpleTemplateBenchmarkCommandlet
+	: public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Default constructor. */
+	USimpleTemplateBenchmarkCommandlet();
+
+	//~ UCommandlet interface
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	/** Result of a single workload */
+	struct FResult
+	{
+		FString Name;
+		int32 Scale;
+		int32 NumTokens;
+		int32 OutputBytes;
+		double CompileSeconds;
+		double CompileAllocs;
+		double IncrementalCompileSeconds;
+		double IncrementalCompileAllocs;
+		double RenderSeconds;
+		double RenderAllocs;
+		double ProgramRenderSeconds;
+		double ProgramRenderAllocs;
+	};
+
+	/** Run a workload, false if the template did not compile */
+	bool Run(const FSimpleTemplateBenchmarkWorkload& Workload, int32 Scale, int32 Iterations, FResult& OutResult) const;
+
+	/** Append the results to a csv file */
+	void WriteCsv(const FString& Filename, const TArray<FResult>& Results) const;
+};
@@ -0,0 +1,183 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateBenchmarkWorkloads.h"
+#include "Dom/JsonValue.h"
+#include "HAL/PlatformTime.h"
+
+namespace SimpleTemplateBenchmarkWorkloads
+{
+	static const TCHAR* LoremIpsum = TEXT("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\n");
+
+	static TSharedPtr<FJsonValue> MakeRecord(int32 Index)
+	{
+		TSharedPtr<FJsonObject> Record = MakeShareable(new FJsonObject());
+		Record->SetStringField(TEXT("Name"), FString::Printf(TEXT("Player %d"), Index));
+		Record->SetStringField(TEXT("Team"), Index % 2 == 0 ? TEXT("Red") : TEXT("Blue"));
+		Record->SetNumberField(TEXT("Score"), (Index * 7919) % 1000);
+		Record->SetBoolField(TEXT("Online"), Index % 3 != 0);
+		return MakeShareable(new FJsonValueObject(Record));
+	}
+
+	FSimpleTemplateBenchmarkWorkload StaticText(int32 Scale)
+	{
+		FSimpleTemplateBenchmarkWorkload Workload;
+		Workload.Name = TEXT("StaticText");
+		Workload.Data = MakeShareable(new FJsonObject());
+		Workload.Data->SetStringField(TEXT("Title"), TEXT("Benchmark"));
+
+		// About a kilobyte of text per scale step
+		const int32 LineLen = FCString::Strlen(LoremIpsum);
+		const int32 NumLines = FMath::Max(1, Scale * 1024 / LineLen);
+		for (int32 i = 0; i < NumLines; i++)
+		{
+			Workload.Template += LoremIpsum;
+			if (i % 32 == 0)
+			{
+				Workload.Template += TEXT("{$Title}\n");
+			}
+		}
+		return Workload;
+	}
+
+	FSimpleTemplateBenchmarkWorkload DeepNesting(int32 Scale)
+	{
+		FSimpleTemplateBenchmarkWorkload Workload;
+		Workload.Name = TEXT("DeepNesting");
+		Workload.Data = MakeShareable(new FJsonObject());
+
+		// Every level loops over two items and checks a condition
+		const int32 Depth = FMath::Clamp(Scale, 1, 12);
+		TArray<TSharedPtr<FJsonValue>> Items;
+		Items.Add(MakeRecord(0));
+		Items.Add(MakeRecord(1));
+		Workload.Data->SetArrayField(TEXT("Items"), Items);
+
+		FString Open;
+		FString Close;
+		for (int32 i = 0; i < Depth; i++)
+		{
+			Open += FString::Printf(TEXT("{%% for Item%d in Items %%}{%% if Item%d.Online %%}<{$Item%d.Name}>"), i, i, i);
+			Close = TEXT("{% endif %}{% endfor %}") + Close;
+		}
+		Workload.Template = Open + TEXT("leaf") + Close;
+		return Workload;
+	}
+
+	FSimpleTemplateBenchmarkWorkload BigLoop(int32 Scale)
+	{
+		FSimpleTemplateBenchmarkWorkload Workload;
+		Workload.Name = TEXT("BigLoop");
+		Workload.Data = MakeShareable(new FJsonObject());
+
+		TArray<TSharedPtr<FJsonValue>> Players;
+		for (int32 i = 0; i < Scale * 100; i++)
+		{
+			Players.Add(MakeRecord(i));
+		}
+		Workload.Data->SetArrayField(TEXT("Players"), Players);
+		Workload.Template = TEXT("{% for Player in Players %}{$Player.Name} ({$Player.Team}){% if Player.Online %} online{% endif %}\n{% endfor %}");
+		return Workload;
+	}
+
+	FSimpleTemplateBenchmarkWorkload ManyIfs(int32 Scale)
+	{
+		FSimpleTemplateBenchmarkWorkload Workload;
+		Workload.Name = TEXT("ManyIfs");
+		Workload.Data = MakeShareable(new FJsonObject());
+		Workload.Data->SetStringField(TEXT("Mode"), TEXT("Hard"));
+		Workload.Data->SetNumberField(TEXT("Level"), 42);
+		Workload.Data->SetBoolField(TEXT("Tutorial"), false);
+
+		for (int32 i = 0; i < Scale * 50; i++)
+		{
+			switch (i % 3)
+			{
+			case 0:
+				Workload.Template += FString::Printf(TEXT("{%% if Mode == \"Hard\" and Level > %d %%}hard %d\n{%% endif %%}"), i, i);
+				break;
+			case 1:
+				Workload.Template += FString::Printf(TEXT("{%% if not Tutorial or Level < %d %%}level %d\n{%% endif %%}"), i, i);
+				break;
+			default:
+				Workload.Template += FString::Printf(TEXT("{%% if Mode ~= \"easy\" %%}easy %d\n{%% endif %%}"), i);
+				break;
+			}
+		}
+		return Workload;
+	}
+
+	FSimpleTemplateBenchmarkWorkload DeepPaths(int32 Scale)
+	{
+		FSimpleTemplateBenchmarkWorkload Workload;
+		Workload.Name = TEXT("DeepPaths");
+		Workload.Data = MakeShareable(new FJsonObject());
+
+		// A chain of objects Level0.Level1...LevelN with a value at every level
+		const int32 Depth = FMath::Clamp(Scale * 2, 2, 32);
+		TSharedPtr<FJsonObject> Current = Workload.Data;
+		FString Path;
+		TArray<FString> Paths;
+		for (int32 i = 0; i < Depth; i++)
+		{
+			TSharedPtr<FJsonObject> Child = MakeShareable(new FJsonObject());
+			Child->SetStringField(TEXT("Value"), FString::Printf(TEXT("value %d"), i));
+			Current->SetObjectField(FString::Printf(TEXT("Level%d"), i), Child);
+			Current = Child;
+
+			Path += FString::Printf(i == 0 ? TEXT("Level%d") : TEXT(".Level%d"), i);
+			Paths.Add(Path + TEXT(".Value"));
+		}
+
+		for (int32 i = 0; i < Scale * 20; i++)
+		{
+			Workload.Template += FString::Printf(TEXT("{$%s}\n"), *Paths[i % Paths.Num()]);
+		}
+		return Workload;
+	}
+
+	TArray<FSimpleTemplateBenchmarkWorkload> All(int32 Scale)
+	{
+		TArray<FSimpleTemplateBenchmarkWorkload> Workloads;
+		Workloads.Add(StaticText(Scale));
+		Workloads.Add(DeepNesting(Scale));
+		Workloads.Add(BigLoop(Scale));
+		Workloads.Add(ManyIfs(Scale));
+		Workloads.Add(DeepPaths(Scale));
+		return Workloads;
+	}
+
+	FString EditInMiddle(const FString& Template)
+	{
+		// Every workload has text after a line break, templates without one are edited in front
+		int32 Offset = Template.Find(TEXT("\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Template.Len() / 2);
+		Offset = Offset != INDEX_NONE ? Offset + 1 : 0;
+		return Template.Left(Offset) + TEXT("x") + Template.Mid(Offset);
+	}
+
+	int32 CountTokens(const FTokenArray& Tokens)
+	{
+		int32 NumTokens = 0;
+		for (const FToken* Token : Tokens.Items)
+		{
+			NumTokens++;
+			if (Token->GetType() == ETokenType::For || Token->GetType() == ETokenType::If)
+			{
+				NumTokens += CountTokens(static_cast<const FTokenNested*>(Token)->Children);
+			}
+		}
+		return NumTokens;
+	}
+
+	double Measure(int32 Iterations, double& OutAllocs, TFunctionRef<void()> Function)
+	{
+		const uint64 StartCalls = FTemplateRenderStats::GetMallocCalls();
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			Function();
+		}
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		OutAllocs = (double)(FTemplateRenderStats::GetMallocCalls() - StartCalls) / Iterations;
+		return Seconds / Iterations;
+	}
+}
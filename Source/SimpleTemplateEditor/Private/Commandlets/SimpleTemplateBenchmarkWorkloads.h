@@ -0,0 +1,58 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+
+/** A generated template together with the data it renders */
+struct FSimpleTemplateBenchmarkWorkload
+{
+	/** Name used in reports */
+	FString Name;
+
+	/** Template source */
+	FString Template;
+
+	/** Data to render */
+	TSharedPtr<FJsonObject> Data;
+};
+
+/**
+ * Generators of synthetic workloads for the template benchmark. Scale grows each workload
+ * roughly linearly: kilobytes of text, nesting depth, list items, conditions or path depth.
+ */
+namespace SimpleTemplateBenchmarkWorkloads
+{
+	/** Large static text with a few vars spread over it */
+	FSimpleTemplateBenchmarkWorkload StaticText(int32 Scale);
+
+	/** Nested loops and conditions */
+	FSimpleTemplateBenchmarkWorkload DeepNesting(int32 Scale);
+
+	/** A single loop over a big list of records */
+	FSimpleTemplateBenchmarkWorkload BigLoop(int32 Scale);
+
+	/** Many independent conditions */
+	FSimpleTemplateBenchmarkWorkload ManyIfs(int32 Scale);
+
+	/** Vars with long dotted paths */
+	FSimpleTemplateBenchmarkWorkload DeepPaths(int32 Scale);
+
+	/** All workloads */
+	TArray<FSimpleTemplateBenchmarkWorkload> All(int32 Scale);
+
+	/** The template with a char typed into the text around its middle, to measure incremental compiles */
+	FString EditInMiddle(const FString& Template);
+
+	/** Number of tokens of a tree, nested ones included */
+	int32 CountTokens(const FTokenArray& Tokens);
+
+	/**
+	 * Run the function the given times, returns seconds per run. Allocations are the malloc calls
+	 * per run counted by the engine allocator, other threads included. They are 0 with allocators
+	 * that do not count their calls.
+	 */
+	double Measure(int32 Iterations, double& OutAllocs, TFunctionRef<void()> Function);
+}
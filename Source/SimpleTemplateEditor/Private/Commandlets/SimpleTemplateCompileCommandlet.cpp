@@ -0,0 +1,156 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateCompileCommandlet.h"
+
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "Misc/SecureHash.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/ObjectWriter.h"
+#include "SimpleTemplate.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSimpleTemplateCompile, Log, All);
+
+namespace SimpleTemplateCompileCommandlet
+{
+	// Number of the slowest templates listed at the end
+	static const int32 NumSlowest = 10;
+
+	// Hash of the serialized template, compiling marks every template dirty so this tells which ones changed
+	static FSHAHash HashTemplate(USimpleTemplate* Template)
+	{
+		TArray<uint8> Bytes;
+		FObjectWriter Writer(Template, Bytes);
+		FSHAHash Hash;
+		FSHA1::HashBuffer(Bytes.GetData(), Bytes.Num(), Hash.Hash);
+		return Hash;
+	}
+}
+
+
+/* USimpleTemplateCompileCommandlet structors
+ *****************************************************************************/
+
+USimpleTemplateCompileCommandlet::USimpleTemplateCompileCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/* UCommandlet interface
+ *****************************************************************************/
+
+int32 USimpleTemplateCompileCommandlet::Main(const FString& Params)
+{
+	using namespace SimpleTemplateCompileCommandlet;
+
+	FString PathsParam = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Path="), PathsParam, false);
+	const bool bOnlyDirty = FParse::Param(*Params, TEXT("OnlyDirty"));
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+
+	TArray<FString> Paths;
+	PathsParam.ParseIntoArray(Paths, TEXT(","));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassNames.Add(USimpleTemplate::StaticClass()->GetFName());
+	Filter.bRecursivePaths = true;
+	for (const FString& Path : Paths)
+	{
+		Filter.PackagePaths.Add(*Path.TrimStartAndEnd());
+	}
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	// Loading is done up front, compiling the batch does not touch the disk
+	TArray<USimpleTemplate*> Templates;
+	for (const FAssetData& Asset : Assets)
+	{
+		USimpleTemplate* Template = Cast<USimpleTemplate>(Asset.GetAsset());
+		if (Template == nullptr || Template->Template.IsEmpty())
+		{
+			continue;
+		}
+		Template->EnsureLoaded();
+		if (bOnlyDirty && Template->IsUpToDate())
+		{
+			continue;
+		}
+		Templates.Add(Template);
+	}
+
+	TArray<FSHAHash> Hashes;
+	if (bSave)
+	{
+		for (USimpleTemplate* Template : Templates)
+		{
+			Hashes.Add(HashTemplate(Template));
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<double> Seconds;
+	const int32 NumErrors = USimpleTemplate::CompileAll(Templates, &Seconds);
+	const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+
+	TArray<int32> Order;
+	TArray<FString> SaveErrors;
+	int32 NumSaved = 0;
+	for (int32 i = 0; i < Templates.Num(); i++)
+	{
+		USimpleTemplate* Template = Templates[i];
+		if (Template->IsError())
+		{
+			UE_LOG(LogSimpleTemplateCompile, Error, TEXT("%s(%d:%d): %s"), *Template->GetPathName(), Template->LineNumber, Template->CharacterNumber,
+				Template->LastErrors.Num() > 0 ? *Template->LastErrors[0] : TEXT("Unknown error"));
+		}
+		else
+		{
+			UE_LOG(LogSimpleTemplateCompile, Display, TEXT("%s: %.2f ms"), *Template->GetPathName(), Seconds[i] * 1000.0);
+		}
+		Order.Add(i);
+
+		// Failed templates keep their last good data on disk, unchanged ones are not written again
+		if (bSave && !Template->IsError() && HashTemplate(Template) != Hashes[i])
+		{
+			UPackage* Package = Template->GetOutermost();
+			const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+			if (UPackage::SavePackage(Package, nullptr, RF_Standalone, *Filename))
+			{
+				NumSaved++;
+			}
+			else
+			{
+				UE_LOG(LogSimpleTemplateCompile, Error, TEXT("Could not save %s"), *Filename);
+				SaveErrors.Add(Filename);
+			}
+		}
+	}
+
+	Order.Sort([&Seconds](int32 A, int32 B)
+	{
+		return Seconds[A] > Seconds[B];
+	});
+	for (int32 i = 0; i < Order.Num() && i < NumSlowest; i++)
+	{
+		UE_LOG(LogSimpleTemplateCompile, Display, TEXT("Slowest %d: %s %.2f ms"), i + 1, *Templates[Order[i]]->GetPathName(), Seconds[Order[i]] * 1000.0);
+	}
+
+	UE_LOG(LogSimpleTemplateCompile, Display, TEXT("Compiled %d templates in %.2f s, %d failed"), Templates.Num(), TotalSeconds, NumErrors);
+	if (bSave)
+	{
+		UE_LOG(LogSimpleTemplateCompile, Display, TEXT("Saved %d changed templates, %d could not be saved"), NumSaved, SaveErrors.Num());
+		for (const FString& Filename : SaveErrors)
+		{
+			UE_LOG(LogSimpleTemplateCompile, Error, TEXT("Not saved: %s"), *Filename);
+		}
+	}
+	return NumErrors > 0 || SaveErrors.Num() > 0 ? 1 : 0;
+}
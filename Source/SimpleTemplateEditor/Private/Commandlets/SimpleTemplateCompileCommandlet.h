@@ -0,0 +1,34 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UObject/ObjectMacros.h"
+
+#include "SimpleTemplateCompileCommandlet.generated.h"
+
+/**
+ * Compiles template assets in parallel and saves them.
+ *
+ * Usage:
+ *   UE4Editor-Cmd.exe <Project> -run=SimpleTemplateCompile [-Path=/Game/Templates,/Game/Reports] [-OnlyDirty] [-NoSave]
+ *
+ * -OnlyDirty skips templates that are up to date, -NoSave only reports errors. Only templates that
+ * compiled and changed are saved. Logs the compile time of every template and fails when any of
+ * them does not compile or could not be saved.
+ */
+UCLASS()
+class USimpleTemplateCompileCommandlet
+	: public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Default constructor. */
+	USimpleTemplateCompileCommandlet();
+
+	//~ UCommandlet interface
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,308 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateCppWriter.h"
+#include "Misc/PackageName.h"
+
+namespace SimpleTemplateCppWriter
+{
+	// Text is split in arrays of this many chars, compilers limit the length of literals
+	static const int32 MaxTextChunk = 4096;
+
+	// Literals are split in lines of this many chars
+	static const int32 MaxLiteralLine = 120;
+
+	// First line of a generated file, followed by the path of the template
+	static const TCHAR* HeaderPrefix = TEXT("// Generated by the SimpleTemplateTranspile commandlet from ");
+	static const TCHAR* HeaderSuffix = TEXT(", do not edit");
+
+	static const TCHAR* EscapeToString(ETemplateEscape Escape)
+	{
+		switch (Escape)
+		{
+		case ETemplateEscape::Html:
+			return TEXT("ETemplateEscape::Html");
+		case ETemplateEscape::Json:
+			return TEXT("ETemplateEscape::Json");
+		case ETemplateEscape::Csv:
+			return TEXT("ETemplateEscape::Csv");
+		case ETemplateEscape::Xml:
+			return TEXT("ETemplateEscape::Xml");
+		default:
+			return TEXT("ETemplateEscape::None");
+		}
+	}
+}
+
+
+/* FSimpleTemplateCppWriter interface
+ *****************************************************************************/
+
+FString FSimpleTemplateCppWriter::Write(const FString& TemplatePath, uint32 ProgramCrc, const FTokenArray& Tokens)
+{
+	using namespace SimpleTemplateCppWriter;
+
+	const FString Identifier = GetIdentifier(TemplatePath);
+
+	FSimpleTemplateCppWriter Writer;
+	Writer.WriteTokens(Tokens);
+
+	FString Result;
+	Result += FString::Printf(TEXT("%s%s%s\n\n"), HeaderPrefix, *TemplatePath, HeaderSuffix);
+	Result += TEXT("#include \"Compiler/SimpleTemplateNative.h\"\n\n");
+	Result += FString::Printf(TEXT("namespace %s\n{\n"), *Identifier);
+	Result += TEXT("\tstatic void Render(FTemplateCompilerContent& Context, FArchive& WriteStream)\n\t{\n");
+	Result += Writer.Code;
+	Result += TEXT("\t}\n\n");
+	Result += FString::Printf(TEXT("\tstatic FTemplateNativeRegistration Registration(%s, 0x%08xu, &Render);\n"), *Literal(TemplatePath), ProgramCrc);
+	Result += TEXT("}\n");
+	return Result;
+}
+
+FString FSimpleTemplateCppWriter::GetIdentifier(const FString& TemplatePath)
+{
+	FString Identifier = TEXT("SimpleTemplateNative");
+	FString Name = FPackageName::ObjectPathToPackageName(TemplatePath);
+	for (TCHAR Char : Name.GetCharArray())
+	{
+		if (Char != 0)
+		{
+			Identifier.AppendChar(FChar::IsAlnum(Char) ? Char : TCHAR('_'));
+		}
+	}
+
+	// '/Game/A_B' and '/Game/A/B' read the same above
+	return Identifier + FString::Printf(TEXT("_%08x"), FCrc::StrCrc32(*TemplatePath));
+}
+
+bool FSimpleTemplateCppWriter::ParseTemplatePath(const FString& Code, FString& OutTemplatePath)
+{
+	using namespace SimpleTemplateCppWriter;
+
+	int32 LineEnd = INDEX_NONE;
+	if (!Code.StartsWith(HeaderPrefix, ESearchCase::CaseSensitive) || !Code.FindChar(TCHAR('\n'), LineEnd))
+	{
+		return false;
+	}
+	const FString Header = Code.Left(LineEnd);
+	if (!Header.EndsWith(HeaderSuffix, ESearchCase::CaseSensitive))
+	{
+		return false;
+	}
+	const int32 PrefixLen = FCString::Strlen(HeaderPrefix);
+	OutTemplatePath = Header.Mid(PrefixLen, Header.Len() - PrefixLen - FCString::Strlen(HeaderSuffix));
+	return !OutTemplatePath.IsEmpty();
+}
+
+
+/* FSimpleTemplateCppWriter implementation
+ *****************************************************************************/
+
+void FSimpleTemplateCppWriter::WriteTokens(const FTokenArray& Tokens)
+{
+	for (const FTokenPtr& Token : Tokens.Items)
+	{
+		switch (Token->GetType())
+		{
+		case ETokenType::Text:
+			WriteText(*static_cast<const FTokenText*>(Token));
+			break;
+		case ETokenType::Var:
+			WriteVar(*static_cast<const FTokenVar*>(Token));
+			break;
+		case ETokenType::For:
+			WriteFor(*static_cast<const FTokenFor*>(Token));
+			break;
+		case ETokenType::If:
+			WriteIf(*static_cast<const FTokenIf*>(Token));
+			break;
+		default:
+			// End tokens are not part of the tree
+			break;
+		}
+	}
+}
+
+void FSimpleTemplateCppWriter::WriteText(const FTokenText& Token)
+{
+	using namespace SimpleTemplateCppWriter;
+
+	for (int32 Start = 0; Start < Token.Text.Len(); Start += MaxTextChunk)
+	{
+		const FString Chunk = Token.Text.Mid(Start, MaxTextChunk);
+		const int32 Id = NextId++;
+		Line(FString::Printf(TEXT("static const TCHAR Text%d[] = %s;"), Id, *Literal(Chunk)));
+		Line(FString::Printf(TEXT("WriteStream.Serialize((void*)Text%d, %d * sizeof(TCHAR));"), Id, Chunk.Len()));
+	}
+}
+
+void FSimpleTemplateCppWriter::WriteVar(const FTokenVar& Token)
+{
+	using namespace SimpleTemplateCppWriter;
+
+	const int32 Id = NextId++;
+	Line(TEXT("{"));
+	Indent++;
+	Line(FString::Printf(TEXT("static const FTemplateKey Key%d(FString(%s));"), Id, *Literal(Token.Key)));
+	if (Token.Filters.Num() > 0)
+	{
+		FString Filters;
+		for (const FTemplateFilterCall& Filter : Token.Filters)
+		{
+			Filters += FString::Printf(TEXT("%s%s, %s"), Filters.IsEmpty() ? TEXT("") : TEXT(", "), *Literal(Filter.Name), *Literal(Filter.Argument));
+		}
+		Line(FString::Printf(TEXT("static const TArray<FTemplateFilterCall> Filters%d = FTemplateNativeRegistry::MakeFilters({ %s });"), Id, *Filters));
+	}
+	if (Token.Filters.Num() > 0)
+	{
+		Line(FString::Printf(TEXT("TTemplateCompilerHelper::WriteValue(Context, Key%d, WriteStream, Filters%d.GetData(), Filters%d.Num(), %s);"), Id, Id, Id, EscapeToString(Token.Escape)));
+	}
+	else
+	{
+		Line(FString::Printf(TEXT("TTemplateCompilerHelper::WriteValue(Context, Key%d, WriteStream, nullptr, 0, %s);"), Id, EscapeToString(Token.Escape)));
+	}
+	Indent--;
+	Line(TEXT("}"));
+}
+
+void FSimpleTemplateCppWriter::WriteFor(const FTokenFor& Token)
+{
+	const int32 Id = NextId++;
+	Line(TEXT("{"));
+	Indent++;
+	Line(FString::Printf(TEXT("static const FTemplateKey List%d(FString(%s));"), Id, *Literal(Token.List)));
+	Line(FString::Printf(TEXT("static const FString Item%d(%s);"), Id, *Literal(Token.Value)));
+	Line(FString::Printf(TEXT("FTemplateLoopState LoopState%d;"), Id));
+	Line(TEXT("TTemplateCompilerHelper::PushScope(Context);"));
+	Line(FString::Printf(TEXT("TTemplateCompilerHelper::IterateList(Context, List%d, [&](int32 Index%d, const TSharedPtr<FJsonValue>& JsonItem%d, ISimpleTemplateDataSource* SourceItem%d)"), Id, Id, Id, Id));
+	Line(TEXT("{"));
+	Indent++;
+	Line(FString::Printf(TEXT("TTemplateCompilerHelper::SetLoopItem(Context, LoopState%d, Item%d, Index%d, JsonItem%d, SourceItem%d);"), Id, Id, Id, Id, Id));
+	WriteTokens(Token.Children);
+	Indent--;
+	Line(TEXT("});"));
+	Line(TEXT("TTemplateCompilerHelper::PopScope(Context);"));
+	Indent--;
+	Line(TEXT("}"));
+}
+
+void FSimpleTemplateCppWriter::WriteIf(const FTokenIf& Token)
+{
+	const FTemplateExpression& Condition = Token.Condition;
+	const int32 Id = NextId++;
+	Line(TEXT("{"));
+	Indent++;
+
+	// The compiled condition is kept, it is evaluated from static tables
+	FString Ops;
+	for (const FExpressionOp& Op : Condition.GetOps())
+	{
+		Ops += FString::Printf(TEXT("%sFExpressionOp((EExpressionOp)%d, %d)"), Ops.IsEmpty() ? TEXT("") : TEXT(", "), (int32)Op.Type, Op.Operand);
+	}
+	FString OpsArg = TEXT("nullptr");
+	if (!Ops.IsEmpty())
+	{
+		Line(FString::Printf(TEXT("static const FExpressionOp Ops%d[] = { %s };"), Id, *Ops));
+		OpsArg = FString::Printf(TEXT("Ops%d"), Id);
+	}
+
+	// Keys are split once when the function first runs
+	FString KeysArg = TEXT("nullptr");
+	if (Condition.GetStrings().Num() > 0)
+	{
+		FString Keys;
+		for (const FString& String : Condition.GetStrings())
+		{
+			Keys += FString::Printf(TEXT("%sFTemplateKey(FString(%s))"), Keys.IsEmpty() ? TEXT("") : TEXT(", "), *Literal(String));
+		}
+		Line(FString::Printf(TEXT("static const FTemplateKey Keys%d[] = { %s };"), Id, *Keys));
+		KeysArg = FString::Printf(TEXT("Keys%d"), Id);
+	}
+
+	FString NumbersArg = TEXT("nullptr");
+	if (Condition.GetNumbers().Num() > 0)
+	{
+		FString Numbers;
+		for (double Number : Condition.GetNumbers())
+		{
+			Numbers += FString::Printf(TEXT("%s%.17g"), Numbers.IsEmpty() ? TEXT("") : TEXT(", "), Number);
+		}
+		Line(FString::Printf(TEXT("static const double Numbers%d[] = { %s };"), Id, *Numbers));
+		NumbersArg = FString::Printf(TEXT("Numbers%d"), Id);
+	}
+
+	Line(TEXT("TTemplateCompilerHelper::PushScope(Context);"));
+	Line(FString::Printf(TEXT("if (FTemplateExpression::Evaluate(Context, %s, %d, %s, %s, %d))"), *OpsArg, Condition.GetOps().Num(), *KeysArg, *NumbersArg, Condition.GetMaxStackDepth()));
+	Line(TEXT("{"));
+	Indent++;
+	WriteTokens(Token.Children);
+	Indent--;
+	Line(TEXT("}"));
+	Line(TEXT("TTemplateCompilerHelper::PopScope(Context);"));
+	Indent--;
+	Line(TEXT("}"));
+}
+
+void FSimpleTemplateCppWriter::Line(const FString& Text)
+{
+	for (int32 i = 0; i < Indent; i++)
+	{
+		Code.AppendChar(TCHAR('\t'));
+	}
+	Code += Text;
+	Code.AppendChar(TCHAR('\n'));
+}
+
+FString FSimpleTemplateCppWriter::Literal(const FString& String)
+{
+	using namespace SimpleTemplateCppWriter;
+
+	// Hex escapes end the literal, the next char could be read as part of them otherwise
+	FString Result = TEXT("TEXT(\"");
+	int32 LineLen = 0;
+	for (TCHAR Char : String.GetCharArray())
+	{
+		if (Char == 0)
+		{
+			break;
+		}
+		if (LineLen >= MaxLiteralLine)
+		{
+			Result += TEXT("\")\n\t\tTEXT(\"");
+			LineLen = 0;
+		}
+		switch (Char)
+		{
+		case TCHAR('\\'):
+			Result += TEXT("\\\\");
+			break;
+		case TCHAR('"'):
+			Result += TEXT("\\\"");
+			break;
+		case TCHAR('?'):
+			Result += TEXT("\\?");
+			break;
+		case TCHAR('\n'):
+			Result += TEXT("\\n");
+			break;
+		case TCHAR('\r'):
+			Result += TEXT("\\r");
+			break;
+		case TCHAR('\t'):
+			Result += TEXT("\\t");
+			break;
+		default:
+			if (Char >= 0x20 && Char < 0x7F)
+			{
+				Result.AppendChar(Char);
+			}
+			else
+			{
+				Result += FString::Printf(TEXT("\\x%04x\") TEXT(\""), (uint32)Char);
+			}
+			break;
+		}
+		LineLen++;
+	}
+	Result += TEXT("\")");
+	return Result;
+}
@@ -0,0 +1,47 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+
+/**
+ * Writes the C++ render function of a compiled template. Text becomes static arrays written
+ * with a single call, keys are built once, loops and branches become native code. The function
+ * registers itself with FTemplateNativeRegistry for the path and program crc of the template.
+ */
+class FSimpleTemplateCppWriter
+{
+public:
+	/** Generate the source file of a template */
+	static FString Write(const FString& TemplatePath, uint32 ProgramCrc, const FTokenArray& Tokens);
+
+	/** Identifier generated for a template, also used for its file name. It ends with a hash of the path, paths only differing in symbols get their own */
+	static FString GetIdentifier(const FString& TemplatePath);
+
+	/** Path of the template a generated source file was written for, false if the file was not generated */
+	static bool ParseTemplatePath(const FString& Code, FString& OutTemplatePath);
+
+private:
+	FSimpleTemplateCppWriter()
+		: Indent(2)
+		, NextId(0)
+	{}
+
+	void WriteTokens(const FTokenArray& Tokens);
+	void WriteText(const FTokenText& Token);
+	void WriteVar(const FTokenVar& Token);
+	void WriteFor(const FTokenFor& Token);
+	void WriteIf(const FTokenIf& Token);
+
+	/** Add a line at the current indentation */
+	void Line(const FString& Text);
+
+	/** A string as a C++ literal */
+	static FString Literal(const FString& String);
+
+private:
+	FString Code;
+	int32 Indent;
+	int32 NextId;
+};
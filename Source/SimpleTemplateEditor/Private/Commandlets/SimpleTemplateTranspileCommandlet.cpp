@@ -0,0 +1,142 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateTranspileCommandlet.h"
+
+#include "AssetRegistryModule.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "SimpleTemplate.h"
+#include "SimpleTemplateCppWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSimpleTemplateTranspile, Log, All);
+
+
+/* USimpleTemplateTranspileCommandlet structors
+ *****************************************************************************/
+
+USimpleTemplateTranspileCommandlet::USimpleTemplateTranspileCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/* UCommandlet interface
+ *****************************************************************************/
+
+int32 USimpleTemplateTranspileCommandlet::Main(const FString& Params)
+{
+	FString Output;
+	FString PathsParam = TEXT("/Game");
+	if (!FParse::Value(*Params, TEXT("Output="), Output))
+	{
+		UE_LOG(LogSimpleTemplateTranspile, Error, TEXT("Missing -Output=<Folder of a game module>"));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("Path="), PathsParam, false);
+
+	TArray<FString> Paths;
+	PathsParam.ParseIntoArray(Paths, TEXT(","));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassNames.Add(USimpleTemplate::StaticClass()->GetFName());
+	Filter.bRecursivePaths = true;
+	for (const FString& Path : Paths)
+	{
+		Filter.PackagePaths.Add(*Path.TrimStartAndEnd());
+	}
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	IFileManager::Get().MakeDirectory(*Output, true);
+
+	bool bSuccess = true;
+	TSet<FString> Written;
+	TSet<FString> Transpiled;
+	for (const FAssetData& Asset : Assets)
+	{
+		USimpleTemplate* Template = Cast<USimpleTemplate>(Asset.GetAsset());
+		if (Template == nullptr)
+		{
+			continue;
+		}
+		const FString TemplatePath = Template->GetPathName();
+		Transpiled.Add(TemplatePath);
+
+		// The native code has to match the saved compiled data
+		Template->EnsureLoaded();
+		if (!Template->IsUpToDate())
+		{
+			UE_LOG(LogSimpleTemplateTranspile, Error, TEXT("%s: template is not compiled, compile and save it first"), *TemplatePath);
+			bSuccess = false;
+			continue;
+		}
+
+		FTokenArray Tokens = Template->Tokens;
+		if (Tokens.Items.Num() == 0 && Template->Program.IsValid())
+		{
+			Template->Program.ToTokens(Tokens);
+		}
+
+		// The crc of the program the template renders with, matched when the template is loaded
+		FTemplateProgram Program;
+		Program.Build(Tokens);
+
+		const FString Filename = Output / FSimpleTemplateCppWriter::GetIdentifier(TemplatePath) + TEXT(".cpp");
+		const FString Code = FSimpleTemplateCppWriter::Write(TemplatePath, Program.GetCrc(), Tokens);
+		Written.Add(FPaths::ConvertRelativePathToFull(Filename));
+
+		// Unchanged files are left alone so they are not built again
+		FString ExistingCode;
+		if (FFileHelper::LoadFileToString(ExistingCode, *Filename) && ExistingCode == Code)
+		{
+			continue;
+		}
+		if (!FFileHelper::SaveStringToFile(Code, *Filename))
+		{
+			UE_LOG(LogSimpleTemplateTranspile, Error, TEXT("Could not write %s"), *Filename);
+			bSuccess = false;
+			continue;
+		}
+		UE_LOG(LogSimpleTemplateTranspile, Display, TEXT("%s -> %s"), *TemplatePath, *Filename);
+	}
+
+	// Remove the code of templates that were deleted, or moved away from the paths of this run. Code of templates
+	// outside of them belongs to other runs into the same folder, files we did not generate are left alone too.
+	TArray<FString> ExistingFiles;
+	IFileManager::Get().FindFiles(ExistingFiles, *(Output / TEXT("SimpleTemplateNative*.cpp")), true, false);
+	for (const FString& File : ExistingFiles)
+	{
+		const FString Filename = FPaths::ConvertRelativePathToFull(Output / File);
+		FString ExistingCode;
+		FString TemplatePath;
+		if (Written.Contains(Filename) || !FFileHelper::LoadFileToString(ExistingCode, *Filename)
+			|| !FSimpleTemplateCppWriter::ParseTemplatePath(ExistingCode, TemplatePath) || Transpiled.Contains(TemplatePath))
+		{
+			continue;
+		}
+
+		const FString PackageName = FPackageName::ObjectPathToPackageName(TemplatePath);
+		const bool bInPaths = Paths.ContainsByPredicate([&PackageName](const FString& Path)
+		{
+			const FString Folder = Path.TrimStartAndEnd();
+			return PackageName.StartsWith(Folder.EndsWith(TEXT("/")) ? Folder : Folder + TEXT("/"));
+		});
+		if (bInPaths || !AssetRegistry.GetAssetByObjectPath(*TemplatePath).IsValid())
+		{
+			UE_LOG(LogSimpleTemplateTranspile, Display, TEXT("Deleting %s, generated for %s"), *Filename, *TemplatePath);
+			IFileManager::Get().Delete(*Filename);
+		}
+	}
+
+	UE_LOG(LogSimpleTemplateTranspile, Display, TEXT("Transpiled %d templates to %s"), Written.Num(), *FPaths::ConvertRelativePathToFull(Output));
+	return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UObject/ObjectMacros.h"
+
+#include "SimpleTemplateTranspileCommandlet.generated.h"
+
+/**
+ * Transpiles template assets to C++ render functions.
+ *
+ * Usage:
+ *   UE4Editor-Cmd.exe <Project> -run=SimpleTemplateTranspile -Output=<Game>/Source/<Module>/SimpleTemplateNative [-Path=/Game/Templates,/Game/Reports]
+ *
+ * Writes a source file per template into the output folder of a game module depending on
+ * SimpleTemplate. Once compiled in, USimpleTemplate::Interpret renders those templates with
+ * their native function. Outdated functions are ignored, run the commandlet again after
+ * changing the templates. Files of templates that no longer exist are deleted.
+ */
+UCLASS()
+class USimpleTemplateTranspileCommandlet
+	: public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Default constructor. */
+	USimpleTemplateTranspileCommandlet();
+
+	//~ UCommandlet interface
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -10,4 +10,5 @@ USimpleTemplateEditorSettings::USimpleTemplateEditorSettings()
 	, ForegroundColor(FLinearColor::Black)
 	, Font(FSlateFontInfo(FPaths::EngineContentDir() / TEXT("Slate/Fonts/DroidSansMono.ttf"), 10))
 	, Margin(4.0f)
+	, CompileDelay(0.5f)
 { }
@@ -33,6 +33,10 @@ public:
 	UPROPERTY(config, EditAnywhere, Category=Appearance)
 	float Margin;
 
+	/** Seconds after the last edit before the template is compiled in the background, 0 to only compile on demand. */
+	UPROPERTY(config, EditAnywhere, Category=Compiling, meta=(ClampMin=0.0))
+	float CompileDelay;
+
 public:
 
 	/** Default constructor. */
@@ -0,0 +1,54 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+#include "Compiler/SimpleTemplateProgram.h"
+#include "SimpleTemplateBenchmarkWorkloads.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateBenchmarkTest, "SimpleTemplate.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FSimpleTemplateBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace SimpleTemplateBenchmarkWorkloads;
+
+	const int32 Iterations = 5;
+	for (const FSimpleTemplateBenchmarkWorkload& Workload : All(2))
+	{
+		auto Compiler = TTemplateCompilerFactory<TCHAR>::Create(Workload.Template);
+		if (!TestTrue(FString::Printf(TEXT("%s compiles"), *Workload.Name), Compiler->Compile()))
+		{
+			continue;
+		}
+		const FTokenArray& Tokens = Compiler->GetTokenTree();
+
+		// Tokens and flat programs render the same output
+		FString Output;
+		TTemplateInterpreter Interpreter(Tokens);
+		Interpreter.Interpret(Output, Workload.Data);
+		TestFalse(FString::Printf(TEXT("%s renders"), *Workload.Name), Output.IsEmpty());
+
+		FTemplateProgram Program;
+		Program.Build(Tokens);
+		FTemplateRenderContext RenderContext;
+		Program.Interpret(RenderContext.Begin(Workload.Data), RenderContext.GetWriteStream());
+		TestEqual(FString::Printf(TEXT("%s program output"), *Workload.Name), RenderContext.Finish(), Output);
+
+		double CompileAllocs = 0.0;
+		const double CompileSeconds = Measure(Iterations, CompileAllocs, [&Workload]()
+		{
+			TTemplateCompilerFactory<TCHAR>::Create(Workload.Template)->Compile();
+		});
+		double RenderAllocs = 0.0;
+		const double RenderSeconds = Measure(Iterations, RenderAllocs, [&Interpreter, &Workload, &Output]()
+		{
+			Interpreter.Interpret(Output, Workload.Data);
+		});
+		AddInfo(FString::Printf(TEXT("%s: %d tokens, compile %.2f us %.0f allocs, render %.2f us %.0f allocs"),
+			*Workload.Name, CountTokens(Tokens), CompileSeconds * 1e6, CompileAllocs, RenderSeconds * 1e6, RenderAllocs));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,33 @@
+// Copyright Playspace S.L. 2017
+
+#include "Misc/AutomationTest.h"
+#include "Compiler/SimpleTemplateCompiler.h"
+#include "SimpleTemplateCppWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleTemplateCppWriterFilesTest, "SimpleTemplate.Native.Files", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleTemplateCppWriterFilesTest::RunTest(const FString& Parameters)
+{
+	// Paths only differing in symbols get their own identifier and file
+	const FString Identifier = FSimpleTemplateCppWriter::GetIdentifier(TEXT("/Game/A_B.A_B"));
+	TestNotEqual(TEXT("Symbols"), FSimpleTemplateCppWriter::GetIdentifier(TEXT("/Game/A/B.B")), Identifier);
+	TestEqual(TEXT("Stable"), FSimpleTemplateCppWriter::GetIdentifier(TEXT("/Game/A_B.A_B")), Identifier);
+	TestTrue(TEXT("Readable"), Identifier.StartsWith(TEXT("SimpleTemplateNative_Game_A_B_")));
+
+	// Generated files record their template, the commandlet only deletes files it can tell the template of
+	auto Compiler = TTemplateCompilerFactory<TCHAR>::Create(TEXT("Hello {$Name}"));
+	if (TestTrue(TEXT("Compiles"), Compiler->Compile()))
+	{
+		FString TemplatePath;
+		const FString Code = FSimpleTemplateCppWriter::Write(TEXT("/Game/A_B.A_B"), 0, Compiler->GetTokenTree());
+		TestTrue(TEXT("Recorded"), FSimpleTemplateCppWriter::ParseTemplatePath(Code, TemplatePath));
+		TestEqual(TEXT("Template path"), TemplatePath, TEXT("/Game/A_B.A_B"));
+	}
+	FString TemplatePath;
+	TestFalse(TEXT("Other file"), FSimpleTemplateCppWriter::ParseTemplatePath(TEXT("// Copyright\n#include \"Foo.h\"\n"), TemplatePath));
+	return true;
+}
+
+#endif
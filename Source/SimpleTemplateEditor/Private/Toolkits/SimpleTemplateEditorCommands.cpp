@@ -9,6 +9,7 @@ void FSimpleTemplateEditorCommands::RegisterCommands()
 	UI_COMMAND(Compile, "Compile", "Compile a template", EUserInterfaceActionType::Button, FInputChord());
 	UI_COMMAND(Import, "Import", "Import a template from a .stf file", EUserInterfaceActionType::Button, FInputChord());
 	UI_COMMAND(Export, "Export", "Export a template to a .stf file.", EUserInterfaceActionType::Button, FInputChord());
+	UI_COMMAND(Profile, "Profile", "Render the template with data from a .json file and show the time of every token", EUserInterfaceActionType::Button, FInputChord());
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -27,4 +27,5 @@ public:
 	TSharedPtr<FUICommandInfo> Compile;
 	TSharedPtr<FUICommandInfo> Import;
 	TSharedPtr<FUICommandInfo> Export;
+	TSharedPtr<FUICommandInfo> Profile;
 };
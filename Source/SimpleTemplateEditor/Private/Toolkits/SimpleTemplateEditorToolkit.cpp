@@ -6,6 +6,7 @@
 #include "EditorReimportHandler.h"
 #include "EditorStyleSet.h"
 #include "SimpleTemplate.h"
+#include "SimpleTemplateData.h"
 #include "UObject/NameTypes.h"
 #include "Widgets/Docking/SDockTab.h"
 #include "Framework/MultiBox/MultiBoxExtender.h"
@@ -158,6 +159,13 @@ void FSimpleTemplateEditorToolkit::UnregisterTabSpawners(const TSharedRef<FTabMa
 }
 
 
+void FSimpleTemplateEditorToolkit::SaveAsset_Execute()
+{
+	FlushText();
+	FAssetEditorToolkit::SaveAsset_Execute();
+}
+
+
 /* IToolkit interface
  *****************************************************************************/
 
@@ -229,7 +237,8 @@ TSharedRef<SDockTab> FSimpleTemplateEditorToolkit::HandleTabManagerSpawnTab(cons
 {
 	if (TabIdentifier == SimpleTemplateEditor::TabId)
 	{
-		SAssignNew(TemplateEditor, SSimpleTemplateEditor, SimpleTemplate, Style);
+		SAssignNew(TemplateEditor, SSimpleTemplateEditor, SimpleTemplate, Style)
+			.OnCompiled(this, &FSimpleTemplateEditorToolkit::UpdateCompileOutput);
 
 		return SNew(SDockTab)
 			.TabRole(ETabRole::PanelTab)
@@ -288,6 +297,8 @@ void FSimpleTemplateEditorToolkit::BindCommands()
 		FExecuteAction::CreateSP(this, &FSimpleTemplateEditorToolkit::ActionExport));
 	UICommandList->MapAction(Commands.Import,
 		FExecuteAction::CreateSP(this, &FSimpleTemplateEditorToolkit::ActionImport));
+	UICommandList->MapAction(Commands.Profile,
+		FExecuteAction::CreateSP(this, &FSimpleTemplateEditorToolkit::ActionProfile));
 }
 
 void FSimpleTemplateEditorToolkit::ExtendMenu()
@@ -307,6 +318,11 @@ void FSimpleTemplateEditorToolkit::FillTemplateToolbar(FToolBarBuilder& ToolbarB
 			FName(TEXT("Compile")));
 		ToolbarBuilder.AddToolBarButton(Commands.Export);
 		ToolbarBuilder.AddToolBarButton(Commands.Import);
+		ToolbarBuilder.AddToolBarButton(Commands.Profile,
+			NAME_None,
+			TAttribute<FText>(),
+			TAttribute<FText>(),
+			FSlateIcon(FEditorStyle::GetStyleSetName(), "LevelEditor.Tabs.StatsViewer"));
 	}
 	ToolbarBuilder.EndSection();
 }
@@ -362,7 +378,23 @@ void FSimpleTemplateEditorToolkit::ActionCompile()
 		SaveAsset_Execute();
 	}
 
-	if (!SimpleTemplate->Compile())
+	FlushText();
+	const bool bSuccess = SimpleTemplate->Compile();
+	UpdateCompileOutput();
+	if (bSuccess)
+	{
+		SaveAsset_Execute();
+	}
+}
+
+void FSimpleTemplateEditorToolkit::UpdateCompileOutput()
+{
+	if (!TemplateOutput.IsValid())
+	{
+		return;
+	}
+
+	if (SimpleTemplate->IsError())
 	{
 		FString ErrorText;
 		ErrorText.Append(LOCTEXT("CompileFailed", "Failed to compile template!").ToString());
@@ -372,18 +404,19 @@ void FSimpleTemplateEditorToolkit::ActionCompile()
 			ErrorText.Append(CompileError);
 			ErrorText += TEXT("\n");
 		}
-		if (TemplateOutput.IsValid())
-		{
-			TemplateOutput->SetText(ErrorText);
-		}
+		TemplateOutput->SetText(ErrorText);
 	}
 	else
 	{
-		if (TemplateOutput.IsValid())
-		{
-			TemplateOutput->SetText(LOCTEXT("CompileSuccessful", "Template compiled successfully"));
-		}
-		SaveAsset_Execute();
+		TemplateOutput->SetText(LOCTEXT("CompileSuccessful", "Template compiled successfully"));
+	}
+}
+
+void FSimpleTemplateEditorToolkit::FlushText()
+{
+	if (TemplateEditor.IsValid())
+	{
+		TemplateEditor->FlushText();
 	}
 }
 
@@ -393,6 +426,7 @@ void FSimpleTemplateEditorToolkit::ActionExport()
 	{
 		SaveAsset_Execute();
 	}
+	FlushText();
 
 	TArray<FString> SaveFilenames;
 	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
@@ -423,6 +457,7 @@ void FSimpleTemplateEditorToolkit::ActionImport()
 	{
 		SaveAsset_Execute();
 	}
+	FlushText();
 
 	TArray<FString> OpenFilenames;
 	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
@@ -456,6 +491,65 @@ void FSimpleTemplateEditorToolkit::ActionImport()
 	}
 }
 
+void FSimpleTemplateEditorToolkit::ActionProfile()
+{
+	FlushText();
+	if (!SimpleTemplate->IsUpToDate())
+	{
+		ActionCompile();
+		if (!SimpleTemplate->IsUpToDate())
+		{
+			return;
+		}
+	}
+
+	TArray<FString> OpenFilenames;
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	bool bOpened = false;
+	if (DesktopPlatform != nullptr)
+	{
+		bOpened = DesktopPlatform->OpenFileDialog(
+			FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+			LOCTEXT("ProfileDialogTitle", "Open profiling data").ToString(),
+			FEditorDirectories::Get().GetLastDirectory(ELastDirectory::GENERIC_OPEN),
+			TEXT(""),
+			TEXT("JSON Data|*.json"),
+			EFileDialogFlags::None,
+			OpenFilenames
+		);
+	}
+
+	FString FileContent;
+	if (!bOpened || !FFileHelper::LoadFileToString(FileContent, *OpenFilenames[0]))
+	{
+		return;
+	}
+	FEditorDirectories::Get().SetLastDirectory(ELastDirectory::GENERIC_OPEN, FPaths::GetPath(OpenFilenames[0]));
+
+	TabManager->InvokeTab(SimpleTemplateEditor::OutputTabId);
+
+	USimpleTemplateData* Data = NewObject<USimpleTemplateData>();
+	if (!Data->SetData(FileContent))
+	{
+		if (TemplateOutput.IsValid())
+		{
+			TemplateOutput->SetText(LOCTEXT("ProfileInvalidData", "Profiling data is not valid JSON"));
+		}
+		return;
+	}
+
+	// Several renders smooth out timer resolution on small templates
+	const FSimpleTemplateProfile Profile = SimpleTemplate->Profile(Data, 10);
+	if (TemplateEditor.IsValid())
+	{
+		TemplateEditor->ShowProfile(Profile);
+	}
+	if (TemplateOutput.IsValid())
+	{
+		TemplateOutput->SetText(FText::FromString(Profile.ToString()));
+	}
+}
+
 FReply FSimpleTemplateEditorToolkit::GoToError()
 {
 	if (SimpleTemplate->Status == ETemplateStatus::TS_BeingCreated)
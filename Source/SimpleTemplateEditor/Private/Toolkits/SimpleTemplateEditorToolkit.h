@@ -53,6 +53,7 @@ public:
 	virtual FString GetDocumentationLink() const override;
 	virtual void RegisterTabSpawners(const TSharedRef<FTabManager>& InTabManager) override;
 	virtual void UnregisterTabSpawners(const TSharedRef<FTabManager>& InTabManager) override;
+	virtual void SaveAsset_Execute() override;
 
 public:
 
@@ -93,10 +94,17 @@ private:
 	void ActionCompile();
 	void ActionExport();
 	void ActionImport();
+	void ActionProfile();
 
 	// Used to navigate to the current error
 	FReply GoToError();
 
+	// Show the result of the last compile in the output tab
+	void UpdateCompileOutput();
+
+	// Copy the text being edited to the template
+	void FlushText();
+
 	// Compile action customization
 	FSlateIcon GetStatusImage() const;
 	FText GetStatusTooltip() const;
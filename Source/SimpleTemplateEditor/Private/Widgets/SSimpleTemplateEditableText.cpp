@@ -13,6 +13,8 @@ void SSimpleTemplateEditableText::Construct( const FArguments& InArgs )
 		.HScrollBar(InArgs._HScrollBar)
 		.VScrollBar(InArgs._VScrollBar)
 		.OnTextChanged(InArgs._OnTextChanged)
+		.OnTextCommitted(InArgs._OnTextCommitted)
+		.Marshaller(InArgs._Marshaller)
 	);
 }
 
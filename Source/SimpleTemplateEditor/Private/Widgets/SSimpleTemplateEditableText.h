@@ -25,6 +25,12 @@ class SSimpleTemplateEditableText : public SMultiLineEditableText
 		/** Called whenever the text is changed interactively by the user */
 		SLATE_EVENT(FOnTextChanged, OnTextChanged)
 
+		/** Called whenever the text is committed, e.g. when the widget loses focus */
+		SLATE_EVENT(FOnTextCommitted, OnTextCommitted)
+
+		/** The marshaller used to get/set the raw text to/from the text layout. */
+		SLATE_ARGUMENT(TSharedPtr< ITextLayoutMarshaller >, Marshaller)
+
 		SLATE_END_ARGS()
 
     void Construct( const FArguments& InArgs );
@@ -12,12 +12,16 @@
 #include "Widgets/Layout/SScrollBar.h"
 #include "Widgets/Input/SMultiLineEditableTextBox.h"
 #include "Input/Reply.h"
+#include "Styling/CoreStyle.h"
 
 #include "SimpleTemplateEditorSettings.h"
 
 
 #define LOCTEXT_NAMESPACE "SSimpleTemplateEditor"
 
+// Seconds after the last edit before the text is copied to the template when background compiling is off
+static const float TextFlushDelay = 0.5f;
+
 
 /* SSimpleTemplateEditor interface
  *****************************************************************************/
@@ -25,12 +29,17 @@
 SSimpleTemplateEditor::~SSimpleTemplateEditor()
 {
 	FCoreUObjectDelegates::OnObjectPropertyChanged.RemoveAll(this);
+
+	// Keep what was typed since the last pause
+	FlushText();
 }
 
 
 void SSimpleTemplateEditor::Construct(const FArguments& InArgs, USimpleTemplate* InSimpleTemplate, const TSharedRef<ISlateStyle>& InStyle)
 {
 	SimpleTemplate = InSimpleTemplate;
+	OnCompiled = InArgs._OnCompiled;
+	bTextPending = false;
 
 	HorizontalScrollbar =
 		SNew(SScrollBar)
@@ -44,6 +53,8 @@ void SSimpleTemplateEditor::Construct(const FArguments& InArgs, USimpleTemplate*
 
 	auto Settings = GetDefault<USimpleTemplateEditorSettings>();
 
+	HeatMarshaller = FSimpleTemplateHeatMarshaller::Create(FCoreStyle::Get().GetWidgetStyle<FTextBlockStyle>("NormalText"));
+
 	ChildSlot
 	[
 		SNew(SBorder)
@@ -59,6 +70,8 @@ void SSimpleTemplateEditor::Construct(const FArguments& InArgs, USimpleTemplate*
 				.HScrollBar(HorizontalScrollbar)
 				.VScrollBar(VerticalScrollbar)
 				.OnTextChanged(this, &SSimpleTemplateEditor::HandleEditableTextBoxTextChanged)
+				.OnTextCommitted(this, &SSimpleTemplateEditor::HandleEditableTextBoxTextCommitted)
+				.Marshaller(HeatMarshaller)
 			]
 			+SGridPanel::Slot(1, 0)
 			[
@@ -72,6 +85,7 @@ void SSimpleTemplateEditor::Construct(const FArguments& InArgs, USimpleTemplate*
 	];
 
 	FCoreUObjectDelegates::OnObjectPropertyChanged.AddSP(this, &SSimpleTemplateEditor::HandleSimpleTemplatePropertyChanged);
+	UpdateErrorMarker();
 }
 
 
@@ -84,11 +98,21 @@ void SSimpleTemplateEditor::GoTo(int32 LineNumber, int32 ColumnNumber)
 }
 
 
-/* SSimpleTemplateEditor callbacks
- *****************************************************************************/
+void SSimpleTemplateEditor::ShowProfile(const FSimpleTemplateProfile& Profile)
+{
+	HeatMarshaller->SetProfile(Profile);
+	EditableTextBox->Refresh();
+}
 
-void SSimpleTemplateEditor::HandleEditableTextBoxTextChanged(const FText& NewText)
+
+void SSimpleTemplateEditor::FlushText()
 {
+	if (!bTextPending)
+	{
+		return;
+	}
+	bTextPending = false;
+
 	FText newText = EditableTextBox->GetText();
 	if (!newText.EqualTo(SimpleTemplate->Template))
 	{
@@ -98,17 +122,34 @@ void SSimpleTemplateEditor::HandleEditableTextBoxTextChanged(const FText& NewTex
 	}
 }
 
-	
 
-void SSimpleTemplateEditor::HandleEditableTextBoxTextCommitted(const FText& Comment, ETextCommit::Type CommitType)
+/* SSimpleTemplateEditor callbacks
+ *****************************************************************************/
+
+void SSimpleTemplateEditor::HandleEditableTextBoxTextChanged(const FText& NewText)
 {
-	FText newText = EditableTextBox->GetText();
-	if (!newText.EqualTo(SimpleTemplate->Template))
+	// Token locations of the profile are stale now
+	HeatMarshaller->ClearProfile();
+
+	// The text is copied once typing paused, results of compiles started before are stale
+	if (!bTextPending)
 	{
-		SimpleTemplate->Template = newText;
-		SimpleTemplate->Status = ETemplateStatus::TS_Dirty;
-		SimpleTemplate->MarkPackageDirty();
+		bTextPending = true;
+		SimpleTemplate->CancelAsyncCompile();
 	}
+
+	if (EditTimer.IsValid())
+	{
+		UnRegisterActiveTimer(EditTimer.ToSharedRef());
+	}
+	const float CompileDelay = GetDefault<USimpleTemplateEditorSettings>()->CompileDelay;
+	EditTimer = RegisterActiveTimer(CompileDelay > 0.0f ? CompileDelay : TextFlushDelay, FWidgetActiveTimerDelegate::CreateSP(this, &SSimpleTemplateEditor::HandleEditTimer));
+}
+
+
+void SSimpleTemplateEditor::HandleEditableTextBoxTextCommitted(const FText& Comment, ETextCommit::Type CommitType)
+{
+	FlushText();
 }
 
 
@@ -116,7 +157,47 @@ void SSimpleTemplateEditor::HandleSimpleTemplatePropertyChanged(UObject* Object,
 {
 	if (Object == SimpleTemplate)
 	{
-		EditableTextBox->SetText(SimpleTemplate->Template);
+		// Compiling notifies too, setting the same text would move the cursor while typing
+		if (!bTextPending && !EditableTextBox->GetText().EqualTo(SimpleTemplate->Template))
+		{
+			EditableTextBox->SetText(SimpleTemplate->Template);
+		}
+		UpdateErrorMarker();
+	}
+}
+
+
+EActiveTimerReturnType SSimpleTemplateEditor::HandleEditTimer(double InCurrentTime, float InDeltaTime)
+{
+	EditTimer.Reset();
+	FlushText();
+
+	if (GetDefault<USimpleTemplateEditorSettings>()->CompileDelay > 0.0f && !SimpleTemplate->IsUpToDate())
+	{
+		TWeakPtr<SSimpleTemplateEditor> WeakEditor = SharedThis(this);
+		SimpleTemplate->CompileAsync([WeakEditor](bool bSuccess)
+		{
+			TSharedPtr<SSimpleTemplateEditor> Editor = WeakEditor.Pin();
+			if (Editor.IsValid())
+			{
+				Editor->OnCompiled.ExecuteIfBound();
+			}
+		});
+	}
+	return EActiveTimerReturnType::Stop;
+}
+
+
+void SSimpleTemplateEditor::UpdateErrorMarker()
+{
+	// The location belongs to the text that was compiled, it is wrong once the text changed
+	if (SimpleTemplate->IsError() && !bTextPending)
+	{
+		HeatMarshaller->SetError(SimpleTemplate->LineNumber, SimpleTemplate->CharacterNumber);
+	}
+	else
+	{
+		HeatMarshaller->ClearError();
 	}
 }
 
@@ -6,10 +6,12 @@
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "Widgets/SCompoundWidget.h"
 #include "SSimpleTemplateEditableText.h"
+#include "SimpleTemplateHeatMarshaller.h"
 
 class FText;
 class ISlateStyle;
 class USimpleTemplate;
+struct FSimpleTemplateProfile;
 
 
 /**
@@ -21,6 +23,10 @@ class SSimpleTemplateEditor
 public:
 
 	SLATE_BEGIN_ARGS(SSimpleTemplateEditor) { }
+
+		/** Called when a background compile of the edited text finished. */
+		SLATE_EVENT(FSimpleDelegate, OnCompiled)
+
 	SLATE_END_ARGS()
 
 public:
@@ -39,6 +45,12 @@ public:
 
 	void GoTo(int32 LineNumber, int32 CharacterNumber);
 
+	/** Color the tokens of the template by the time they took in a profile */
+	void ShowProfile(const FSimpleTemplateProfile& Profile);
+
+	/** Copy edits that were not copied to the template yet, e.g. before saving or compiling it */
+	void FlushText();
+
 private:
 
 	/** Callback for text changes in the editable text box. */
@@ -50,14 +62,32 @@ private:
 	/** Callback for property changes in the Simple Template. */
 	void HandleSimpleTemplatePropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
 
+	/** Callback for the pause after the last edit, copies the text and compiles it in the background. */
+	EActiveTimerReturnType HandleEditTimer(double InCurrentTime, float InDeltaTime);
+
+	/** Mark the location of the last compile error in the text. */
+	void UpdateErrorMarker();
+
 private:
 
 	/** Holds the editable text box widget. */
 	TSharedPtr<SSimpleTemplateEditableText> EditableTextBox;
 
+	/** Lays out the text with the heat of the last profile. */
+	TSharedPtr<FSimpleTemplateHeatMarshaller> HeatMarshaller;
+
 	/** Pointer to the Simple Template that is being edited. */
 	USimpleTemplate* SimpleTemplate;
 
+	/** Fires once typing paused, restarted by every edit. */
+	TSharedPtr<FActiveTimerHandle> EditTimer;
+
+	/** Whether the text box holds edits the template does not have yet. */
+	bool bTextPending;
+
+	/** Called when a background compile finished. */
+	FSimpleDelegate OnCompiled;
+
 	TSharedPtr<SScrollBar> HorizontalScrollbar;
 	TSharedPtr<SScrollBar> VerticalScrollbar;
 };
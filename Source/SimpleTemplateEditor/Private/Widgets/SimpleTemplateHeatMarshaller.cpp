@@ -0,0 +1,184 @@
+// Copyright Playspace S.L. 2017
+
+#include "SimpleTemplateHeatMarshaller.h"
+
+#include "Framework/Text/SlateTextRun.h"
+#include "Framework/Text/TextLayout.h"
+#include "Compiler/SimpleTemplateProfiler.h"
+
+// Tokens cooler than this, relative to the hottest one, keep the normal text color
+static const float MinHeat = 0.01f;
+
+
+/* FSimpleTemplateHeatMarshaller structors
+ *****************************************************************************/
+
+TSharedRef<FSimpleTemplateHeatMarshaller> FSimpleTemplateHeatMarshaller::Create(const FTextBlockStyle& InTextStyle)
+{
+	return MakeShareable(new FSimpleTemplateHeatMarshaller(InTextStyle));
+}
+
+
+FSimpleTemplateHeatMarshaller::FSimpleTemplateHeatMarshaller(const FTextBlockStyle& InTextStyle)
+	: TextStyle(InTextStyle)
+	, ErrorLine(INDEX_NONE)
+	, ErrorColumn(INDEX_NONE)
+{ }
+
+
+/* FSimpleTemplateHeatMarshaller interface
+ *****************************************************************************/
+
+void FSimpleTemplateHeatMarshaller::SetProfile(const FSimpleTemplateProfile& Profile)
+{
+	Spans.Reset();
+	for (const FSimpleTemplateTokenProfile& Token : Profile.Tokens)
+	{
+		if (Token.Line != INDEX_NONE)
+		{
+			Spans.Add({ Token.Line, Token.Column, Token.Heat });
+		}
+	}
+	Spans.Sort([](const FHeatSpan& A, const FHeatSpan& B)
+	{
+		return A.Line < B.Line || (A.Line == B.Line && A.Column < B.Column);
+	});
+
+	// Tokens of included templates are located at the include tag, they are folded into a single span of our source
+	float MaxHeat = 0.0f;
+	int32 NumFolded = 0;
+	for (int32 i = 0; i < Spans.Num(); i++)
+	{
+		if (NumFolded > 0 && Spans[NumFolded - 1].Line == Spans[i].Line && Spans[NumFolded - 1].Column == Spans[i].Column)
+		{
+			Spans[NumFolded - 1].Heat += Spans[i].Heat;
+		}
+		else
+		{
+			Spans[NumFolded++] = Spans[i];
+		}
+		MaxHeat = FMath::Max(MaxHeat, Spans[NumFolded - 1].Heat);
+	}
+	Spans.SetNum(NumFolded, false);
+
+	for (FHeatSpan& Span : Spans)
+	{
+		Span.Heat = MaxHeat > 0.0f ? Span.Heat / MaxHeat : 0.0f;
+	}
+	Spans.RemoveAll([](const FHeatSpan& Span)
+	{
+		return Span.Heat < MinHeat;
+	});
+	MakeDirty();
+}
+
+
+void FSimpleTemplateHeatMarshaller::ClearProfile()
+{
+	if (Spans.Num() > 0)
+	{
+		Spans.Reset();
+		MakeDirty();
+	}
+}
+
+
+void FSimpleTemplateHeatMarshaller::SetError(int32 Line, int32 Column)
+{
+	if (ErrorLine != Line || ErrorColumn != Column)
+	{
+		ErrorLine = Line;
+		ErrorColumn = Column;
+		MakeDirty();
+	}
+}
+
+
+void FSimpleTemplateHeatMarshaller::ClearError()
+{
+	SetError(INDEX_NONE, INDEX_NONE);
+}
+
+
+/* ITextLayoutMarshaller interface
+ *****************************************************************************/
+
+void FSimpleTemplateHeatMarshaller::SetText(const FString& SourceString, FTextLayout& TargetTextLayout)
+{
+	TArray<FTextRange> LineRanges;
+	FTextRange::CalculateLineRangesFromString(SourceString, LineRanges);
+
+	TArray<FTextLayout::FNewLineData> LinesToAdd;
+	LinesToAdd.Reserve(LineRanges.Num());
+
+	int32 SpanIndex = 0;
+	for (int32 LineIndex = 0; LineIndex < LineRanges.Num(); LineIndex++)
+	{
+		const FTextRange& LineRange = LineRanges[LineIndex];
+		TSharedRef<FString> LineText = MakeShareable(new FString(SourceString.Mid(LineRange.BeginIndex, LineRange.Len())));
+		const int32 LineLen = LineText->Len();
+
+		TArray<TSharedRef<IRun>> Runs;
+		int32 Cursor = 0;
+		if (LineIndex == ErrorLine)
+		{
+			// Errors only exist without a profile, a failed template can not be profiled
+			const int32 Begin = FMath::Clamp(ErrorColumn, 0, LineLen);
+			if (Begin > 0)
+			{
+				Runs.Add(FSlateTextRun::Create(FRunInfo(), LineText, TextStyle, FTextRange(0, Begin)));
+			}
+
+			FTextBlockStyle ErrorStyle = TextStyle;
+			ErrorStyle.SetColorAndOpacity(FLinearColor(1.0f, 0.1f, 0.05f));
+			Runs.Add(FSlateTextRun::Create(FRunInfo(), LineText, ErrorStyle, FTextRange(Begin, LineLen)));
+			Cursor = LineLen;
+		}
+		for (; SpanIndex < Spans.Num() && Spans[SpanIndex].Line <= LineIndex; SpanIndex++)
+		{
+			const FHeatSpan& Span = Spans[SpanIndex];
+			const int32 Begin = FMath::Clamp(Span.Column, Cursor, LineLen);
+			if (Span.Line < LineIndex || Begin >= LineLen)
+			{
+				continue;
+			}
+
+			// Tags end with their closing brace, text runs up to the next tag
+			int32 End = INDEX_NONE;
+			const TCHAR* Source = **LineText;
+			const TCHAR EndChar = Source[Begin] == TCHAR('{') ? TCHAR('}') : TCHAR('{');
+			for (int32 i = Begin + 1; i < LineLen && End == INDEX_NONE; i++)
+			{
+				if (Source[i] == EndChar)
+				{
+					End = EndChar == TCHAR('}') ? i + 1 : i;
+				}
+			}
+			End = End == INDEX_NONE ? LineLen : End;
+
+			if (Begin > Cursor)
+			{
+				Runs.Add(FSlateTextRun::Create(FRunInfo(), LineText, TextStyle, FTextRange(Cursor, Begin)));
+			}
+
+			FTextBlockStyle HeatStyle = TextStyle;
+			HeatStyle.SetColorAndOpacity(FLinearColor::LerpUsingHSV(FLinearColor(1.0f, 0.9f, 0.3f), FLinearColor(1.0f, 0.1f, 0.05f), Span.Heat));
+			Runs.Add(FSlateTextRun::Create(FRunInfo(), LineText, HeatStyle, FTextRange(Begin, End)));
+			Cursor = End;
+		}
+
+		if (Cursor < LineLen || Runs.Num() == 0)
+		{
+			Runs.Add(FSlateTextRun::Create(FRunInfo(), LineText, TextStyle, FTextRange(Cursor, LineLen)));
+		}
+		LinesToAdd.Emplace(MoveTemp(LineText), MoveTemp(Runs));
+	}
+
+	TargetTextLayout.AddLines(LinesToAdd);
+}
+
+
+void FSimpleTemplateHeatMarshaller::GetText(FString& TargetString, const FTextLayout& SourceTextLayout)
+{
+	SourceTextLayout.GetAsText(TargetString);
+}
@@ -0,0 +1,70 @@
+// Copyright Playspace S.L. 2017
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Framework/Text/BaseTextLayoutMarshaller.h"
+#include "Styling/SlateTypes.h"
+
+struct FSimpleTemplateProfile;
+
+/**
+ * Lays out the template source as plain text and colors the tokens of a profile by how much
+ * time they took, from the normal text color to red for the hottest token. The location of a
+ * compile error is colored up to the end of its line.
+ */
+class FSimpleTemplateHeatMarshaller
+	: public FBaseTextLayoutMarshaller
+{
+public:
+
+	static TSharedRef<FSimpleTemplateHeatMarshaller> Create(const FTextBlockStyle& InTextStyle);
+
+	/** Show the heat of a profile, tokens without a source location are ignored and tokens of included templates heat up their include tag */
+	void SetProfile(const FSimpleTemplateProfile& Profile);
+
+	/** Remove the heat */
+	void ClearProfile();
+
+	bool HasProfile() const
+	{
+		return Spans.Num() > 0;
+	}
+
+	/** Mark the location of a compile error */
+	void SetError(int32 Line, int32 Column);
+
+	/** Remove the error marker */
+	void ClearError();
+
+public:
+
+	//~ ITextLayoutMarshaller interface
+
+	virtual void SetText(const FString& SourceString, FTextLayout& TargetTextLayout) override;
+	virtual void GetText(FString& TargetString, const FTextLayout& SourceTextLayout) override;
+
+protected:
+
+	FSimpleTemplateHeatMarshaller(const FTextBlockStyle& InTextStyle);
+
+private:
+
+	/** A token to color, heat is relative to the hottest token */
+	struct FHeatSpan
+	{
+		int32 Line;
+		int32 Column;
+		float Heat;
+	};
+
+	/** Spans sorted by location */
+	TArray<FHeatSpan> Spans;
+
+	/** Style of the text without heat */
+	FTextBlockStyle TextStyle;
+
+	/** Location of the compile error, INDEX_NONE if there is none */
+	int32 ErrorLine;
+	int32 ErrorColumn;
+};
@@ -19,6 +19,7 @@ public class SimpleTemplateEditor : ModuleRules
 			new string[] {
 				"SimpleTemplateEditor/Private",
 				"SimpleTemplateEditor/Private/AssetTools",
+				"SimpleTemplateEditor/Private/Commandlets",
 				"SimpleTemplateEditor/Private/Factories",
 				"SimpleTemplateEditor/Private/Shared",
 				"SimpleTemplateEditor/Private/Styles",
@@ -28,6 +29,7 @@ public class SimpleTemplateEditor : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(
 			new string[] {
+				"AssetRegistry",
 				"ContentBrowser",
 				"Core",
 				"CoreUObject",